@@ -1,36 +1,433 @@
 #include "Addr.h"
 
+#include <array>
+#include <bit>
+
 #include "TX/Result.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TX_ADDR_SSE2
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TX_ADDR_AVX2
+#endif
+
 namespace TX {
+namespace {
+// Parsing classifies every character of the text at once, then walks the
+// separators a field at a time instead of a character at a time.
+constexpr size_t kScanSize = 64;
 
-Result<SocketAddr, AddrParseError> SocketAddr::Parse(const String &addr) {
-  return AddrParseError();
+struct Scan {
+  // A bit per character.
+  uint64 hex;
+  uint64 decimal;
+  uint64 colons;
+  uint64 dots;
+  // The value of each hex digit.
+  alignas(32) uint8 nibbles[kScanSize];
+};
+
+// Bits [begin, end).
+constexpr uint64 bits(const size_t begin, const size_t end) {
+  const uint64 below_end = end >= 64 ? ~uint64(0) : (uint64(1) << end) - 1;
+  return below_end & ~((uint64(1) << begin) - 1);
 }
 
-Result<IPv6Addr, AddrParseError> IPv6Addr::Parse(const String &addr) {
-  return AddrParseError();
+// Copies `s`, at most kScanSize characters, into `buf` and pads it with zeros
+// as far as classify reads. Up to 16 characters go in as two words: a vector
+// load of the bytes a short memcpy just stored can't be forwarded from the
+// stores and waits for them to retire.
+void load(const StringView s, char *buf) {
+  const size_t n = s.size();
+  uint64 lo = 0, hi = 0;
+  if (std::endian::native != std::endian::little || n > 16) {
+    std::memset(buf, 0, kScanSize);
+    std::memcpy(buf, s.data(), n);
+    return;
+  }
+  if (n <= 8) {
+    std::memcpy(&lo, s.data(), n);
+  } else {
+    std::memcpy(&lo, s.data(), 8);
+    std::memcpy(&hi, s.data() + n - 8, 8);
+    hi >>= (16 - n) * 8;
+  }
+  std::memcpy(buf, &lo, 8);
+  std::memcpy(buf + 8, &hi, 8);
+#ifdef TX_ADDR_AVX2
+  std::memset(buf + 16, 0, 16);
+#endif  // TX_ADDR_AVX2
 }
 
-Result<IPv4Addr, AddrParseError> IPv4Addr::Parse(const String &addr) {
-  if (addr.empty()) return AddrParseError();
-  const char *ptr = addr.data();
-  const char *end = addr.data() + addr.size();
-  uint8 octets[4] = {0, 0, 0, 0};
-  int i = 0;
-  while (ptr < end && i < 4) {
-    uint16 octet = 0;
-    while (ptr < end && *ptr != '.') {
-      if (*ptr < '0' || *ptr > '9') return AddrParseError();
-      octet = octet * 10 + (*ptr - '0');
-      ++ptr;
+// Classifies `s`, at most kScanSize characters.
+void classify(const StringView s, Scan &out) {
+  alignas(32) char buf[kScanSize];
+  load(s, buf);
+  out.hex = out.decimal = out.colons = out.dots = 0;
+#if defined(TX_ADDR_AVX2)
+  for (size_t i = 0; i < s.size(); i += 32) {
+    const __m256i v =
+        _mm256_load_si256(reinterpret_cast<const __m256i *>(buf + i));
+    // Folds A-F onto a-f, and leaves digits as they are.
+    const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i decimal =
+        _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    const __m256i alpha =
+        _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    const __m256i nibbles = _mm256_blendv_epi8(
+        _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10)),
+        _mm256_sub_epi8(v, _mm256_set1_epi8('0')), decimal);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(out.nibbles + i), nibbles);
+    const auto mask = [](const __m256i m) {
+      return static_cast<uint64>(static_cast<uint32>(_mm256_movemask_epi8(m)));
+    };
+    out.decimal |= mask(decimal) << i;
+    out.hex |= mask(_mm256_or_si256(decimal, alpha)) << i;
+    out.colons |= mask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':'))) << i;
+    out.dots |= mask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'))) << i;
+  }
+#elif defined(TX_ADDR_SSE2)
+  for (size_t i = 0; i < s.size(); i += 16) {
+    const __m128i v =
+        _mm_load_si128(reinterpret_cast<const __m128i *>(buf + i));
+    // Folds A-F onto a-f, and leaves digits as they are.
+    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i decimal =
+        _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                      _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i alpha =
+        _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                      _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    const __m128i nibbles = _mm_or_si128(
+        _mm_and_si128(decimal, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+        _mm_andnot_si128(decimal,
+                         _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+    _mm_store_si128(reinterpret_cast<__m128i *>(out.nibbles + i), nibbles);
+    const auto mask = [](const __m128i m) {
+      return static_cast<uint64>(_mm_movemask_epi8(m));
+    };
+    out.decimal |= mask(decimal) << i;
+    out.hex |= mask(_mm_or_si128(decimal, alpha)) << i;
+    out.colons |= mask(_mm_cmpeq_epi8(v, _mm_set1_epi8(':'))) << i;
+    out.dots |= mask(_mm_cmpeq_epi8(v, _mm_set1_epi8('.'))) << i;
+  }
+#else
+  for (size_t i = 0; i < s.size(); i++) {
+    const char c = buf[i];
+    const char lower = static_cast<char>(c | 0x20);
+    const uint64 bit = uint64(1) << i;
+    if (c >= '0' && c <= '9') {
+      out.decimal |= bit;
+      out.hex |= bit;
+      out.nibbles[i] = static_cast<uint8>(c - '0');
+    } else if (lower >= 'a' && lower <= 'f') {
+      out.hex |= bit;
+      out.nibbles[i] = static_cast<uint8>(lower - 'a' + 10);
+    } else if (c == ':') {
+      out.colons |= bit;
+    } else if (c == '.') {
+      out.dots |= bit;
     }
-    if (octet > 255) return AddrParseError();
-    octets[i++] = static_cast<uint8>(octet);
-    if (ptr < end) ++ptr;  // skip '.'
   }
-  if (i != 4) return AddrParseError();
+#endif
+  // Whatever the padding was classified as.
+  const uint64 valid = bits(0, s.size());
+  out.hex &= valid;
+  out.decimal &= valid;
+  out.colons &= valid;
+  out.dots &= valid;
+}
+
+// Parses the dotted quad at [begin, end) of `scan`.
+bool parseIPv4(const Scan &scan, const size_t begin, const size_t end,
+               uint8 *octets) {
+  if (end - begin < 7 || end - begin > IPv4Addr::kMaxStringSize) return false;
+  const uint64 range = bits(begin, end);
+  uint64 dots = scan.dots & range;
+  if (((scan.decimal | dots) & range) != range || std::popcount(dots) != 3) {
+    return false;
+  }
+  // Without a branch on the field width, which is as random as the address.
+  static constexpr uint8 kWeights[4][3] = {
+      {0, 0, 0}, {1, 0, 0}, {10, 1, 0}, {100, 10, 1}};
+  bool ok = true;
+  size_t start = begin;
+  for (int i = 0; i < 4; i++) {
+    const size_t stop = i < 3 ? std::countr_zero(dots) : end;
+    dots &= dots - 1;
+    const size_t width = stop - start;
+    const uint8 *d = scan.nibbles + start;
+    const uint8 *w = kWeights[width & 3];
+    const uint32 octet = d[0] * w[0] + d[1] * w[1] + d[2] * w[2];
+    // No leading zeros, inet_pton reads them as octal elsewhere.
+    ok &= (width - 1 < 3) & (width == 1 || d[0] != 0) & (octet <= 255);
+    octets[i] = static_cast<uint8>(octet);
+    start = stop + 1;
+  }
+  return ok;
+}
+
+// A dotted quad on its own, at most 15 characters, is cheaper to parse a
+// field at a time than to classify first, which pays off for the 45 of an
+// IPv6 address. Each field looks at its next three characters and takes its
+// width from them, without a branch.
+bool parseIPv4(const StringView s, uint8 *octets) {
+  const size_t n = s.size();
+  if (n < 7 || n > IPv4Addr::kMaxStringSize) return false;
+  alignas(32) char buf[kScanSize];
+  load(s, buf);
+  // The last field may look one past the 16 load pads.
+  buf[16] = 0;
+  static constexpr uint8 kWeights[4][3] = {
+      {0, 0, 0}, {1, 0, 0}, {10, 1, 0}, {100, 10, 1}};
+  const char *p = buf;
+  bool ok = true;
+  for (int i = 0; i < 4; i++) {
+    const uint32 d[3] = {static_cast<uint8>(p[0] - '0'),
+                         static_cast<uint8>(p[1] - '0'),
+                         static_cast<uint8>(p[2] - '0')};
+    const size_t width = 1 + (d[1] < 10) + ((d[1] < 10) & (d[2] < 10));
+    const uint8 *w = kWeights[width];
+    const uint32 octet = d[0] * w[0] + d[1] * w[1] + d[2] * w[2];
+    // No leading zeros, as above.
+    ok &= (d[0] < 10) & (width == 1 || d[0] != 0) & (octet <= 255);
+    octets[i] = static_cast<uint8>(octet);
+    p += width;
+    if (i < 3) ok &= *p++ == '.';
+  }
+  return ok && static_cast<size_t>(p - buf) == n;
+}
+
+bool parseIPv6(const StringView s, uint8 *octets) {
+  const size_t n = s.size();
+  if (n < 2 || n > IPv6Addr::kMaxStringSize) return false;
+  Scan scan;
+  classify(s, scan);
+  const uint64 all = bits(0, n);
+  if ((scan.hex | scan.colons | scan.dots) != all || !scan.colons) {
+    return false;
+  }
+  // A dotted quad can only be the last field.
+  const size_t last_colon = 63 - std::countl_zero(scan.colons);
+  const bool has_ipv4 = scan.dots != 0;
+  const size_t hex_end = has_ipv4 ? last_colon + 1 : n;
+  if (scan.dots & bits(0, hex_end)) return false;
+
+  uint16 groups[8];
+  int count = 0;
+  int gap = -1;
+  size_t pos = 0;
+  if (s[0] == ':') {
+    if (s[1] != ':') return false;
+    gap = 0;
+    pos = 2;
+  }
+  while (pos < hex_end) {
+    const uint64 next_colons = scan.colons & ~bits(0, pos);
+    const size_t stop = next_colons ? std::countr_zero(next_colons) : n;
+    if (stop == pos || stop - pos > 4 || count == 8) return false;
+    uint32 group = 0;
+    for (size_t i = pos; i < stop; i++) group = (group << 4) | scan.nibbles[i];
+    groups[count++] = static_cast<uint16>(group);
+    if (stop == n) break;
+    pos = stop + 1;
+    // A dotted quad follows.
+    if (pos == hex_end && has_ipv4) break;
+    if (pos == n) return false;
+    if (s[pos] == ':') {
+      if (gap >= 0) return false;
+      gap = count;
+      pos++;
+    }
+  }
+
+  const int total = count + (has_ipv4 ? 2 : 0);
+  // A gap stands for one group at least.
+  if (gap < 0 ? total != 8 : total > 7) return false;
+  std::memset(octets, 0, 16);
+  const int skipped = 8 - total;
+  for (int i = 0; i < count; i++) {
+    const int at = gap >= 0 && i >= gap ? i + skipped : i;
+    octets[2 * at] = static_cast<uint8>(groups[i] >> 8);
+    octets[2 * at + 1] = static_cast<uint8>(groups[i]);
+  }
+  return !has_ipv4 || parseIPv4(scan, hex_end, n, octets + 12);
+}
+
+bool parsePort(const StringView s, uint16 &port) {
+  if (s.empty() || s.size() > 5) return false;
+  uint32 value = 0;
+  for (const char c : s) {
+    if (c < '0' || c > '9') return false;
+    value = value * 10 + (c - '0');
+  }
+  if (value > 65535) return false;
+  port = static_cast<uint16>(value);
+  return true;
+}
+
+char *formatDecimal(char *p, uint32 n) {
+  char digits[10];
+  int size = 0;
+  do {
+    digits[size++] = static_cast<char>('0' + n % 10);
+    n /= 10;
+  } while (n);
+  while (size) *p++ = digits[--size];
+  return p;
+}
+
+char *formatHex(char *p, const uint16 n) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  const int digits = n ? (std::bit_width(n) + 3) / 4 : 1;
+  for (int i = digits - 1; i >= 0; i--) *p++ = kDigits[(n >> (4 * i)) & 0xF];
+  return p;
+}
+
+// The longest run of set bits of each 8-bit mask, as start and length.
+struct Run {
+  int8 start;
+  int8 size;
+};
+constexpr std::array<Run, 256> kLongestRuns = []() {
+  std::array<Run, 256> runs{};
+  for (int mask = 0; mask < 256; mask++) {
+    Run best{-1, 0};
+    for (int i = 0; i < 8;) {
+      int size = 0;
+      while (i + size < 8 && (mask >> (i + size) & 1)) size++;
+      if (size > best.size) {
+        best = {static_cast<int8>(i), static_cast<int8>(size)};
+      }
+      i += size ? size : 1;
+    }
+    runs[mask] = best;
+  }
+  return runs;
+}();
+
+// A bit per zero group of `octets`.
+uint32 zeroGroups(const uint8 *octets) {
+#if defined(TX_ADDR_SSE2)
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(octets));
+  const uint32 bytes = static_cast<uint32>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+  // Both bytes of a group, then packs the even bits.
+  uint32 x = bytes & (bytes >> 1) & 0x5555;
+  x = (x | (x >> 1)) & 0x3333;
+  x = (x | (x >> 2)) & 0x0F0F;
+  return (x | (x >> 4)) & 0xFF;
+#else
+  uint32 mask = 0;
+  for (int i = 0; i < 8; i++) {
+    if (!octets[2 * i] && !octets[2 * i + 1]) mask |= 1u << i;
+  }
+  return mask;
+#endif
+}
+}  // namespace
+
+Result<SocketAddr, AddrParseError> SocketAddr::Parse(const StringView addr) {
+  uint16 port;
+  if (!addr.empty() && addr[0] == '[') {
+    const size_t close = addr.find(']');
+    if (close == StringView::npos || close + 1 >= addr.size() ||
+        addr[close + 1] != ':' || !parsePort(addr.substr(close + 2), port)) {
+      return AddrParseError();
+    }
+    auto ip = IPv6Addr::Parse(addr.substr(1, close - 1));
+    if (ip.IsErr()) return AddrParseError();
+    return SocketAddr(ip.Unwrap(), port);
+  }
+  const size_t colon = addr.rfind(':');
+  if (colon == StringView::npos || !parsePort(addr.substr(colon + 1), port)) {
+    return AddrParseError();
+  }
+  auto ip = IPv4Addr::Parse(addr.substr(0, colon));
+  if (ip.IsErr()) return AddrParseError();
+  return SocketAddr(ip.Unwrap(), port);
+}
+
+size_t SocketAddr::Format(char *buf) const {
+  char *p = buf;
+  if (is_v4_) {
+    p += addr_.v4_.ip.Format(p);
+  } else {
+    *p++ = '[';
+    p += addr_.v6_.ip.Format(p);
+    *p++ = ']';
+  }
+  *p++ = ':';
+  p = formatDecimal(p, Port());
+  return static_cast<size_t>(p - buf);
+}
+
+String SocketAddr::ToString() const {
+  char buf[kMaxStringSize];
+  return String(buf, Format(buf));
+}
+
+Result<IPv6Addr, AddrParseError> IPv6Addr::Parse(const StringView addr) {
+  IPv6Addr ip;
+  if (!parseIPv6(addr, ip.octets_)) return AddrParseError();
+  return ip;
+}
+
+size_t IPv6Addr::Format(char *buf) const {
+  char *p = buf;
+  if (IsIPv4Mapped()) {
+    std::memcpy(p, "::ffff:", 7);
+    p += 7;
+    p += IPv4Addr(octets_[12], octets_[13], octets_[14], octets_[15]).Format(p);
+    return static_cast<size_t>(p - buf);
+  }
+  // RFC 5952: the longest run of two zero groups or more, the first of equal
+  // ones, becomes "::".
+  Run gap = kLongestRuns[zeroGroups(octets_)];
+  if (gap.size < 2) gap = {-1, 0};
+  for (int i = 0; i < 8;) {
+    if (i == gap.start) {
+      *p++ = ':';
+      *p++ = ':';
+      i += gap.size;
+      continue;
+    }
+    if (i > 0 && i != gap.start + gap.size) *p++ = ':';
+    p = formatHex(p, static_cast<uint16>(octets_[2 * i] << 8 |
+                                         octets_[2 * i + 1]));
+    i++;
+  }
+  return static_cast<size_t>(p - buf);
+}
+
+String IPv6Addr::ToString() const {
+  char buf[kMaxStringSize];
+  return String(buf, Format(buf));
+}
+
+Result<IPv4Addr, AddrParseError> IPv4Addr::Parse(const StringView addr) {
+  if (addr.size() > kMaxStringSize) return AddrParseError();
+  uint8 octets[4];
+  if (!parseIPv4(addr, octets)) return AddrParseError();
   return IPv4Addr(octets[0], octets[1], octets[2], octets[3]);
 }
 
+size_t IPv4Addr::Format(char *buf) const {
+  char *p = buf;
+  for (int i = 0; i < 4; i++) {
+    if (i) *p++ = '.';
+    p = formatDecimal(p, octets_[i]);
+  }
+  return static_cast<size_t>(p - buf);
+}
+
+String IPv4Addr::ToString() const {
+  char buf[kMaxStringSize];
+  return String(buf, Format(buf));
+}
 }  // namespace TX
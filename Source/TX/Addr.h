@@ -37,6 +37,21 @@ class IPv6Addr {
     }
   }
 
+  // The longest text of an address, as INET6_ADDRSTRLEN without the NUL.
+  static constexpr size_t kMaxStringSize = 45;
+
+  TX_NODISCARD uint8 operator[](const size_t index) const {
+    return octets_[index];
+  }
+  TX_NODISCARD bool operator==(const IPv6Addr &) const = default;
+
+  // Whether the address is ::ffff:a.b.c.d.
+  TX_NODISCARD bool IsIPv4Mapped() const {
+    static constexpr uint8 kPrefix[12] = {0, 0, 0, 0, 0,    0,
+                                          0, 0, 0, 0, 0xFF, 0xFF};
+    return std::memcmp(octets_, kPrefix, sizeof(kPrefix)) == 0;
+  }
+
   TX_NODISCARD uint128 ToBits() const {
     return uint128::FromBigEndianBytes(octets_);
   }
@@ -47,7 +62,12 @@ class IPv6Addr {
     return ip;
   }
 
-  static Result<IPv6Addr, AddrParseError> Parse(const String &addr);
+  // Parses the text forms of RFC 4291, as inet_pton does.
+  static Result<IPv6Addr, AddrParseError> Parse(StringView addr);
+  // Writes the RFC 5952 text of the address, at most kMaxStringSize chars
+  // and no NUL, and returns its size.
+  size_t Format(char *buf) const;
+  TX_NODISCARD String ToString() const;
 
  private:
   uint8 octets_[16]{};
@@ -83,6 +103,7 @@ class IPv4Addr {
   TX_NODISCARD uint8 operator[](const size_t index) const {
     return octets_[index];
   }
+  TX_NODISCARD bool operator==(const IPv4Addr &) const = default;
 
   TX_NODISCARD IPv6Addr ToIPv6Compatible() const {
     const uint16 g = (octets_[0] << 8) | octets_[1];
@@ -93,7 +114,7 @@ class IPv4Addr {
   TX_NODISCARD IPv6Addr ToIPv6Mapped() const {
     const uint16 g = (octets_[0] << 8) | octets_[1];
     const uint16 h = (octets_[2] << 8) | octets_[3];
-    return IPv6Addr(0, 0, 0, 0, 0xFF, 0xFF, g, h);
+    return IPv6Addr(0, 0, 0, 0, 0, 0xFFFF, g, h);
   }
 
   TX_NODISCARD uint32 ToBits() const {
@@ -106,7 +127,14 @@ class IPv4Addr {
                     (bits >> 8) & 0xFF, bits & 0xFF);
   }
 
-  static Result<IPv4Addr, AddrParseError> Parse(const String &addr);
+  static constexpr size_t kMaxStringSize = 15;
+
+  // Parses a.b.c.d in decimal without leading zeros, as inet_pton does.
+  static Result<IPv4Addr, AddrParseError> Parse(StringView addr);
+  // Writes the text of the address, at most kMaxStringSize chars and no NUL,
+  // and returns its size.
+  size_t Format(char *buf) const;
+  TX_NODISCARD String ToString() const;
 
  private:
   uint8 octets_[4]{};
@@ -137,7 +165,33 @@ class SocketAddr {
     addr_.v6_.port = port;
   }
 
-  static Result<SocketAddr, AddrParseError> Parse(const String &addr);
+  // "[" IPv6Addr "]:" port.
+  static constexpr size_t kMaxStringSize = IPv6Addr::kMaxStringSize + 8;
+
+  TX_NODISCARD bool IsIPv4() const { return is_v4_; }
+  TX_NODISCARD bool IsIPv6() const { return !is_v4_; }
+  TX_NODISCARD const IPv4Addr &IPv4() const {
+    TX_ASSERT(is_v4_);
+    return addr_.v4_.ip;
+  }
+  TX_NODISCARD const IPv6Addr &IPv6() const {
+    TX_ASSERT(!is_v4_);
+    return addr_.v6_.ip;
+  }
+  TX_NODISCARD uint16 Port() const {
+    return is_v4_ ? addr_.v4_.port : addr_.v6_.port;
+  }
+  TX_NODISCARD bool operator==(const SocketAddr &other) const {
+    if (is_v4_ != other.is_v4_ || Port() != other.Port()) return false;
+    return is_v4_ ? IPv4() == other.IPv4() : IPv6() == other.IPv6();
+  }
+
+  // Parses a.b.c.d:port or [IPv6Addr]:port.
+  static Result<SocketAddr, AddrParseError> Parse(StringView addr);
+  // Writes the text of the address, at most kMaxStringSize chars and no NUL,
+  // and returns its size.
+  size_t Format(char *buf) const;
+  TX_NODISCARD String ToString() const;
 
  private:
   bool is_v4_;
@@ -0,0 +1,102 @@
+#include <arpa/inet.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TX/Addr.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+// Compares parsing and formatting addresses with inet_pton and inet_ntop,
+// over a corpus of random IPv4 addresses and of IPv6 ones with a run of
+// zero groups.
+class AddrBench : public testing::Test {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  static constexpr int kAddrs = 4096;
+  static constexpr int kRounds = 500;
+
+  void SetUp() override {
+    std::mt19937_64 random(42);
+    for (int i = 0; i < kAddrs; i++) {
+      const auto v4 = IPv4Addr::FromBits(static_cast<uint32>(random()));
+      ipv4_.push_back(v4.ToString());
+      uint128 bits(random(), random());
+      // Zeros some groups, as real addresses have.
+      const int zeros = static_cast<int>(random() % 5) * 16;
+      if (zeros) bits &= ~(((uint128(1) << zeros) - 1) << 16);
+      ipv6_.push_back(IPv6Addr::FromBits(bits).ToString());
+    }
+  }
+
+  template <class F>
+  static void run(const char *name, const std::vector<std::string> &corpus,
+                  F f) {
+    size_t bytes = 0;
+    for (const std::string &s : corpus) bytes += s.size();
+    const Clock::time_point start = Clock::now();
+    for (int round = 0; round < kRounds; round++) {
+      for (const std::string &s : corpus) f(s);
+    }
+    const double ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - start)
+            .count();
+    std::printf("%-24s %6.1f ns/addr, %7.1f MB/s\n", name,
+                ns / (kRounds * corpus.size()),
+                static_cast<double>(bytes) * kRounds * 1e3 / ns);
+  }
+
+  std::vector<std::string> ipv4_;
+  std::vector<std::string> ipv6_;
+};
+
+TEST_F(AddrBench, Parse) {
+  uint64 sum = 0;
+  run("IPv4Addr::Parse", ipv4_, [&](const std::string &s) {
+    sum += IPv4Addr::Parse(s).Unwrap().ToBits();
+  });
+  run("inet_pton(AF_INET)", ipv4_, [&](const std::string &s) {
+    uint8 out[4];
+    sum += inet_pton(AF_INET, s.c_str(), out) + out[3];
+  });
+  run("IPv6Addr::Parse", ipv6_, [&](const std::string &s) {
+    sum += IPv6Addr::Parse(s).Unwrap().ToBits().Lo();
+  });
+  run("inet_pton(AF_INET6)", ipv6_, [&](const std::string &s) {
+    uint8 out[16];
+    sum += inet_pton(AF_INET6, s.c_str(), out) + out[15];
+  });
+  EXPECT_NE(sum, 0u);
+}
+
+TEST_F(AddrBench, Format) {
+  std::vector<IPv4Addr> ipv4;
+  std::vector<IPv6Addr> ipv6;
+  for (const std::string &s : ipv4_) {
+    ipv4.push_back(IPv4Addr::Parse(s).Unwrap());
+  }
+  for (const std::string &s : ipv6_) {
+    ipv6.push_back(IPv6Addr::Parse(s).Unwrap());
+  }
+  size_t sum = 0;
+  char buf[INET6_ADDRSTRLEN];
+  size_t i = 0;
+  run("IPv4Addr::Format", ipv4_,
+      [&](const std::string &) { sum += ipv4[i++ % kAddrs].Format(buf); });
+  run("inet_ntop(AF_INET)", ipv4_, [&](const std::string &) {
+    const uint32 bits = htonl(ipv4[i++ % kAddrs].ToBits());
+    sum += inet_ntop(AF_INET, &bits, buf, sizeof(buf)) != nullptr;
+  });
+  run("IPv6Addr::Format", ipv6_,
+      [&](const std::string &) { sum += ipv6[i++ % kAddrs].Format(buf); });
+  run("inet_ntop(AF_INET6)", ipv6_, [&](const std::string &) {
+    uint8 bytes[16];
+    ipv6[i++ % kAddrs].ToBits().ToBigEndianBytes(bytes);
+    sum += inet_ntop(AF_INET6, bytes, buf, sizeof(buf)) != nullptr;
+  });
+  EXPECT_NE(sum, 0u);
+}
+}  // namespace TX
@@ -1,4 +1,10 @@
 #include "Addr.h"
+
+#include <arpa/inet.h>
+
+#include <random>
+#include <string>
+
 #include "gtest/gtest.h"
 
 namespace TX {
@@ -29,4 +35,189 @@ TEST(AddrTest, ParseIPv4Addr) {
   EXPECT_TRUE(addr.IsErr());
   EXPECT_EQ(addr.UnwrapErr(), AddrParseError());
 }
-} // namespace TX
+
+TEST(AddrTest, ParseIPv6Addr) {
+  auto addr = IPv6Addr::Parse("::");
+  ASSERT_TRUE(addr.IsOk());
+  EXPECT_EQ(addr.Unwrap().ToBits(), uint128());
+
+  addr = IPv6Addr::Parse("::1");
+  ASSERT_TRUE(addr.IsOk());
+  EXPECT_EQ(addr.Unwrap().ToBits(), uint128(1));
+
+  addr = IPv6Addr::Parse("2001:DB8::FF00:42:8329");
+  ASSERT_TRUE(addr.IsOk());
+  EXPECT_EQ(addr.Unwrap(),
+            IPv6Addr(0x2001, 0xdb8, 0, 0, 0, 0xff00, 0x42, 0x8329));
+
+  addr = IPv6Addr::Parse("::ffff:192.168.1.1");
+  ASSERT_TRUE(addr.IsOk());
+  EXPECT_TRUE(addr.Unwrap().IsIPv4Mapped());
+  EXPECT_EQ(addr.Unwrap(), IPv4Addr(192, 168, 1, 1).ToIPv6Mapped());
+
+  for (const char *invalid :
+       {"", ":", ":::", "1::2::3", "1:2:3:4:5:6:7:8:9", "1:2:3:4:5:6::7:8",
+        "12345::", "::g", "1:", ":1", "::1.2.3", "1.2.3.4::", "::1%eth0"}) {
+    EXPECT_TRUE(IPv6Addr::Parse(invalid).IsErr()) << invalid;
+  }
+}
+
+TEST(AddrTest, ParseSocketAddr) {
+  auto addr = SocketAddr::Parse("127.0.0.1:8080");
+  ASSERT_TRUE(addr.IsOk());
+  EXPECT_TRUE(addr.Unwrap().IsIPv4());
+  EXPECT_EQ(addr.Unwrap().IPv4(), IPv4Addr(127, 0, 0, 1));
+  EXPECT_EQ(addr.Unwrap().Port(), 8080);
+
+  addr = SocketAddr::Parse("[::1]:65535");
+  ASSERT_TRUE(addr.IsOk());
+  EXPECT_TRUE(addr.Unwrap().IsIPv6());
+  EXPECT_EQ(addr.Unwrap().IPv6().ToBits(), uint128(1));
+  EXPECT_EQ(addr.Unwrap().Port(), 65535);
+
+  for (const char *invalid :
+       {"", "127.0.0.1", "127.0.0.1:", "127.0.0.1:65536", "::1:80", "[::1]",
+        "[::1]80", "[::1]:", "[::1:80", "127.0.0.1:8o"}) {
+    EXPECT_TRUE(SocketAddr::Parse(invalid).IsErr()) << invalid;
+  }
+}
+
+TEST(AddrTest, Format) {
+  EXPECT_EQ(IPv4Addr(0, 0, 0, 0).ToString(), "0.0.0.0");
+  EXPECT_EQ(IPv4Addr(255, 10, 1, 100).ToString(), "255.10.1.100");
+  // RFC 5952, section 4.
+  const std::pair<const char *, const char *> cases[] = {
+      {"::", "::"},
+      {"::1", "::1"},
+      {"1::", "1::"},
+      {"2001:0DB8:0000:0000:0000:0000:0002:0001", "2001:db8::2:1"},
+      {"2001:db8:0:1:1:1:1:1", "2001:db8:0:1:1:1:1:1"},
+      {"2001:0:0:1:0:0:0:1", "2001:0:0:1::1"},
+      {"2001:db8:0:0:1:0:0:1", "2001:db8::1:0:0:1"},
+      {"::ffff:0102:0304", "::ffff:1.2.3.4"},
+  };
+  for (const auto &[in, out] : cases) {
+    EXPECT_EQ(IPv6Addr::Parse(in).Unwrap().ToString(), out) << in;
+  }
+  EXPECT_EQ(SocketAddr(IPv4Addr(10, 0, 0, 1), 0).ToString(), "10.0.0.1:0");
+  EXPECT_EQ(SocketAddr(IPv6Addr::FromBits(1), 443).ToString(), "[::1]:443");
+}
+
+// Random edits of valid addresses, parsed by both Parse and inet_pton.
+class AddrFuzzTest : public testing::Test {
+ protected:
+  static constexpr int kCases = 200000;
+
+  std::string randomIPv4() {
+    std::string s;
+    for (int i = 0; i < 4; i++) {
+      if (i) s += '.';
+      s += std::to_string(random_() % 256);
+    }
+    return s;
+  }
+
+  std::string randomIPv6() {
+    std::string s;
+    // Zero runs for "::" to compress.
+    const int zeros_at = static_cast<int>(random_() % 8);
+    const int zeros = static_cast<int>(random_() % 4);
+    const bool ipv4 = random_() % 4 == 0;
+    const int groups = ipv4 ? 6 : 8;
+    for (int i = 0; i < groups; i++) {
+      if (i) s += ':';
+      const bool zero = i >= zeros_at && i < zeros_at + zeros;
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), random_() % 2 ? "%x" : "%X",
+                    zero ? 0 : static_cast<unsigned>(random_() % 65536) >>
+                                   (random_() % 16));
+      s += buf;
+    }
+    if (ipv4) s += ":" + randomIPv4();
+    if (zeros >= 1) {
+      // Compresses the first run of zero groups.
+      const size_t at = s.find(":0:");
+      if (at != std::string::npos) {
+        size_t end = at + 2;
+        while (s.compare(end, 3, ":0:") == 0) end += 2;
+        s.replace(at, end - at + 1, "::");
+      }
+    }
+    return s;
+  }
+
+  void mutate(std::string &s) {
+    static constexpr char kChars[] = "0123456789abcdefABCDEFgx:.[] %";
+    const int edits = static_cast<int>(random_() % 3);
+    for (int i = 0; i < edits; i++) {
+      const size_t at = s.empty() ? 0 : random_() % (s.size() + 1);
+      const char c = kChars[random_() % (sizeof(kChars) - 1)];
+      switch (random_() % 3) {
+        case 0:
+          s.insert(s.begin() + static_cast<ptrdiff_t>(at), c);
+          break;
+        case 1:
+          if (at < s.size()) s.erase(at, 1);
+          break;
+        default:
+          if (at < s.size()) s[at] = c;
+      }
+    }
+  }
+
+  std::mt19937_64 random_{42};
+};
+
+TEST_F(AddrFuzzTest, ParseIPv4Addr) {
+  for (int i = 0; i < kCases; i++) {
+    std::string s = randomIPv4();
+    mutate(s);
+    uint8 expected[4];
+    const bool ok = inet_pton(AF_INET, s.c_str(), expected) == 1;
+    auto addr = IPv4Addr::Parse(s);
+    ASSERT_EQ(addr.IsOk(), ok) << s;
+    if (!ok) continue;
+    const IPv4Addr ip = addr.Unwrap();
+    EXPECT_EQ(ip, IPv4Addr(expected[0], expected[1], expected[2], expected[3]))
+        << s;
+    // Leaves the text as inet_ntop does.
+    char text[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, expected, text, sizeof(text));
+    EXPECT_EQ(ip.ToString(), text);
+  }
+}
+
+TEST_F(AddrFuzzTest, ParseIPv6Addr) {
+  int valid = 0;
+  for (int i = 0; i < kCases; i++) {
+    std::string s = randomIPv6();
+    if (i % 2) mutate(s);
+    uint8 expected[16];
+    const bool ok = inet_pton(AF_INET6, s.c_str(), expected) == 1;
+    auto addr = IPv6Addr::Parse(s);
+    ASSERT_EQ(addr.IsOk(), ok) << s;
+    if (!ok) continue;
+    valid++;
+    const IPv6Addr ip = addr.Unwrap();
+    EXPECT_EQ(ip.ToBits(), uint128::FromBigEndianBytes(expected)) << s;
+    const std::string text = ip.ToString();
+    EXPECT_EQ(IPv6Addr::Parse(text).Unwrap(), ip) << text;
+    // inet_ntop also writes the deprecated IPv4-compatible ::a.b.c.d.
+    if (ip.ToBits() >> 32 == uint128()) continue;
+    char expected_text[INET6_ADDRSTRLEN];
+    inet_ntop(AF_INET6, expected, expected_text, sizeof(expected_text));
+    EXPECT_EQ(text, expected_text) << s;
+  }
+  EXPECT_GT(valid, kCases / 2);
+}
+
+TEST_F(AddrFuzzTest, ParseSocketAddr) {
+  for (int i = 0; i < kCases / 10; i++) {
+    const uint16 port = static_cast<uint16>(random_());
+    const SocketAddr v4(IPv4Addr::Parse(randomIPv4()).Unwrap(), port);
+    EXPECT_EQ(SocketAddr::Parse(v4.ToString()).Unwrap(), v4);
+    const SocketAddr v6(IPv6Addr::Parse(randomIPv6()).Unwrap(), port);
+    EXPECT_EQ(SocketAddr::Parse(v6.ToString()).Unwrap(), v6);
+  }
+}
+}  // namespace TX
@@ -0,0 +1,90 @@
+#include "TX/Arena.h"
+
+#include <algorithm>
+#include <new>
+
+namespace TX {
+struct Arena::Chunk {
+  Chunk *next;
+  size_t size;
+  // Bytes of the chunk that were handed out, filled in when leaving it.
+  size_t used;
+
+  char *data() { return reinterpret_cast<char *>(this + 1); }
+};
+
+void *ArenaResource::do_allocate(const size_t bytes, const size_t align) {
+  return arena_.Allocate(bytes, align);
+}
+
+Arena::Arena(const size_t chunk_size)
+    : head_(nullptr),
+      current_(nullptr),
+      ptr_(0),
+      end_(0),
+      next_chunk_size_(std::clamp(chunk_size, kMinChunkSize, kMaxChunkSize)),
+      reserved_(0),
+      resource_(*this) {}
+
+Arena::~Arena() { Release(); }
+
+void Arena::enter(Chunk *chunk) {
+  if (current_) {
+    current_->used = ptr_ - reinterpret_cast<uintptr_t>(current_->data());
+  }
+  current_ = chunk;
+  ptr_ = reinterpret_cast<uintptr_t>(chunk->data());
+  end_ = ptr_ + chunk->size;
+}
+
+void *Arena::allocateSlow(const size_t size, const size_t align) {
+  // Take the next free chunk if it is big enough, otherwise put a new one in
+  // front of the free chunks.
+  const size_t needed = size + align - 1;
+  Chunk *next = current_ ? current_->next : head_;
+  if (!next || next->size < needed) {
+    const size_t chunk_size = std::max(needed, next_chunk_size_);
+    next_chunk_size_ = std::min(next_chunk_size_ * 2, kMaxChunkSize);
+    auto *chunk =
+        static_cast<Chunk *>(::operator new(sizeof(Chunk) + chunk_size));
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    chunk->next = next;
+    if (current_) {
+      current_->next = chunk;
+    } else {
+      head_ = chunk;
+    }
+    reserved_ += chunk_size;
+    next = chunk;
+  }
+  enter(next);
+  return Allocate(size, align);
+}
+
+void Arena::Reset() {
+  if (!head_) return;
+  current_ = nullptr;
+  enter(head_);
+}
+
+void Arena::Release() {
+  for (Chunk *chunk = head_; chunk;) {
+    Chunk *next = chunk->next;
+    ::operator delete(chunk);
+    chunk = next;
+  }
+  head_ = current_ = nullptr;
+  ptr_ = end_ = 0;
+  reserved_ = 0;
+}
+
+size_t Arena::BytesUsed() const {
+  if (!current_) return 0;
+  size_t used = 0;
+  for (Chunk *chunk = head_; chunk != current_; chunk = chunk->next) {
+    used += chunk->used;
+  }
+  return used + (ptr_ - reinterpret_cast<uintptr_t>(current_->data()));
+}
+}  // namespace TX
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+#include "TX/Memory.h"
+#include "TX/Platform.h"
+
+namespace TX {
+class Arena;
+
+// Adapts an Arena to std::pmr, so that pmr containers can put their memory in
+// it. Deallocation does nothing, the memory comes back on Arena::Reset.
+class ArenaResource final : public std::pmr::memory_resource {
+ public:
+  explicit ArenaResource(Arena &arena) : arena_(arena) {}
+
+ private:
+  void *do_allocate(size_t bytes, size_t align) override;
+  void do_deallocate(void *, size_t, size_t) override {}
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  Arena &arena_;
+};
+
+// A bump allocator for scratch data that dies all at once, such as what gets
+// built while parsing a response or during one RunLoop iteration. Allocating
+// is a pointer bump in the common case; memory is only given back as a whole
+// by Reset, which is O(1) and keeps the chunks for reuse. Nothing allocated
+// here is ever destroyed, so either store trivially destructible things or let
+// them die with the arena, e.g. pmr containers using Resource().
+//
+// Not thread-safe.
+class Arena {
+ public:
+  static constexpr size_t kMinChunkSize = 4096;
+  static constexpr size_t kMaxChunkSize = 1 << 20;
+
+  explicit Arena(size_t chunk_size = kMinChunkSize);
+  ~Arena();
+  TX_DISALLOW_COPY(Arena)
+
+  TX_NODISCARD void *Allocate(const size_t size,
+                              const size_t align = alignof(std::max_align_t)) {
+    auto p = (ptr_ + align - 1) & ~(align - 1);
+    if (TX_UNLIKELY(p + size > end_ || p < ptr_)) {
+      return allocateSlow(size, align);
+    }
+    ptr_ = p + size;
+    return reinterpret_cast<void *>(p);
+  }
+
+  template <typename T, typename... Args>
+  TX_NODISCARD T *New(Args &&...args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "destructors of arena objects are never run");
+    return new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  // Makes all the memory available again. Chunks are kept, so an arena that
+  // is reset after every request or iteration soon stops allocating.
+  void Reset();
+  // Like Reset, but also frees all the chunks.
+  void Release();
+
+  std::pmr::memory_resource *Resource() { return &resource_; }
+
+  // Bytes handed out since the last Reset, alignment padding included.
+  TX_NODISCARD size_t BytesUsed() const;
+  // Bytes in chunks held by the arena.
+  TX_NODISCARD size_t BytesReserved() const { return reserved_; }
+
+ private:
+  struct Chunk;
+
+  void *allocateSlow(size_t size, size_t align);
+  void enter(Chunk *chunk);
+
+  // Chunks in the order they were first used. current_ is the one being
+  // bumped into, those after it are free.
+  Chunk *head_;
+  Chunk *current_;
+  uintptr_t ptr_;
+  uintptr_t end_;
+  size_t next_chunk_size_;
+  size_t reserved_;
+  ArenaResource resource_;
+};
+}  // namespace TX
@@ -0,0 +1,67 @@
+#include "TX/Arena.h"
+
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace TX {
+TEST(ArenaTest, Allocate) {
+  Arena arena;
+  EXPECT_EQ(arena.BytesReserved(), 0);
+  auto *a = static_cast<char *>(arena.Allocate(10, 1));
+  auto *b = static_cast<char *>(arena.Allocate(10, 1));
+  EXPECT_EQ(b, a + 10);
+  auto *c = arena.Allocate(8, 64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 64, 0);
+  EXPECT_EQ(arena.BytesReserved(), Arena::kMinChunkSize);
+}
+
+TEST(ArenaTest, Large) {
+  Arena arena;
+  void *p = arena.Allocate(3 * Arena::kMaxChunkSize);
+  EXPECT_NE(p, nullptr);
+  EXPECT_GE(arena.BytesReserved(), 3 * Arena::kMaxChunkSize);
+  EXPECT_GE(arena.BytesUsed(), 3 * Arena::kMaxChunkSize);
+}
+
+TEST(ArenaTest, ResetReusesChunks) {
+  Arena arena;
+  std::vector<void *> first;
+  for (int i = 0; i < 1000; i++) first.push_back(arena.Allocate(64));
+  const size_t reserved = arena.BytesReserved();
+  EXPECT_GT(reserved, Arena::kMinChunkSize);
+  arena.Reset();
+  EXPECT_EQ(arena.BytesUsed(), 0);
+  for (int i = 0; i < 1000; i++) EXPECT_EQ(arena.Allocate(64), first[i]);
+  EXPECT_EQ(arena.BytesReserved(), reserved);
+  arena.Release();
+  EXPECT_EQ(arena.BytesReserved(), 0);
+}
+
+TEST(ArenaTest, New) {
+  struct Point {
+    int x, y;
+  };
+  Arena arena;
+  const Point *p = arena.New<Point>(1, 2);
+  EXPECT_EQ(p->x, 1);
+  EXPECT_EQ(p->y, 2);
+}
+
+TEST(ArenaTest, Resource) {
+  Arena arena;
+  {
+    std::pmr::vector<std::pmr::string> names(arena.Resource());
+    for (int i = 0; i < 100; i++) {
+      names.emplace_back("a name long enough to be allocated " +
+                         std::to_string(i));
+    }
+    EXPECT_EQ(names[42], "a name long enough to be allocated 42");
+  }
+  EXPECT_GT(arena.BytesUsed(), 100 * 36);
+  arena.Reset();
+  EXPECT_EQ(arena.BytesUsed(), 0);
+}
+}  // namespace TX
@@ -0,0 +1,379 @@
+#include "TX/AsyncReporter.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "TX/BinaryLog.h"
+#include "TX/Platform.h"
+
+namespace TX {
+namespace {
+// A record in a ring, followed by its strings, or by the arguments of a
+// TX_LOG_BINARY call if `site` is set. Records are padded to 8 bytes, a size
+// of 0 marks the end of the ring as unused.
+struct Record {
+  uint32 size;
+  Logger::Level level;
+  int32_t line;
+  int64_t time;
+  const LogSite *site;
+  uint16 file;
+  uint16 scope;
+  uint16 function;
+  uint32 message;
+  uint32 suppressed;
+};
+
+constexpr size_t kRecordAlign = 8;
+
+size_t roundUp(const size_t n) {
+  return (n + kRecordAlign - 1) & ~(kRecordAlign - 1);
+}
+
+std::atomic<uint64> nextReporterId = 1;
+}  // namespace
+
+// A single-producer single-consumer ring of records. The producer is the
+// thread the ring belongs to, the consumer is the writer.
+class AsyncReporter::Ring final : public AtomicRefCounted<Ring> {
+ public:
+  explicit Ring(const size_t capacity)
+      : data_(new char[capacity]),
+        capacity_(capacity),
+        cached_head_(0),
+        reserved_tail_(0),
+        reported_dropped_(0),
+        closed_(false),
+        dropped_(0),
+        head_(0),
+        tail_(0) {}
+
+  // Producer only. Returns room for a record of `size` bytes, or null if the
+  // ring is full. The writer sees the record after Commit.
+  Record *Reserve(const size_t size) {
+    uint64 tail = tail_.load(std::memory_order_relaxed);
+    size_t pos = tail & (capacity_ - 1);
+    const size_t skip = pos + size > capacity_ ? capacity_ - pos : 0;
+    if (tail + skip + size - cached_head_ > capacity_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail + skip + size - cached_head_ > capacity_) return nullptr;
+    }
+    if (skip) {
+      reinterpret_cast<Record *>(data_.get() + pos)->size = 0;
+      tail += skip;
+      pos = 0;
+    }
+    reserved_tail_ = tail + size;
+    auto *record = reinterpret_cast<Record *>(data_.get() + pos);
+    record->size = size;
+    return record;
+  }
+  void Commit() { tail_.store(reserved_tail_, std::memory_order_release); }
+
+  // Keeps records small enough that a ring holds a few of them.
+  TX_NODISCARD size_t MaxRecordSize() const { return capacity_ / 2; }
+
+  // Producer only.
+  TX_NODISCARD bool IsHalfFull() const {
+    return tail_.load(std::memory_order_relaxed) - cached_head_ >
+           capacity_ / 2;
+  }
+
+  // Consumer only. Calls f with every record in the ring.
+  template <class F>
+  bool Drain(F &&f) {
+    uint64 head = head_.load(std::memory_order_relaxed);
+    const uint64 tail = tail_.load(std::memory_order_acquire);
+    if (head == tail) return false;
+    while (head != tail) {
+      const size_t pos = head & (capacity_ - 1);
+      const auto *record = reinterpret_cast<const Record *>(data_.get() + pos);
+      if (record->size == 0) {
+        head += capacity_ - pos;
+        continue;
+      }
+      f(*record);
+      head += record->size;
+      head_.store(head, std::memory_order_release);
+    }
+    head_.store(head, std::memory_order_release);
+    return true;
+  }
+
+  TX_NODISCARD bool IsEmpty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+  void Close() { closed_.store(true, std::memory_order_release); }
+  TX_NODISCARD bool IsClosed() const {
+    return closed_.load(std::memory_order_acquire);
+  }
+
+ private:
+  friend class AsyncReporter;
+
+  const std::unique_ptr<char[]> data_;
+  const size_t capacity_;
+  // Producer side.
+  uint64 cached_head_;
+  uint64 reserved_tail_;
+  // Consumer side.
+  uint64 reported_dropped_;
+  std::atomic<bool> closed_;
+  std::atomic<uint64> dropped_;
+  alignas(TX_CACHE_LINE_SIZE) std::atomic<uint64> head_;
+  alignas(TX_CACHE_LINE_SIZE) std::atomic<uint64> tail_;
+};
+
+namespace {
+// The ring of the current thread and the reporter it belongs to.
+struct LocalRing {
+  uint64 owner = 0;
+  AsyncReporter::Ring *ring = nullptr;
+  ~LocalRing();
+};
+
+thread_local LocalRing localRing;
+// Set once the thread's LocalRing is gone, records from later thread_local
+// destructors are reported synchronously.
+thread_local bool localRingExited = false;
+// The reporter whose writer is the current thread.
+thread_local const AsyncReporter *localWriter = nullptr;
+}  // namespace
+
+LocalRing::~LocalRing() {
+  if (ring) {
+    ring->Close();
+    ring->deref();
+  }
+  localRingExited = true;
+}
+
+AsyncReporter::AsyncReporter(Reporter *downstream, Options options)
+    : id_(nextReporterId.fetch_add(1, std::memory_order_relaxed)),
+      downstream_(downstream),
+      options_([&] {
+        options.ring_size =
+            std::bit_ceil(std::max<size_t>(options.ring_size, 4096));
+        return options;
+      }()),
+      wake_(false),
+      stopped_(false),
+      written_(0),
+      dropped_(0),
+      writer_(Thread::Spawn([this]() { run(); }, "TXLogWriter")) {}
+
+AsyncReporter::~AsyncReporter() { Stop(); }
+
+void AsyncReporter::Stop() {
+  if (stopped_.exchange(true, std::memory_order_acq_rel)) return;
+  state_.Lock()->stop = true;
+  wakeup_.NotifyOne();
+  writer_.Reset();
+  // Threads keep a reference to their ring until they log elsewhere.
+  rings_.Lock()->clear();
+}
+
+AsyncReporter::Ring *AsyncReporter::ring() {
+  if (TX_LIKELY(localRing.owner == id_)) return localRing.ring;
+  if (localRingExited) return nullptr;
+  // The ring of a previous reporter is left for its writer to finish.
+  if (localRing.ring) {
+    localRing.ring->Close();
+    localRing.ring->deref();
+  }
+  Ring *ring = new Ring(options_.ring_size);
+  rings_.Lock()->push_back(adoptRef(*ring));
+  localRing.owner = id_;
+  localRing.ring = ref(ring);
+  return ring;
+}
+
+template <class F>
+void AsyncReporter::push(Ring &ring, const Logger::Level level,
+                         const size_t size, F &&fill) {
+  // Fatal records are never dropped, they are the ones that explain a crash.
+  const bool block =
+      options_.overflow == Overflow::Block || level == Logger::Level::Fatal;
+  Record *record = ring.Reserve(size);
+  while (TX_UNLIKELY(!record)) {
+    if (block) {
+      // Sleeps until the writer has been through the rings since this try.
+      const uint64 drains = state_.Lock()->drains;
+      if ((record = ring.Reserve(size))) break;
+      if (!wake_.exchange(true, std::memory_order_relaxed)) {
+        wakeup_.NotifyOne();
+      }
+      bool exited;
+      {
+        auto state = state_.Lock();
+        while (state->drains == drains && !state->exited) {
+          flushed_.Wait(state);
+        }
+        exited = state->exited;
+      }
+      if (!exited) {
+        record = ring.Reserve(size);
+        continue;
+      }
+    }
+    // Dropped, or the writer is gone.
+    ring.dropped_.fetch_add(1, std::memory_order_relaxed);
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  record->level = level;
+  fill(*record);
+  ring.Commit();
+  if (ring.IsHalfFull() && !wake_.load(std::memory_order_relaxed) &&
+      !wake_.exchange(true, std::memory_order_relaxed)) {
+    wakeup_.NotifyOne();
+  }
+}
+
+void AsyncReporter::Report(const Logger::Log &log) {
+  if (TX_UNLIKELY(stopped_.load(std::memory_order_relaxed))) return;
+  Ring *ring = localWriter == this ? nullptr : this->ring();
+  const size_t file = std::min<size_t>(log.file_.size(), UINT16_MAX);
+  const size_t scope = std::min<size_t>(log.scope_.size(), UINT16_MAX);
+  const size_t function = std::min<size_t>(log.function_.size(), UINT16_MAX);
+  // Each string is followed by a NUL, see Logger::Log.
+  const size_t fixed = sizeof(Record) + file + scope + function + 4;
+  if (!ring || fixed >= ring->MaxRecordSize()) {
+    downstream_->Report(log);
+    return;
+  }
+  const size_t message =
+      std::min(log.message_.size(), ring->MaxRecordSize() - fixed);
+  push(*ring, log.level_, roundUp(fixed + message), [&](Record &record) {
+    record.line = log.line_;
+    record.time = static_cast<int64_t>(log.time_.UnixNano());
+    record.site = nullptr;
+    record.file = file;
+    record.scope = scope;
+    record.function = function;
+    record.message = message;
+    record.suppressed =
+        static_cast<uint32>(std::min<uint64>(log.suppressed_, UINT32_MAX));
+    char *p = reinterpret_cast<char *>(&record + 1);
+    for (const auto &[s, n] : {std::pair{log.file_.data(), file},
+                               std::pair{log.scope_.data(), scope},
+                               std::pair{log.function_.data(), function},
+                               std::pair{log.message_.data(), message}}) {
+      p = std::copy_n(s, n, p);
+      *p++ = '\0';
+    }
+  });
+}
+
+void AsyncReporter::ReportBinary(const LogSite &site, const Time time,
+                                 const char *args, const size_t size) {
+  if (TX_UNLIKELY(stopped_.load(std::memory_order_relaxed))) return;
+  Ring *ring = localWriter == this ? nullptr : this->ring();
+  if (!ring || sizeof(Record) + size > ring->MaxRecordSize()) {
+    downstream_->ReportBinary(site, time, args, size);
+    return;
+  }
+  push(*ring, site.level, roundUp(sizeof(Record) + size), [&](Record &record) {
+    record.time = static_cast<int64_t>(time.UnixNano());
+    record.site = &site;
+    record.message = size;
+    std::memcpy(&record + 1, args, size);
+  });
+}
+
+void AsyncReporter::Flush() {
+  if (localWriter == this) {
+    downstream_->Flush();
+    return;
+  }
+  auto state = state_.Lock();
+  const uint64 target = ++state->flush_requested;
+  wakeup_.NotifyOne();
+  while (state->flushed < target && !state->exited) flushed_.Wait(state);
+}
+
+AsyncReporter::Stats AsyncReporter::GetStats() const {
+  return {written_.load(std::memory_order_relaxed),
+          dropped_.load(std::memory_order_relaxed)};
+}
+
+void AsyncReporter::run() {
+  localWriter = this;
+  while (true) {
+    uint64 requested;
+    bool flush;
+    bool stop;
+    {
+      auto state = state_.Lock();
+      if (!state->stop && state->flush_requested == state->flushed &&
+          !wake_.load(std::memory_order_relaxed)) {
+        wakeup_.Wait(state, options_.flush_interval);
+      }
+      requested = state->flush_requested;
+      flush = requested != state->flushed;
+      stop = state->stop;
+    }
+    wake_.store(false, std::memory_order_relaxed);
+    // One flush per batch.
+    if (drain() || flush) downstream_->Flush();
+    {
+      auto state = state_.Lock();
+      state->flushed = requested;
+      state->exited = stop;
+      state->drains++;
+    }
+    flushed_.NotifyAll();
+    if (stop) return;
+  }
+}
+
+bool AsyncReporter::drain() {
+  std::vector<Ref<Ring>> rings = *rings_.Lock();
+  bool drained = false;
+  for (Ref<Ring> &ring : rings) {
+    const bool closed = ring->IsClosed();
+    drained |= ring->Drain([this](const Record &record) {
+      const char *p = reinterpret_cast<const char *>(&record + 1);
+      if (const LogSite *site = record.site) {
+        downstream_->ReportBinary(*site, Time(record.time), p, record.message);
+        written_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      const std::string_view file(p, record.file);
+      p += record.file + 1;
+      const std::string_view scope(p, record.scope);
+      p += record.scope + 1;
+      const std::string_view function(p, record.function);
+      p += record.function + 1;
+      const Logger::Log log(record.level, file, record.line, function, scope,
+                            {p, record.message}, Time(record.time),
+                            record.suppressed);
+      downstream_->Report(log);
+      written_.fetch_add(1, std::memory_order_relaxed);
+    });
+    const uint64 dropped = ring->dropped_.load(std::memory_order_relaxed);
+    if (dropped != ring->reported_dropped_) {
+      const std::string message =
+          "dropped " + std::to_string(dropped - ring->reported_dropped_) +
+          " log records, the ring was full";
+      const Logger::Log log(Logger::Level::Warn, Logger::Basename(__FILE__),
+                            __LINE__, __FUNCTION__, "TX", message);
+      downstream_->Report(log);
+      ring->reported_dropped_ = dropped;
+    }
+    // Nothing is pushed after closing, so a closed ring that was drained
+    // after it closed can go.
+    if (closed && ring->IsEmpty()) {
+      std::erase_if(*rings_.Lock(), [&](const Ref<Ring> &r) {
+        return r.ptr() == ring.ptr();
+      });
+    }
+  }
+  return drained;
+}
+}  // namespace TX
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "TX/Bits.h"
+#include "TX/Condvar.h"
+#include "TX/Log.h"
+#include "TX/Mutex.h"
+#include "TX/Own.h"
+#include "TX/Ref.h"
+#include "TX/Thread.h"
+#include "TX/Time.h"
+
+namespace TX {
+struct AsyncReporterOptions {
+  // What a thread does when its ring is full.
+  enum class Overflow {
+    // Drop the record. The writer reports how many were dropped.
+    Drop,
+    // Wait for the writer to make room.
+    Block,
+  };
+
+  // Bytes per thread, rounded up to a power of two.
+  size_t ring_size = 64 << 10;
+  Overflow overflow = Overflow::Drop;
+  // How long records may sit in a ring before the writer picks them up.
+  Duration flush_interval = Duration::MilliSecond(10);
+};
+
+// A Logger::Reporter that moves formatting and output off the logging thread.
+// Each thread copies its records into a ring buffer of its own, lock-free,
+// and a writer thread drains all the rings in batches into `downstream`,
+// which does the formatting and writing. TX_LOG_BINARY records are only
+// formatted there. Fatal records are flushed before Logger aborts.
+//
+//   AsyncReporter reporter(new Logger::Reporter);
+//   Logger::SetReporter(&reporter);
+class AsyncReporter final : public Logger::Reporter {
+ public:
+  using Options = AsyncReporterOptions;
+  using Overflow = AsyncReporterOptions::Overflow;
+
+  struct Stats {
+    uint64 written;
+    uint64 dropped;
+  };
+
+  // The buffer of one thread.
+  class Ring;
+
+  explicit AsyncReporter(Reporter *downstream, Options options = {});
+  ~AsyncReporter() override;
+  TX_DISALLOW_COPY(AsyncReporter)
+
+  void Report(const Logger::Log &log) override;
+  void ReportBinary(const LogSite &site, Time time, const char *args,
+                    size_t size) override;
+  // Returns when everything reported before the call has been written.
+  void Flush() override;
+  // Writes out what has been reported, stops the writer thread and frees the
+  // rings. Later records are dropped. Unlike destroying the reporter, this
+  // leaves it safe to call for threads that may still be in Report.
+  void Stop();
+
+  TX_NODISCARD Stats GetStats() const;
+
+ private:
+  struct State {
+    uint64 flush_requested = 0;
+    uint64 flushed = 0;
+    bool stop = false;
+    // Set by the writer as it returns.
+    bool exited = false;
+    // Passes of the writer over the rings, for producers waiting for room.
+    uint64 drains = 0;
+  };
+
+  Ring *ring();
+  template <class F>
+  void push(Ring &ring, Logger::Level level, size_t size, F &&fill);
+  void run();
+  // Writes out what is in the rings, returns whether there was anything.
+  bool drain();
+
+  const uint64 id_;
+  Reporter *downstream_;
+  const Options options_;
+  Mutex<std::vector<Ref<Ring>>> rings_;
+  Mutex<State> state_;
+  Condvar wakeup_;
+  // Signaled after every pass of the writer.
+  Condvar flushed_;
+  // Set by producers to wake the writer early, cleared by the writer.
+  std::atomic<bool> wake_;
+  std::atomic<bool> stopped_;
+  std::atomic<uint64> written_;
+  std::atomic<uint64> dropped_;
+  Own<Thread> writer_;
+};
+}  // namespace TX
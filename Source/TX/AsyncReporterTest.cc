@@ -0,0 +1,137 @@
+#include "TX/AsyncReporter.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "TX/Mutex.h"
+#include "TX/Thread.h"
+
+namespace TX {
+namespace {
+class Collector final : public Logger::Reporter {
+ public:
+  void Report(const Logger::Log &log) override {
+    while (blocked) std::this_thread::yield();
+    messages.Lock()->emplace_back(log.message_);
+  }
+  void Flush() override { flushes++; }
+
+  Mutex<std::vector<std::string>> messages;
+  std::atomic<bool> blocked = false;
+  std::atomic<int> flushes = 0;
+};
+
+void report(AsyncReporter &reporter, std::string message) {
+  const Logger::Log log(Logger::Level::Info, __FILE__, __LINE__, __FUNCTION__,
+                        "test", std::move(message));
+  reporter.Report(log);
+}
+}  // namespace
+
+TEST(AsyncReporterTest, Flush) {
+  Collector collector;
+  AsyncReporter reporter(&collector);
+  report(reporter, "hello");
+  reporter.Flush();
+  EXPECT_EQ(*collector.messages.Lock(), std::vector<std::string>{"hello"});
+  EXPECT_GE(collector.flushes.load(), 1);
+  EXPECT_EQ(reporter.GetStats().written, 1u);
+}
+
+TEST(AsyncReporterTest, Stop) {
+  Collector collector;
+  AsyncReporter reporter(&collector);
+  report(reporter, "before");
+  reporter.Stop();
+  EXPECT_EQ(*collector.messages.Lock(), std::vector<std::string>{"before"});
+  // Stopped, it drops records and no longer waits for a writer.
+  report(reporter, "after");
+  reporter.Flush();
+  reporter.Stop();
+  EXPECT_EQ(collector.messages.Lock()->size(), 1u);
+}
+
+TEST(AsyncReporterTest, Record) {
+  struct Last final : Logger::Reporter {
+    void Report(const Logger::Log &log) override {
+      level = log.level_;
+      file = log.file_;
+      line = log.line_;
+      scope = log.scope_;
+      time = log.time_.UnixNano();
+    }
+    Logger::Level level = Logger::Level::Trace;
+    std::string file, scope;
+    int line = 0;
+    uint64_t time = 0;
+  } last;
+  AsyncReporter reporter(&last);
+  const Logger::Log log(Logger::Level::Warn, Logger::Basename(__FILE__), 42,
+                        __FUNCTION__, "scope", "message");
+  reporter.Report(log);
+  reporter.Flush();
+  EXPECT_EQ(last.level, Logger::Level::Warn);
+  EXPECT_EQ(last.file, "AsyncReporterTest.cc");
+  EXPECT_EQ(last.line, 42);
+  EXPECT_EQ(last.scope, "scope");
+  EXPECT_EQ(last.time, log.time_.UnixNano());
+}
+
+TEST(AsyncReporterTest, ManyThreads) {
+  constexpr int kThreads = 4;
+  constexpr int kRecords = 10000;
+  Collector collector;
+  AsyncReporter reporter(&collector,
+                         {.overflow = AsyncReporter::Overflow::Block});
+  {
+    std::vector<Own<Thread>> threads;
+    for (int t = 0; t < kThreads; t++) {
+      threads.push_back(Thread::Spawn([&, t]() {
+        for (int i = 0; i < kRecords; i++) {
+          report(reporter, std::to_string(t) + ":" + std::to_string(i));
+        }
+      }));
+    }
+  }
+  reporter.Flush();
+  auto messages = collector.messages.Lock();
+  ASSERT_EQ(messages->size(), kThreads * kRecords);
+  // Records of one thread stay in order.
+  std::vector<int> next(kThreads, 0);
+  for (const std::string &message : *messages) {
+    const int t = std::stoi(message.substr(0, message.find(':')));
+    EXPECT_EQ(std::stoi(message.substr(message.find(':') + 1)), next[t]++);
+  }
+  EXPECT_EQ(reporter.GetStats().dropped, 0u);
+}
+
+TEST(AsyncReporterTest, DropWhenFull) {
+  Collector collector;
+  AsyncReporter reporter(&collector, {.ring_size = 4096});
+  collector.blocked = true;
+  // The writer gets stuck on the first record, the rest fill the ring.
+  for (int i = 0; i < 1000; i++) report(reporter, std::string(64, 'x'));
+  collector.blocked = false;
+  reporter.Flush();
+  const uint64 dropped = reporter.GetStats().dropped;
+  EXPECT_GT(dropped, 0u);
+  EXPECT_EQ(reporter.GetStats().written + dropped, 1000u);
+  auto messages = collector.messages.Lock();
+  EXPECT_EQ(messages->back(), "dropped " + std::to_string(dropped) +
+                                  " log records, the ring was full");
+}
+
+TEST(AsyncReporterTest, BlockWhenFull) {
+  Collector collector;
+  AsyncReporter reporter(
+      &collector,
+      {.ring_size = 4096, .overflow = AsyncReporter::Overflow::Block});
+  for (int i = 0; i < 1000; i++) report(reporter, std::string(64, 'x'));
+  reporter.Flush();
+  EXPECT_EQ(reporter.GetStats().dropped, 0u);
+  EXPECT_EQ(collector.messages.Lock()->size(), 1000u);
+}
+}  // namespace TX
@@ -0,0 +1,19 @@
+#include "TX/BenchAlloc.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> gMallocs = 0;
+
+void *operator new(const size_t size) {
+  gMallocs.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace TX {
+uint64_t BenchMallocs() { return gMallocs.load(std::memory_order_relaxed); }
+}  // namespace TX
@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+
+namespace TX {
+// Calls to the global operator new so far. BenchAlloc.cc replaces it in the
+// benchmark binary to count them.
+uint64_t BenchMallocs();
+}  // namespace TX
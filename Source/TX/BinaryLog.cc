@@ -0,0 +1,164 @@
+#include "TX/BinaryLog.h"
+
+#include <cstdio>
+
+namespace TX {
+namespace {
+// Reads the arguments back in the order they were written.
+class Reader {
+ public:
+  Reader(const char *args, const size_t size) : p_(args), end_(args + size) {}
+
+  TX_NODISCARD bool Done() const { return p_ == end_; }
+  TX_NODISCARD BinaryLog::Tag Peek() const {
+    return static_cast<BinaryLog::Tag>(*p_);
+  }
+
+  template <class T>
+  T Read() {
+    T value;
+    std::memcpy(&value, p_ + 1, sizeof(T));
+    p_ += 1 + sizeof(T);
+    return value;
+  }
+
+  const char *ReadString() {
+    uint32 n;
+    std::memcpy(&n, p_ + 1, sizeof(n));
+    const char *s = p_ + 1 + sizeof(n);
+    p_ = s + n + 1;
+    return s;
+  }
+
+ private:
+  const char *p_;
+  const char *end_;
+};
+
+template <class... T>
+void append(std::string &out, const std::string &spec, T... values) {
+  char buf[128];
+  const int n = std::snprintf(buf, sizeof(buf), spec.c_str(), values...);
+  if (n < 0) return;
+  if (static_cast<size_t>(n) < sizeof(buf)) {
+    out.append(buf, n);
+    return;
+  }
+  const size_t at = out.size();
+  out.resize(at + n + 1);
+  std::snprintf(out.data() + at, n + 1, spec.c_str(), values...);
+  out.resize(at + n);
+}
+
+bool isIntegerConversion(const char c) {
+  return std::strchr("diouxXc", c) != nullptr;
+}
+
+bool isFloatConversion(const char c) {
+  return std::strchr("fFeEgGaA", c) != nullptr;
+}
+}  // namespace
+
+std::string_view BinaryLog::Format(const LogSite &site, const char *args,
+                                   const size_t size) {
+  thread_local std::string out;
+  out.clear();
+  Reader reader(args, size);
+  for (const char *p = site.format; *p;) {
+    if (*p != '%') {
+      const char *q = std::strchr(p, '%');
+      if (!q) q = p + std::strlen(p);
+      out.append(p, q - p);
+      p = q;
+      continue;
+    }
+    if (p[1] == '%') {
+      out += '%';
+      p += 2;
+      continue;
+    }
+    // Flags, width and precision are kept, the length modifier is replaced
+    // by the one matching the stored argument.
+    const char *start = p++;
+    std::string spec = "%";
+    while (*p && std::strchr("-+ #0", *p)) spec += *p++;
+    bool bad = false;
+    for (int part = 0; part < 2 && !bad; part++) {
+      if (part == 1) {
+        if (*p != '.') break;
+        spec += *p++;
+      }
+      if (*p == '*') {
+        if (reader.Done() || reader.Peek() != Tag::Int) {
+          bad = true;
+          break;
+        }
+        spec += std::to_string(reader.Read<int64_t>());
+        p++;
+      }
+      while (*p >= '0' && *p <= '9') spec += *p++;
+    }
+    while (*p && std::strchr("hlLqjzt", *p)) p++;
+    const char conversion = *p;
+    if (conversion) p++;
+    if (bad || !conversion || reader.Done()) {
+      out.append(start, p - start);
+      continue;
+    }
+    switch (reader.Peek()) {
+      case Tag::Int: {
+        const auto value = reader.Read<int64_t>();
+        if (conversion == 'c') {
+          append(out, spec + 'c', static_cast<int>(value));
+        } else if (isFloatConversion(conversion)) {
+          append(out, spec + conversion, static_cast<double>(value));
+        } else {
+          append(out, spec + "ll" + (isIntegerConversion(conversion)
+                                         ? conversion
+                                         : 'd'),
+                 static_cast<long long>(value));
+        }
+        break;
+      }
+      case Tag::UInt: {
+        const auto value = reader.Read<uint64_t>();
+        if (isFloatConversion(conversion)) {
+          append(out, spec + conversion, static_cast<double>(value));
+        } else {
+          append(out, spec + "ll" + (isIntegerConversion(conversion) &&
+                                             conversion != 'c'
+                                         ? conversion
+                                         : 'u'),
+                 static_cast<unsigned long long>(value));
+        }
+        break;
+      }
+      case Tag::Double:
+        append(out, spec + (isFloatConversion(conversion) ? conversion : 'g'),
+               reader.Read<double>());
+        break;
+      case Tag::String:
+        append(out, spec + 's', reader.ReadString());
+        break;
+      case Tag::Pointer:
+        append(out, spec + 'p',
+               reinterpret_cast<void *>(reader.Read<uintptr_t>()));
+        break;
+    }
+  }
+  return out;
+}
+
+void BinaryLog::ReportSuppressed(const LogSite &site, const uint64 suppressed) {
+  // Not output(), a Fatal record is still to come.
+  Logger::reporter_->Report(Logger::Log(site.level, site.file, site.line,
+                                        site.function, site.scope, {},
+                                        Logger::Now(), suppressed));
+}
+
+void Logger::Reporter::ReportBinary(const LogSite &site, const Time time,
+                                    const char *args, const size_t size) {
+  Report(Log(site.level, site.file, site.line, site.function, site.scope,
+             BinaryLog::Format(site, args, size), time));
+}
+}  // namespace TX
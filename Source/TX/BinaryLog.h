@@ -0,0 +1,118 @@
+#pragma once
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "TX/Bits.h"
+#include "TX/Log.h"
+#include "TX/Platform.h"
+#include "TX/Time.h"
+
+namespace TX {
+// Logs like TX_LOG but defers formatting: the call copies the raw arguments
+// and a pointer to the static metadata of its call site, and the reporter
+// formats them later, e.g. AsyncReporter on its writer thread. The format is
+// printf-style. Strings are copied, so they need not outlive the call.
+#define TX_LOG_BINARY(level, scope, format, ...)                          \
+  do {                                                                    \
+    static TX::LogRateLimit txLogLimiter;                                 \
+    TX::uint64 txLogSuppressed = 0;                                       \
+    if (TX::Logger::ShouldLog(TX::Logger::Level::level) &&                \
+        txLogLimiter.Allow(TX::Logger::Level::level, txLogSuppressed)) {  \
+      static const TX::LogSite txLogSite{                                 \
+          TX::Logger::Level::level, format,                               \
+          TX::Logger::Basename(__FILE__), __LINE__,                       \
+          __FUNCTION__, scope};                                           \
+      if (txLogSuppressed) {                                              \
+        TX::BinaryLog::ReportSuppressed(txLogSite, txLogSuppressed);      \
+      }                                                                   \
+      TX::BinaryLog::Write(txLogSite __VA_OPT__(, ) __VA_ARGS__);         \
+    }                                                                     \
+  } while (false)
+
+// What is known about a log call at compile time.
+struct LogSite {
+  Logger::Level level;
+  const char *format;
+  const char *file;
+  int line;
+  const char *function;
+  const char *scope;
+};
+
+class BinaryLog {
+ public:
+  // Arguments of one call, beyond which strings are cut.
+  static constexpr size_t kMaxArgsSize = 1024;
+
+  enum class Tag : uint8 { Int, UInt, Double, String, Pointer };
+
+  template <class... Args>
+  static void Write(const LogSite &site, const Args &...args) {
+    char buf[kMaxArgsSize];
+    size_t size = 0;
+    (encode(buf, size, args), ...);
+    Logger::reporter_->ReportBinary(site, Logger::Now(), buf, size);
+    if (site.level == Logger::Level::Fatal) {
+      Logger::reporter_->Flush();
+      abort();
+    }
+  }
+
+  // Reports how many records of `site` the rate limit dropped, as a record
+  // of its own since binary records do not carry the count.
+  static void ReportSuppressed(const LogSite &site, uint64 suppressed);
+
+  // Formats the arguments written for `site`. The message is valid until the
+  // thread formats the next one.
+  static std::string_view Format(const LogSite &site, const char *args,
+                                 size_t size);
+
+ private:
+  template <class T>
+  static void put(char *buf, size_t &size, const Tag tag, const T &value) {
+    if (size + 1 + sizeof(T) > kMaxArgsSize) return;
+    buf[size++] = static_cast<char>(tag);
+    std::memcpy(buf + size, &value, sizeof(T));
+    size += sizeof(T);
+  }
+
+  // Strings are stored as a length, the bytes and a NUL.
+  static void putString(char *buf, size_t &size, const std::string_view s) {
+    if (size + 1 + sizeof(uint32) + 1 > kMaxArgsSize) return;
+    const auto n = static_cast<uint32>(std::min(
+        s.size(), kMaxArgsSize - size - 1 - sizeof(uint32) - 1));
+    buf[size++] = static_cast<char>(Tag::String);
+    std::memcpy(buf + size, &n, sizeof(n));
+    size += sizeof(n);
+    std::memcpy(buf + size, s.data(), n);
+    size += n;
+    buf[size++] = '\0';
+  }
+
+  template <class T>
+  static void encode(char *buf, size_t &size, const T &arg) {
+    if constexpr (std::is_same_v<T, bool> || std::is_enum_v<T>) {
+      put(buf, size, Tag::Int, static_cast<int64_t>(arg));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      put(buf, size, Tag::Int, static_cast<int64_t>(arg));
+    } else if constexpr (std::is_integral_v<T>) {
+      put(buf, size, Tag::UInt, static_cast<uint64_t>(arg));
+    } else if constexpr (std::is_floating_point_v<T>) {
+      put(buf, size, Tag::Double, static_cast<double>(arg));
+    } else if constexpr (std::is_convertible_v<const T &, const char *>) {
+      const char *s = arg;
+      putString(buf, size, s ? s : "(null)");
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      putString(buf, size, arg);
+    } else if constexpr (std::is_pointer_v<T>) {
+      put(buf, size, Tag::Pointer, reinterpret_cast<uintptr_t>(arg));
+    } else {
+      static_assert(sizeof(T) == 0, "type cannot be logged");
+    }
+  }
+};
+}  // namespace TX
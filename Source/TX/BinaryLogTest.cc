@@ -0,0 +1,101 @@
+#include "TX/BinaryLog.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "TX/AsyncReporter.h"
+
+namespace TX {
+namespace {
+class LastReporter final : public Logger::Reporter {
+ public:
+  void Report(const Logger::Log &log) override {
+    level = log.level_;
+    file = log.file_;
+    message = log.message_;
+  }
+
+  Logger::Level level = Logger::Level::Trace;
+  std::string file;
+  std::string message;
+};
+}  // namespace
+
+class BinaryLogTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    reporter_ = Logger::reporter_;
+    Logger::SetReporter(&last_);
+    Logger::SetLevel(Logger::Level::Debug);
+  }
+  void TearDown() override { Logger::SetReporter(reporter_); }
+
+  LastReporter last_;
+
+ private:
+  Logger::Reporter *reporter_ = nullptr;
+};
+
+TEST_F(BinaryLogTest, Format) {
+  TX_LOG_BINARY(Info, "test", "no arguments");
+  EXPECT_EQ(last_.message, "no arguments");
+  EXPECT_EQ(last_.level, Logger::Level::Info);
+  EXPECT_EQ(last_.file, "BinaryLogTest.cc");
+
+  TX_LOG_BINARY(Info, "test", "%d %5d|%-3d|%ld %lld", -1, 42, 7, 1L, 1LL << 40);
+  EXPECT_EQ(last_.message, "-1    42|7  |1 1099511627776");
+  TX_LOG_BINARY(Info, "test", "%u %x %08X %zu", 3u, 255u, 0xABCu, size_t(9));
+  EXPECT_EQ(last_.message, "3 ff 00000ABC 9");
+  TX_LOG_BINARY(Info, "test", "%.2f %g %e", 3.14159, 0.5, 1.0);
+  EXPECT_EQ(last_.message, "3.14 0.5 1.000000e+00");
+  TX_LOG_BINARY(Info, "test", "%c%c %s %.3s 100%%", 'o', 'k', "str", "abcdef");
+  EXPECT_EQ(last_.message, "ok str abc 100%");
+  TX_LOG_BINARY(Info, "test", "%*d|%-*s|", 4, 1, 3, "a");
+  EXPECT_EQ(last_.message, "   1|a  |");
+  TX_LOG_BINARY(Info, "test", "%d %d", true, Logger::Level::Warn);
+  EXPECT_EQ(last_.message, "1 3");
+}
+
+TEST_F(BinaryLogTest, Strings) {
+  std::string s = "a temporary string";
+  TX_LOG_BINARY(Info, "test", "%s, %s", s, std::string_view(s).substr(2, 9));
+  EXPECT_EQ(last_.message, "a temporary string, temporary");
+  const char *null = nullptr;
+  TX_LOG_BINARY(Info, "test", "%s", null);
+  EXPECT_EQ(last_.message, "(null)");
+  // Cut to what fits into the arguments buffer.
+  TX_LOG_BINARY(Info, "test", "%s", std::string(4096, 'x'));
+  EXPECT_LT(last_.message.size(), BinaryLog::kMaxArgsSize);
+  EXPECT_GT(last_.message.size(), BinaryLog::kMaxArgsSize - 16);
+}
+
+TEST_F(BinaryLogTest, Mismatch) {
+  TX_LOG_BINARY(Info, "test", "%d and %d", 1);
+  EXPECT_EQ(last_.message, "1 and %d");
+  TX_LOG_BINARY(Info, "test", "%s", 5);
+  EXPECT_EQ(last_.message, "5");
+  TX_LOG_BINARY(Info, "test", "%d", "five");
+  EXPECT_EQ(last_.message, "five");
+}
+
+TEST_F(BinaryLogTest, Level) {
+  Logger::SetLevel(Logger::Level::Error);
+  TX_LOG_BINARY(Info, "test", "skipped");
+  EXPECT_EQ(last_.message, "");
+  Logger::SetLevel(Logger::Level::Debug);
+}
+
+TEST_F(BinaryLogTest, Async) {
+  {
+    AsyncReporter async(&last_);
+    Logger::SetReporter(&async);
+    TX_LOG_BINARY(Warn, "test", "formatted on the %s thread", "writer");
+    async.Flush();
+    Logger::SetReporter(&last_);
+  }
+  EXPECT_EQ(last_.message, "formatted on the writer thread");
+  EXPECT_EQ(last_.level, Logger::Level::Warn);
+  EXPECT_EQ(last_.file, "BinaryLogTest.cc");
+}
+}  // namespace TX
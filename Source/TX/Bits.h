@@ -1,5 +1,13 @@
 #pragma once
 #include <cstdint>
+#include <type_traits>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#if defined(__SIZEOF_INT128__)
+#define TX_HAS_INT128 1
+#endif
 
 namespace TX {
 using int8 = int8_t;
@@ -11,23 +19,161 @@ using uint16 = uint16_t;
 using uint32 = uint32_t;
 using uint64 = uint64_t;
 
+// An unsigned 128-bit integer as two halves. Wrapping arithmetic, as for the
+// built-in unsigned types; multiplication and division use the compiler's
+// 128-bit support where there is some.
 class uint128 {
  public:
-  uint128(const uint64 hi = 0, const uint64 lo = 0) : hi_(hi), lo_(lo) {}
-  uint128(const int64 hi = 0, const int64 lo = 0) : hi_(hi), lo_(lo) {}
-  uint128(const uint64 n) : hi_(0), lo_(n) {}
-  uint128(const uint32 n) : hi_(0), lo_(n) {}
-  uint128(const uint16 n) : hi_(0), lo_(n) {}
-  uint128(const uint8 n) : hi_(0), lo_(n) {}
-  uint128(const int64 n) : hi_(0), lo_(n) {}
-  uint128(const int32 n) : hi_(0), lo_(n) {}
-  uint128(const int16 n) : hi_(0), lo_(n) {}
-  uint128(const int8 n) : hi_(0), lo_(n) {}
-
-  static uint128 FromBigEndianBytes(const uint8 *bytes) { return 0; }
-  void ToBigEndianBytes(uint8 *bytes) const {}
+  constexpr uint128() : hi_(0), lo_(0) {}
+  constexpr uint128(const uint64 hi, const uint64 lo) : hi_(hi), lo_(lo) {}
+  // Converts as to a built-in unsigned type, a negative `n` sign-extends.
+  template <class T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+  constexpr uint128(const T n)  // NOLINT(google-explicit-constructor)
+      : hi_(std::is_signed_v<T> && n < 0 ? ~uint64(0) : 0),
+        lo_(static_cast<uint64>(n)) {}
+
+  constexpr uint64 Hi() const { return hi_; }
+  constexpr uint64 Lo() const { return lo_; }
+  constexpr explicit operator bool() const { return hi_ || lo_; }
+
+  static uint128 FromBigEndianBytes(const uint8 *bytes) {
+    uint64 hi = 0, lo = 0;
+    for (int i = 0; i < 8; i++) hi = (hi << 8) | bytes[i];
+    for (int i = 8; i < 16; i++) lo = (lo << 8) | bytes[i];
+    return {hi, lo};
+  }
+  void ToBigEndianBytes(uint8 *bytes) const {
+    for (int i = 0; i < 8; i++) {
+      bytes[i] = static_cast<uint8>(hi_ >> (56 - 8 * i));
+      bytes[8 + i] = static_cast<uint8>(lo_ >> (56 - 8 * i));
+    }
+  }
+
+  friend constexpr bool operator==(const uint128 a, const uint128 b) {
+    return a.hi_ == b.hi_ && a.lo_ == b.lo_;
+  }
+  friend constexpr bool operator<(const uint128 a, const uint128 b) {
+    return a.hi_ < b.hi_ || (a.hi_ == b.hi_ && a.lo_ < b.lo_);
+  }
+  friend constexpr bool operator!=(const uint128 a, const uint128 b) {
+    return !(a == b);
+  }
+  friend constexpr bool operator>(const uint128 a, const uint128 b) {
+    return b < a;
+  }
+  friend constexpr bool operator<=(const uint128 a, const uint128 b) {
+    return !(b < a);
+  }
+  friend constexpr bool operator>=(const uint128 a, const uint128 b) {
+    return !(a < b);
+  }
+
+  friend constexpr uint128 operator~(const uint128 a) {
+    return {~a.hi_, ~a.lo_};
+  }
+  friend constexpr uint128 operator&(const uint128 a, const uint128 b) {
+    return {a.hi_ & b.hi_, a.lo_ & b.lo_};
+  }
+  friend constexpr uint128 operator|(const uint128 a, const uint128 b) {
+    return {a.hi_ | b.hi_, a.lo_ | b.lo_};
+  }
+  friend constexpr uint128 operator^(const uint128 a, const uint128 b) {
+    return {a.hi_ ^ b.hi_, a.lo_ ^ b.lo_};
+  }
+  // Shifts by 128 or more are undefined, as for the built-in types.
+  friend constexpr uint128 operator<<(const uint128 a, const int n) {
+    if (n == 0) return a;
+    if (n >= 64) return {a.lo_ << (n - 64), 0};
+    return {(a.hi_ << n) | (a.lo_ >> (64 - n)), a.lo_ << n};
+  }
+  friend constexpr uint128 operator>>(const uint128 a, const int n) {
+    if (n == 0) return a;
+    if (n >= 64) return {0, a.hi_ >> (n - 64)};
+    return {a.hi_ >> n, (a.lo_ >> n) | (a.hi_ << (64 - n))};
+  }
+
+  friend constexpr uint128 operator+(const uint128 a, const uint128 b) {
+    const uint64 lo = a.lo_ + b.lo_;
+    return {a.hi_ + b.hi_ + (lo < a.lo_), lo};
+  }
+  friend constexpr uint128 operator-(const uint128 a, const uint128 b) {
+    return {a.hi_ - b.hi_ - (a.lo_ < b.lo_), a.lo_ - b.lo_};
+  }
+  friend constexpr uint128 operator-(const uint128 a) { return uint128() - a; }
+  friend uint128 operator*(const uint128 a, const uint128 b) {
+    uint128 product = mul64(a.lo_, b.lo_);
+    product.hi_ += a.hi_ * b.lo_ + a.lo_ * b.hi_;
+    return product;
+  }
+  // Division by zero is undefined, as for the built-in types.
+  friend uint128 operator/(const uint128 a, const uint128 b) {
+    uint128 remainder;
+    return divMod(a, b, remainder);
+  }
+  friend uint128 operator%(const uint128 a, const uint128 b) {
+    uint128 remainder;
+    divMod(a, b, remainder);
+    return remainder;
+  }
+
+  uint128 &operator&=(const uint128 b) { return *this = *this & b; }
+  uint128 &operator|=(const uint128 b) { return *this = *this | b; }
+  uint128 &operator^=(const uint128 b) { return *this = *this ^ b; }
+  uint128 &operator<<=(const int n) { return *this = *this << n; }
+  uint128 &operator>>=(const int n) { return *this = *this >> n; }
+  uint128 &operator+=(const uint128 b) { return *this = *this + b; }
+  uint128 &operator-=(const uint128 b) { return *this = *this - b; }
+  uint128 &operator*=(const uint128 b) { return *this = *this * b; }
+  uint128 &operator/=(const uint128 b) { return *this = *this / b; }
+  uint128 &operator%=(const uint128 b) { return *this = *this % b; }
 
  private:
+#ifdef TX_HAS_INT128
+  constexpr explicit uint128(const unsigned __int128 n)
+      : hi_(static_cast<uint64>(n >> 64)), lo_(static_cast<uint64>(n)) {}
+  constexpr unsigned __int128 native() const {
+    return (static_cast<unsigned __int128>(hi_) << 64) | lo_;
+  }
+#endif  // TX_HAS_INT128
+
+  // The full product of two halves.
+  static uint128 mul64(const uint64 a, const uint64 b) {
+#if defined(TX_HAS_INT128)
+    return uint128(static_cast<unsigned __int128>(a) * b);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64 hi;
+    const uint64 lo = _umul128(a, b, &hi);
+    return {hi, lo};
+#else
+    const uint64 a_lo = a & 0xffffffff, a_hi = a >> 32;
+    const uint64 b_lo = b & 0xffffffff, b_hi = b >> 32;
+    const uint64 lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+    const uint64 lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    const uint64 cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+    return {hi_hi + (hi_lo >> 32) + (cross >> 32),
+            (cross << 32) | (lo_lo & 0xffffffff)};
+#endif
+  }
+
+  static uint128 divMod(const uint128 a, const uint128 b, uint128 &remainder) {
+#ifdef TX_HAS_INT128
+    remainder = uint128(a.native() % b.native());
+    return uint128(a.native() / b.native());
+#else
+    // Long division, a bit at a time.
+    uint128 quotient;
+    remainder = uint128();
+    for (int i = 127; i >= 0; i--) {
+      remainder = (remainder << 1) | ((a >> i) & 1);
+      if (remainder >= b) {
+        remainder -= b;
+        quotient |= uint128(1) << i;
+      }
+    }
+    return quotient;
+#endif  // TX_HAS_INT128
+  }
+
   uint64 hi_;
   uint64 lo_;
 };
@@ -0,0 +1,59 @@
+#include "TX/Bits.h"
+
+#include <cstring>
+#include <random>
+
+#include "gtest/gtest.h"
+
+namespace TX {
+TEST(BitsTest, Uint128) {
+  EXPECT_EQ(uint128(1) << 64, uint128(1, 0));
+  EXPECT_EQ(uint128(1, 0) >> 64, uint128(1));
+  EXPECT_EQ(uint128(-1), uint128(~uint64(0), ~uint64(0)));
+  EXPECT_EQ(uint128(~uint64(0)) + 1, uint128(1, 0));
+  EXPECT_EQ(uint128(1, 0) - 1, uint128(~uint64(0)));
+  EXPECT_EQ(uint128() - 1, uint128(-1));
+  EXPECT_EQ(uint128(~uint64(0)) * uint128(~uint64(0)),
+            uint128(~uint64(0) - 1, 1));
+  EXPECT_EQ(uint128(1, 0) / 3, uint128(0x5555555555555555));
+  EXPECT_EQ(uint128(1, 0) % 3, uint128(1));
+  EXPECT_LT(uint128(0, ~uint64(0)), uint128(1, 0));
+  EXPECT_FALSE(uint128());
+  EXPECT_TRUE(uint128(1, 0));
+}
+
+TEST(BitsTest, Uint128BigEndianBytes) {
+  uint8 bytes[16];
+  for (int i = 0; i < 16; i++) bytes[i] = static_cast<uint8>(i);
+  const uint128 n = uint128::FromBigEndianBytes(bytes);
+  EXPECT_EQ(n, uint128(0x0001020304050607, 0x08090a0b0c0d0e0f));
+  uint8 out[16];
+  n.ToBigEndianBytes(out);
+  EXPECT_EQ(std::memcmp(bytes, out, sizeof(out)), 0);
+}
+
+#ifdef TX_HAS_INT128
+TEST(BitsTest, Uint128MatchesBuiltin) {
+  using Builtin = unsigned __int128;
+  const auto of = [](const Builtin n) {
+    return uint128(static_cast<uint64>(n >> 64), static_cast<uint64>(n));
+  };
+  std::mt19937_64 random(42);
+  for (int i = 0; i < 10000; i++) {
+    const Builtin a = (Builtin(random()) << 64) | random();
+    // Small divisors too.
+    const Builtin b = i % 2 ? (Builtin(random()) << 64) | random()
+                            : Builtin(random() >> (random() % 64)) + 1;
+    const int shift = static_cast<int>(random() % 128);
+    EXPECT_EQ(of(a) + of(b), of(a + b));
+    EXPECT_EQ(of(a) - of(b), of(a - b));
+    EXPECT_EQ(of(a) * of(b), of(a * b));
+    EXPECT_EQ(of(a) / of(b), of(a / b));
+    EXPECT_EQ(of(a) % of(b), of(a % b));
+    EXPECT_EQ(of(a) << shift, of(a << shift));
+    EXPECT_EQ(of(a) >> shift, of(a >> shift));
+    EXPECT_EQ(of(a) < of(b), a < b);
+  }
+}
+#endif  // TX_HAS_INT128
+}  // namespace TX
@@ -0,0 +1,83 @@
+#include "TX/Cancellation.h"
+
+#include <thread>
+
+namespace TX {
+bool CancellationHandler::Register(const CancellationToken &token) {
+  TX_ASSERT(!state_, "CancellationHandler registered twice");
+  if (!token.state_) return false;
+  return token.state_.get()->add(this);
+}
+
+void CancellationHandler::Unregister() {
+  if (!state_) return;
+  state_->remove(this);
+  // May delete the state, so after remove has unlocked it.
+  state_ = nullptr;
+}
+
+CancellationState::~CancellationState() {
+  // Every registered handler holds a reference to us.
+  TX_ASSERT(shared_.Lock()->head == nullptr);
+}
+
+bool CancellationState::add(CancellationHandler *handler) {
+  auto shared = shared_.Lock();
+  if (IsCancelled()) return false;
+  handler->state_ = this;
+  handler->prev_ = nullptr;
+  handler->next_ = shared->head;
+  if (shared->head) shared->head->prev_ = handler;
+  shared->head = handler;
+  return true;
+}
+
+void CancellationState::remove(CancellationHandler *handler) {
+  auto shared = shared_.Lock();
+  if (running_.load(std::memory_order_acquire) == handler) {
+    // Running on the cancelling thread means we are called from OnCancel,
+    // waiting for ourselves would deadlock.
+    if (cancelling_thread_ == Thread::Current()) {
+      running_.store(nullptr, std::memory_order_release);
+    } else {
+      drop(shared);
+      while (running_.load(std::memory_order_acquire) == handler) {
+        std::this_thread::yield();
+      }
+      shared = shared_.Lock();
+    }
+  } else {
+    // A no-op for a handler that Cancel has popped already.
+    if (handler->prev_) handler->prev_->next_ = handler->next_;
+    if (handler->next_) handler->next_->prev_ = handler->prev_;
+    if (shared->head == handler) shared->head = handler->next_;
+  }
+  handler->prev_ = handler->next_ = nullptr;
+}
+
+void CancellationState::Cancel() {
+  auto shared = shared_.Lock();
+  if (cancelled_.exchange(true, std::memory_order_relaxed)) return;
+  // Keep alive while the handlers run, they may drop the last token.
+  const Ref<CancellationState> self(*this);
+  cancelling_thread_ = Thread::Current();
+  // Handlers are popped one at a time so that the ones unregistered by
+  // earlier handlers are never run.
+  while (CancellationHandler *handler = shared->head) {
+    shared->head = handler->next_;
+    if (shared->head) shared->head->prev_ = nullptr;
+    handler->prev_ = handler->next_ = nullptr;
+    running_.store(handler, std::memory_order_release);
+    drop(shared);
+    handler->OnCancel();
+    shared = shared_.Lock();
+    // A handler destroyed from its own OnCancel has reset running_ already.
+    // Either way the handler is not touched again: it may be destroyed as
+    // soon as running_ no longer points to it.
+    if (running_.load(std::memory_order_acquire) == handler) {
+      running_.store(nullptr, std::memory_order_release);
+    }
+  }
+  cancelling_thread_ = None;
+}
+}  // namespace TX
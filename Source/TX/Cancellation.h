@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+
+#include "TX/Memory.h"
+#include "TX/Mutex.h"
+#include "TX/Platform.h"
+#include "TX/Pool.h"
+#include "TX/Ref.h"
+#include "TX/Thread.h"
+
+namespace TX {
+class CancellationState;
+class CancellationToken;
+class CancelledAwaiter;
+
+// Gets notified once when the token it is registered on is cancelled.
+// Handlers are linked intrusively into the token's state, so registration
+// never allocates. A handler unregisters itself on destruction; if it is
+// being run by a cancelling thread at that moment, Unregister waits for
+// OnCancel to return, unless it is called from OnCancel itself. Subclasses
+// that may be destroyed while being cancelled on another thread should call
+// Unregister in their own destructor, before their members go away.
+class CancellationHandler {
+ public:
+  explicit CancellationHandler() = default;
+  virtual ~CancellationHandler() { Unregister(); }
+  TX_DISALLOW_COPY(CancellationHandler)
+
+  virtual void OnCancel() = 0;
+
+  // Returns false and does not register if the token is already cancelled.
+  bool Register(const CancellationToken &token);
+  void Unregister();
+
+ private:
+  friend CancellationState;
+  CancellationHandler *prev_ = nullptr;
+  CancellationHandler *next_ = nullptr;
+  // Set by Register and reset by Unregister only, on the thread owning the
+  // handler, so reading it takes no lock. It keeps the state alive for as
+  // long as the handler may be linked into it, cancelled or not.
+  RefPtr<CancellationState> state_;
+};
+
+class CancellationState final : public AtomicRefCounted<CancellationState>,
+                                public Pooled<CancellationState> {
+ public:
+  explicit CancellationState() : cancelled_(false), running_(nullptr) {}
+  ~CancellationState() override;
+
+  TX_NODISCARD bool IsCancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+  void Cancel();
+
+ private:
+  friend CancellationHandler;
+  bool add(CancellationHandler *handler);
+  void remove(CancellationHandler *handler);
+
+  struct Shared {
+    CancellationHandler *head = nullptr;
+  };
+
+  std::atomic<bool> cancelled_;
+  // The handler being run by the cancelling thread, if any.
+  std::atomic<CancellationHandler *> running_;
+  Option<Thread::Id> cancelling_thread_;
+  Mutex<Shared> shared_;
+};
+
+// A cheap, copyable view of a CancellationSource. Checking it is a single
+// relaxed load so it can be polled on hot paths. A default-constructed token
+// is never cancelled.
+class CancellationToken {
+ public:
+  explicit CancellationToken() = default;
+
+  TX_NODISCARD bool IsCancelled() const {
+    return state_ && state_.get()->IsCancelled();
+  }
+  TX_NODISCARD bool CanBeCancelled() const { return !!state_; }
+
+  // co_await token.WhenCancelled() suspends until the token is cancelled, the
+  // coroutine is resumed on the cancelling thread.
+  TX_NODISCARD CancelledAwaiter WhenCancelled() const;
+
+ private:
+  friend class CancellationSource;
+  friend CancellationHandler;
+  explicit CancellationToken(const RefPtr<CancellationState> &state)
+      : state_(state) {}
+  RefPtr<CancellationState> state_;
+};
+
+class CancelledAwaiter final : public CancellationHandler {
+ public:
+  ~CancelledAwaiter() override { Unregister(); }
+  bool await_ready() const { return token_.IsCancelled(); }
+  bool await_suspend(const std::coroutine_handle<> h) {
+    handle_ = h;
+    return Register(token_);
+  }
+  void await_resume() {}
+  void OnCancel() override { handle_.resume(); }
+
+ private:
+  friend CancellationToken;
+  explicit CancelledAwaiter(const CancellationToken &token) : token_(token) {}
+  CancellationToken token_;
+  std::coroutine_handle<> handle_;
+};
+
+inline CancelledAwaiter CancellationToken::WhenCancelled() const {
+  return CancelledAwaiter(*this);
+}
+
+// Owns a cancellation state and hands out tokens observing it. Sources form a
+// tree: a source created with a parent token is cancelled as soon as the
+// parent is, so cancelling the root of e.g. a task stops everything spawned on
+// its behalf.
+class CancellationSource {
+ public:
+  explicit CancellationSource()
+      : state_(adoptRef(*new CancellationState)) {}
+  explicit CancellationSource(const CancellationToken &parent)
+      : CancellationSource() {
+    link_.child = state_.ptr();
+    if (!link_.Register(parent) && parent.IsCancelled()) state_->Cancel();
+  }
+  ~CancellationSource() { link_.Unregister(); }
+  TX_DISALLOW_COPY(CancellationSource)
+
+  TX_NODISCARD CancellationToken GetToken() const {
+    return CancellationToken(state_.ptr());
+  }
+  TX_NODISCARD bool IsCancelled() const { return state_.ptr()->IsCancelled(); }
+  void Cancel() { state_->Cancel(); }
+
+ private:
+  struct ParentLink final : CancellationHandler {
+    CancellationState *child = nullptr;
+    void OnCancel() override { child->Cancel(); }
+  };
+
+  Ref<CancellationState> state_;
+  ParentLink link_;
+};
+}  // namespace TX
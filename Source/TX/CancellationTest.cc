@@ -0,0 +1,172 @@
+#include <atomic>
+#include <coroutine>
+#include <vector>
+
+#include "TX/Cancellation.h"
+#include "TX/Own.h"
+#include "TX/RunLoop.h"
+#include "TX/Thread.h"
+#include "TX/runtime/BlockingPool.h"
+#include "TX/runtime/TestDetached.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+struct CancellationTest : testing::Test {
+  void TearDown() override { RunLoop::ClearGlobalContext(); }
+};
+
+class MockHandler final : public CancellationHandler {
+ public:
+  explicit MockHandler() : n_cancel_(0) {}
+  ~MockHandler() override { Unregister(); }
+  void OnCancel() override { n_cancel_++; }
+  int n_cancel_;
+};
+
+TEST_F(CancellationTest, Token) {
+  const CancellationToken none;
+  EXPECT_FALSE(none.CanBeCancelled());
+  EXPECT_FALSE(none.IsCancelled());
+
+  CancellationSource source;
+  const CancellationToken token = source.GetToken();
+  EXPECT_TRUE(token.CanBeCancelled());
+  EXPECT_FALSE(token.IsCancelled());
+  source.Cancel();
+  EXPECT_TRUE(token.IsCancelled());
+  source.Cancel();
+  EXPECT_TRUE(source.IsCancelled());
+}
+
+TEST_F(CancellationTest, Handler) {
+  CancellationSource source;
+  MockHandler h1, h2, h3;
+  EXPECT_TRUE(h1.Register(source.GetToken()));
+  EXPECT_TRUE(h2.Register(source.GetToken()));
+  h2.Unregister();
+  source.Cancel();
+  source.Cancel();
+  EXPECT_EQ(h1.n_cancel_, 1);
+  EXPECT_EQ(h2.n_cancel_, 0);
+  EXPECT_FALSE(h3.Register(source.GetToken()));
+}
+
+TEST_F(CancellationTest, DestroyWhileCancelling) {
+  constexpr int kHandlers = 16;
+  for (int round = 0; round < 200; round++) {
+    CancellationSource source;
+    std::vector<Own<MockHandler>> handlers;
+    for (int i = 0; i < kHandlers; i++) {
+      handlers.emplace_back(new MockHandler);
+      EXPECT_TRUE(handlers.back()->Register(source.GetToken()));
+    }
+    std::atomic<bool> go = false;
+    {
+      Own<Thread> canceller = Thread::Spawn(
+          [&] {
+            while (!go.load()) {
+            }
+            source.Cancel();
+          },
+          "Canceller");
+      go.store(true);
+      // Each handler is destroyed before, while or after being run.
+      handlers.clear();
+    }
+    EXPECT_TRUE(source.IsCancelled());
+  }
+}
+
+TEST_F(CancellationTest, Tree) {
+  Own<CancellationSource> root(new CancellationSource);
+  CancellationSource child(root->GetToken());
+  CancellationSource grandchild(child.GetToken());
+  CancellationSource sibling(root->GetToken());
+  {
+    // A child going away first must unlink from its parent.
+    CancellationSource temp(root->GetToken());
+  }
+  sibling.Cancel();
+  EXPECT_FALSE(root->IsCancelled());
+  EXPECT_FALSE(grandchild.IsCancelled());
+  root->Cancel();
+  EXPECT_TRUE(child.IsCancelled());
+  EXPECT_TRUE(grandchild.IsCancelled());
+  // Children created from a cancelled parent start cancelled.
+  CancellationSource late(root->GetToken());
+  EXPECT_TRUE(late.IsCancelled());
+  root.Reset();
+  EXPECT_TRUE(grandchild.GetToken().IsCancelled());
+}
+
+TEST_F(CancellationTest, WhenCancelled) {
+  CancellationSource source;
+  int n = 0;
+  auto watcher = [&](const CancellationToken token) -> TestDetached {
+    co_await token.WhenCancelled();
+    n++;
+  };
+  watcher(source.GetToken());
+  watcher(source.GetToken());
+  EXPECT_EQ(n, 0);
+  source.Cancel();
+  EXPECT_EQ(n, 2);
+  watcher(source.GetToken());
+  EXPECT_EQ(n, 3);
+}
+
+TEST_F(CancellationTest, CrossThread) {
+  CancellationSource source;
+  std::atomic n = 0;
+  {
+    BlockingPool pool(2);
+    for (int i = 0; i < 2; i++) {
+      pool.Spawn(
+          [&, token = source.GetToken()] {
+            while (!token.IsCancelled()) {
+            }
+            n.fetch_add(1);
+          },
+          source.GetToken());
+    }
+    usleep(10 * 1000);
+    source.Cancel();
+  }
+  EXPECT_EQ(n.load(), 2);
+  // Tasks spawned with a cancelled token never run.
+  {
+    BlockingPool pool(1);
+    pool.Spawn([&] { n.fetch_add(1); }, source.GetToken());
+  }
+  EXPECT_EQ(n.load(), 2);
+}
+
+TEST_F(CancellationTest, RunLoop) {
+  class MockTimer final : public RunLoop::Timer {
+   public:
+    explicit MockTimer() : Timer(0, 1_ms, kTimerRepeatAlways), n_timeout_(0) {}
+    void OnTimeout(RunLoop &, RefPtr<RunLoop::Scope> &) override {
+      n_timeout_++;
+    }
+    int n_timeout_;
+  };
+  Ref<RunLoop> loop = RunLoop::Current();
+  loop->SetPeriod(1_ms);
+  CancellationSource source;
+  MockTimer timer;
+  timer.SetCancellationToken(source.GetToken());
+  loop->AddTimer(&timer);
+  int n_block = 0;
+  loop->PerformBlock([&] { n_block++; }, source.GetToken());
+  EXPECT_EQ(loop->Run(3), RunLoop::Status::Finished);
+  EXPECT_EQ(n_block, 1);
+  const int n_timeout = timer.n_timeout_;
+  EXPECT_GT(n_timeout, 0);
+
+  source.Cancel();
+  loop->PerformBlock([&] { n_block++; }, source.GetToken());
+  EXPECT_EQ(loop->Run(3), RunLoop::Status::Finished);
+  EXPECT_EQ(n_block, 1);
+  EXPECT_EQ(timer.n_timeout_, n_timeout);
+}
+}  // namespace TX
@@ -0,0 +1,109 @@
+#include "TX/Clock.h"
+
+#include <chrono>
+#include <thread>
+#ifdef TX_CLOCK_TSC
+#include <cpuid.h>
+#endif  // TX_CLOCK_TSC
+
+namespace TX {
+#ifdef TX_CLOCK_TSC
+namespace {
+// Whether the TSC ticks at a constant rate in every power state.
+bool hasInvariantTSC() {
+  unsigned a, b, c, d;
+  if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || a < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &a, &b, &c, &d);
+  return (d & (1u << 8)) != 0;
+}
+
+int64_t monotonicNano() {
+  const Clock::TimePoint now = Clock::Monotonic();
+  return now.sec * 1000000000 + now.nsec;
+}
+
+// A Monotonic reading and the TSC in the middle of it, out of the tightest of
+// a few tries, a preempted one is off by the time slice.
+void sample(uint64_t &tsc, int64_t &ns) {
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < 8; i++) {
+    const uint64_t begin = __rdtsc();
+    const int64_t now = monotonicNano();
+    const uint64_t end = __rdtsc();
+    if (end - begin < best) {
+      best = end - begin;
+      tsc = begin + (end - begin) / 2;
+      ns = now;
+    }
+  }
+}
+
+// Long enough for the sampling error to be a few ppm.
+constexpr int64_t kCalibrationNano = 10000000;
+
+std::atomic<bool> calibrationStarted{false};
+std::atomic<bool> calibrationFinishing{false};
+// The first sample, written before Clock::calibrating_ is set.
+uint64_t startTSC;
+int64_t startNano;
+}  // namespace
+
+const Clock::TSC *Clock::finishCalibration() {
+  // Monotonic, not Fast: this runs for every Fast read until it is done.
+  if (!calibrating_.load(std::memory_order_acquire) ||
+      monotonicNano() - startNano < kCalibrationNano ||
+      calibrationFinishing.exchange(true, std::memory_order_relaxed)) {
+    return tsc_.load(std::memory_order_acquire);
+  }
+  static TSC tsc;
+  uint64_t end;
+  int64_t end_ns;
+  sample(end, end_ns);
+  if (end > startTSC && end_ns > startNano) {
+    tsc.base = end;
+    tsc.base_ns = static_cast<uint64_t>(end_ns);
+    tsc.mult = (static_cast<uint64_t>(end_ns - startNano) << TSC::kShift) /
+               (end - startTSC);
+  }
+  tsc_.store(&tsc, std::memory_order_release);
+  calibrating_.store(false, std::memory_order_relaxed);
+  return &tsc;
+}
+#endif  // TX_CLOCK_TSC
+
+void Clock::Calibrate(const bool wait) {
+#ifdef TX_CLOCK_TSC
+  if (!calibrationStarted.exchange(true, std::memory_order_relaxed)) {
+    if (hasInvariantTSC()) {
+      sample(startTSC, startNano);
+      calibrating_.store(true, std::memory_order_release);
+    } else {
+      // Coarse for good.
+      static const TSC none;
+      tsc_.store(&none, std::memory_order_release);
+    }
+  }
+  while (wait && !finishCalibration()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+#else
+  (void)wait;
+#endif  // TX_CLOCK_TSC
+}
+
+const char *Clock::FastSource() {
+#ifdef TX_CLOCK_TSC
+  const TSC *tsc = tsc_.load(std::memory_order_acquire);
+  if (tsc && tsc->mult) return "tsc";
+#endif  // TX_CLOCK_TSC
+#if defined(_WIN32)
+  return "monotonic";
+#elif defined(CLOCK_MONOTONIC_COARSE) || defined(CLOCK_MONOTONIC_RAW_APPROX)
+  return "coarse";
+#else
+  return "monotonic";
+#endif
+}
+}  // namespace TX
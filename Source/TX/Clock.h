@@ -1,10 +1,15 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <ctime>
 #endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <x86intrin.h>
+#define TX_CLOCK_TSC 1
+#endif
 
 namespace TX {
 using Tick = uint64_t;
@@ -12,18 +17,49 @@ using Tick = uint64_t;
 class Clock {
  public:
   enum struct Id {
-    Real = 0,
-    Monotonic = 6,
+    Real,
+    // The wall clock at the resolution of a scheduler tick, where the system
+    // has a cheaper clock for it.
+    RealCoarse,
+    Monotonic,
+    // A monotonic clock that is cheaper to read than Monotonic: the invariant
+    // TSC calibrated against Monotonic, or else CLOCK_MONOTONIC_COARSE. It
+    // may drift from Monotonic by a few ppm, so compare its readings only
+    // with each other.
+    Fast,
   };
   struct TimePoint {
     int64_t sec;
     int64_t nsec;
   };
   static TimePoint Now(Id id) {
+#ifdef TX_CLOCK_TSC
+    if (id == Id::Fast) {
+      const TSC *tsc = tsc_.load(std::memory_order_acquire);
+      if (!tsc &&
+          calibrating_.load(std::memory_order_relaxed)) {
+        tsc = finishCalibration();
+      }
+      if (tsc && tsc->mult) {
+        // A core whose TSC is a little behind the calibrating one, as on
+        // some VMs, reads before `base`.
+        const int64_t ticks = static_cast<int64_t>(__rdtsc() - tsc->base);
+        const uint64_t ns =
+            tsc->base_ns +
+            static_cast<uint64_t>(
+                (static_cast<unsigned __int128>(ticks > 0 ? ticks : 0) *
+                 tsc->mult) >>
+                TSC::kShift);
+        return {static_cast<int64_t>(ns / 1000000000),
+                static_cast<int64_t>(ns % 1000000000)};
+      }
+    }
+#endif  // TX_CLOCK_TSC
     TimePoint tp{};
 #ifdef _WIN32
     switch (id) {
       case Clock::Id::Real:
+      case Clock::Id::RealCoarse:
         FILETIME ft;
         GetSystemTimePreciseAsFileTime(&ft);
         // 将 FileTime 转换为 100 纳秒单位
@@ -37,6 +73,7 @@ class Clock {
         tp.nsec = (uli.QuadPart % 10'000'000) * 100;
         break;
       case Clock::Id::Monotonic:
+      case Clock::Id::Fast:
         static LARGE_INTEGER freq;
         if (!inited) {
           QueryPerformanceFrequency(&freq);
@@ -51,7 +88,7 @@ class Clock {
     }
 #else
     struct timespec ts{};
-    clock_gettime(static_cast<clockid_t>(id), &ts);
+    clock_gettime(clockId(id), &ts);
     tp.sec = ts.tv_sec;
     tp.nsec = ts.tv_nsec;
 #endif
@@ -60,8 +97,62 @@ class Clock {
 
   static TimePoint Real() { return Now(Id::Real); }
   static TimePoint Monotonic() { return Now(Id::Monotonic); }
+  static TimePoint Fast() { return Now(Id::Fast); }
+
+  // What Id::Fast reads: "tsc", "coarse" or "monotonic".
+  static const char *FastSource();
+
+  // Starts calibrating the TSC behind Id::Fast, if not started yet, at an
+  // init point such as TransportCoreInit or RunLoop creation. It takes a
+  // sample now and another from the first Id::Fast read 10ms later, which
+  // then switches from the coarse clock to the TSC. With `wait`, blocks
+  // until that is done.
+  static void Calibrate(bool wait = false);
 
  private:
+#ifndef _WIN32
+  static clockid_t clockId(const Id id) {
+    switch (id) {
+      case Id::Real:
+        return CLOCK_REALTIME;
+      case Id::RealCoarse:
+#ifdef CLOCK_REALTIME_COARSE
+        return CLOCK_REALTIME_COARSE;
+#else
+        return CLOCK_REALTIME;
+#endif
+      case Id::Fast:
+#if defined(CLOCK_MONOTONIC_COARSE)
+        return CLOCK_MONOTONIC_COARSE;
+#elif defined(CLOCK_MONOTONIC_RAW_APPROX)
+        return CLOCK_MONOTONIC_RAW_APPROX;
+#else
+        return CLOCK_MONOTONIC;
+#endif
+      case Id::Monotonic:
+      default:
+        return CLOCK_MONOTONIC;
+    }
+  }
+#endif  // _WIN32
+
+#ifdef TX_CLOCK_TSC
+  // Nanoseconds since `base` are (ticks * mult) >> kShift. `mult` is zero
+  // without an invariant TSC.
+  struct TSC {
+    static constexpr int kShift = 32;
+    uint64_t base = 0;
+    uint64_t base_ns = 0;
+    uint64_t mult = 0;
+  };
+  // Takes the second sample if it is time, returns the TSC once published.
+  static const TSC *finishCalibration();
+  // Null until calibrated.
+  static inline std::atomic<const TSC *> tsc_{nullptr};
+  // Set between the two samples.
+  static inline std::atomic<bool> calibrating_{false};
+#endif  // TX_CLOCK_TSC
+
 #ifdef _WIN32
   static bool inited;
 #endif
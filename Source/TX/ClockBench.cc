@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#include "TX/Clock.h"
+#include "TX/Time.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+namespace {
+// Keeps the readings from being optimized out.
+volatile int64_t gSink;
+}  // namespace
+
+// Measures what a reading of each clock costs, the smallest step it takes
+// and, for the monotonic ones, how far it is from Monotonic: right after
+// calibration and again after a second of drift.
+class ClockBench : public testing::Test {
+ protected:
+  using SteadyClock = std::chrono::steady_clock;
+  static constexpr int kReads = 10000000;
+
+  static void SetUpTestSuite() { Clock::Calibrate(true); }
+
+  static int64_t nanos(const Clock::TimePoint tp) {
+    return tp.sec * 1000000000 + tp.nsec;
+  }
+
+  static void run(const char *name, const Clock::Id id) {
+    int64_t sum = 0;
+    const SteadyClock::time_point start = SteadyClock::now();
+    for (int i = 0; i < kReads; i++) sum += Clock::Now(id).nsec;
+    const double read_ns = since(start) / kReads;
+
+    int64_t step = INT64_MAX;
+    int64_t last = nanos(Clock::Now(id));
+    for (int i = 0; i < 1000000 && step == INT64_MAX; i++) {
+      const int64_t now = nanos(Clock::Now(id));
+      if (now != last) step = now - last;
+      last = now;
+    }
+    gSink = sum;
+    std::printf("%-11s read %6.2f ns, step %8lld ns\n", name, read_ns,
+                static_cast<long long>(step));
+  }
+
+  static double since(const SteadyClock::time_point start) {
+    return std::chrono::duration<double, std::nano>(SteadyClock::now() - start)
+        .count();
+  }
+
+  // The largest difference from Monotonic over a few readings.
+  static int64_t offset() {
+    int64_t max = 0;
+    for (int i = 0; i < 1000; i++) {
+      const int64_t fast = nanos(Clock::Fast());
+      const int64_t monotonic = nanos(Clock::Monotonic());
+      max = std::max(max, std::abs(monotonic - fast));
+    }
+    return max;
+  }
+};
+
+TEST_F(ClockBench, Read) {
+  std::printf("Clock::Id::Fast reads %s\n", Clock::FastSource());
+  run("Real", Clock::Id::Real);
+  run("RealCoarse", Clock::Id::RealCoarse);
+  run("Monotonic", Clock::Id::Monotonic);
+  run("Fast", Clock::Id::Fast);
+
+  SteadyClock::time_point start = SteadyClock::now();
+  for (int i = 0; i < kReads; i++) gSink = Time::Now().UnixNano();
+  const double now_ns = since(start) / kReads;
+  start = SteadyClock::now();
+  for (int i = 0; i < kReads; i++) gSink = Time::FastNow().UnixNano();
+  const double fast_now_ns = since(start) / kReads;
+  std::printf("Time::Now %6.2f ns, Time::FastNow %6.2f ns\n", now_ns,
+              fast_now_ns);
+}
+
+TEST_F(ClockBench, Accuracy) {
+  const int64_t calibrated = offset();
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  const int64_t drifted = offset();
+  std::printf("Fast - Monotonic: %lld ns, a second later %lld ns\n",
+              static_cast<long long>(calibrated),
+              static_cast<long long>(drifted));
+}
+}  // namespace TX
@@ -1,59 +1,44 @@
 #pragma once
+#include <atomic>
+
 #include "TX/Assert.h"
+#include "TX/Futex.h"
 #include "TX/Mutex.h"
 #include "TX/Option.h"
 
 namespace TX {
+// A condition variable for Mutex, a futex sequence counter bumped on every
+// notification. Like any condition variable it may wake up spuriously.
 class Condvar {
  public:
-  explicit Condvar() {
-#ifdef _WIN32
-    InitializeConditionVariable(&cv);
-#else
-    TX_ASSERT_SYSCALL(pthread_cond_init(&cv_, nullptr));
-#endif
-  }
+  explicit Condvar() : seq_(0) {}
+  TX_DISALLOW_COPY(Condvar)
+
   void NotifyOne() {
-#ifdef _WIN32
-    WakeConditionVariable(&cv);
-#else
-    TX_ASSERT_SYSCALL(pthread_cond_signal(&cv_));
-#endif
+    seq_.fetch_add(1, std::memory_order_relaxed);
+    Futex::WakeOne(seq_);
   }
   void NotifyAll() {
-#ifdef _WIN32
-    WakeAllConditionVariable(&cv);
-#else
-    TX_ASSERT_SYSCALL(pthread_cond_broadcast(&cv_));
-#endif
+    seq_.fetch_add(1, std::memory_order_relaxed);
+    Futex::WakeAll(seq_);
   }
+
+  // Returns true if the timeout expired.
   template <typename T>
-  bool Wait(MutexGuard<T> &guard, Duration timeout = Duration::FOREVER) {
-    if (timeout != Duration::FOREVER) {
-#ifdef _WIN32
-      DWORD ms = timeout.MilliSeconds();
-      SleepConditionVariableCS(&cv, &guard.lock_->cs, ms);
-#else
-      const Clock::TimePoint tp = Time::After(timeout).ToTimePoint();
-      const int rc = pthread_cond_timedwait(
-          &cv_, &guard.lock_->inner_, reinterpret_cast<const timespec *>(&tp));
-      if (rc == ETIMEDOUT) return true;
-      TX_ASSERT(rc == 0, "rc(%d)，tp(%lu,%lu), mutex(%p)", rc, tp.sec, tp.nsec,
-                guard.lock_->inner_);
-#endif
-    } else {
-#ifdef _WIN32
-      SleepConditionVariableCS(&cv, &guard.lock_->cs, INFINITE);
-#else
-      TX_ASSERT_SYSCALL(pthread_cond_wait(&cv_, &guard.lock_->inner_));
-#endif
-    }
-    return false;
+  bool Wait(MutexGuard<T> &guard, const Duration timeout = Duration::FOREVER) {
+    // Read while still holding the lock, a notification sent after we unlock
+    // changes the counter and the futex won't sleep.
+    const uint32 seq = seq_.load(std::memory_order_relaxed);
+    // Time spent waiting here does not count as holding the lock.
+    guard.released();
+    guard.lock_->raw_.Unlock();
+    const bool woken = Futex::Wait(seq_, seq, timeout);
+    guard.lock_->raw_.Lock();
+    guard.reacquired();
+    return !woken;
   }
-#ifdef _WIN32
-  CONDITION_VARIABLE cv;
-#else
-  pthread_cond_t cv_{};
-#endif
+
+ private:
+  std::atomic<uint32> seq_;
 };
 }  // namespace TX
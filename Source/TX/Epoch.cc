@@ -0,0 +1,161 @@
+#include "TX/Epoch.h"
+
+#include "TX/Assert.h"
+#include "TX/Mutex.h"
+#include "TX/Platform.h"
+
+namespace TX {
+std::atomic<uint64> Epoch::global_ = 0;
+
+namespace {
+// Retire often enough to bound memory, rarely enough to amortize the scan
+// over all participants.
+constexpr size_t kCollectThreshold = 64;
+
+struct Retired {
+  void *p;
+  void (*deleter)(void *);
+  uint64 epoch;
+};
+
+// Handed over by exiting threads, freed by whoever collects next.
+Mutex<std::vector<Retired>> &orphans() {
+  static Mutex<std::vector<Retired>> orphans;
+  return orphans;
+}
+
+// Frees the entries retired at least two epochs before `epoch` and keeps
+// the rest.
+void reclaim(std::vector<Retired> &retired, const uint64 epoch) {
+  // Deleters may retire more objects, so work on a list of our own.
+  std::vector<Retired> pending;
+  pending.swap(retired);
+  for (const Retired &r : pending) {
+    if (r.epoch + 2 <= epoch) {
+      r.deleter(r.p);
+    } else {
+      retired.push_back(r);
+    }
+  }
+}
+}  // namespace
+
+// One per thread that ever pinned, in a list that only grows. Exited threads
+// leave theirs behind for the next new thread.
+struct alignas(TX_CACHE_LINE_SIZE) Epoch::Participant {
+  // The epoch it was pinned at, shifted left by one with the low bit set
+  // while pinned, zero otherwise.
+  std::atomic<uint64> state{0};
+  std::atomic<bool> in_use{true};
+  Participant *next = nullptr;
+
+  // Owner thread only.
+  uint32 pins = 0;
+  std::vector<Retired> retired;
+
+  static std::atomic<Participant *> head;
+
+  static Participant *Acquire() {
+    for (Participant *p = head.load(std::memory_order_acquire); p;
+         p = p->next) {
+      bool expected = false;
+      if (!p->in_use.load(std::memory_order_relaxed) &&
+          p->in_use.compare_exchange_strong(expected, true,
+                                            std::memory_order_acquire)) {
+        return p;
+      }
+    }
+    auto *p = new Participant;
+    p->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(p->next, p, std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+    return p;
+  }
+};
+
+std::atomic<Epoch::Participant *> Epoch::Participant::head = nullptr;
+
+namespace {
+struct Local {
+  Epoch::Participant *participant = nullptr;
+  ~Local() {
+    if (participant) Epoch::OnThreadExit();
+  }
+};
+thread_local Local local;
+}  // namespace
+
+static Epoch::Participant &self() {
+  if (TX_UNLIKELY(!local.participant)) {
+    local.participant = Epoch::Participant::Acquire();
+  }
+  return *local.participant;
+}
+
+void Epoch::pin() {
+  Participant &p = self();
+  if (p.pins++ > 0) return;
+  const uint64 epoch = global_.load(std::memory_order_relaxed);
+  p.state.store(epoch << 1 | 1, std::memory_order_relaxed);
+  // Orders the store above before any load of the protected structure,
+  // pairs with the fence in tryAdvance.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void Epoch::unpin() {
+  Participant &p = *local.participant;
+  if (--p.pins > 0) return;
+  p.state.store(0, std::memory_order_release);
+}
+
+static bool tryAdvance(std::atomic<uint64> &global) {
+  uint64 epoch = global.load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  for (Epoch::Participant *p =
+           Epoch::Participant::head.load(std::memory_order_acquire);
+       p; p = p->next) {
+    const uint64 state = p->state.load(std::memory_order_relaxed);
+    if ((state & 1) && (state >> 1) != epoch) return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return global.compare_exchange_strong(epoch, epoch + 1,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed);
+}
+
+void Epoch::Retire(void *p, void (*deleter)(void *)) {
+  Participant &self = TX::self();
+  self.retired.push_back(
+      {p, deleter, global_.load(std::memory_order_relaxed)});
+  if (self.retired.size() >= kCollectThreshold) Collect();
+}
+
+void Epoch::Collect() {
+  tryAdvance(global_);
+  const uint64 epoch = global_.load(std::memory_order_acquire);
+  reclaim(self().retired, epoch);
+  if (auto orphans = TX::orphans().TryLock()) {
+    reclaim(**orphans, epoch);
+  }
+}
+
+void Epoch::OnThreadExit() {
+  Participant *p = local.participant;
+  if (!p) return;
+  TX_ASSERT(p->pins == 0, "thread exits while pinned");
+  // Two advances are enough to free everything, unless someone else is
+  // pinned at an old epoch.
+  for (int i = 0; i < 2 && !p->retired.empty(); i++) {
+    tryAdvance(global_);
+    reclaim(p->retired, global_.load(std::memory_order_acquire));
+  }
+  if (!p->retired.empty()) {
+    auto orphans = TX::orphans().Lock();
+    orphans->insert(orphans->end(), p->retired.begin(), p->retired.end());
+    p->retired.clear();
+  }
+  local.participant = nullptr;
+  p->in_use.store(false, std::memory_order_release);
+}
+}  // namespace TX
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "TX/Bits.h"
+#include "TX/Memory.h"
+#include "TX/Platform.h"
+
+namespace TX {
+// Epoch-based reclamation for lock-free data structures. Readers pin the
+// current epoch for as long as they hold pointers into a structure; a writer
+// unlinks an object and retires it, and it is freed once every thread that
+// was pinned when it got retired has unpinned. The global epoch only moves
+// on when all pinned threads have seen it, so anything retired two epochs ago
+// can no longer be reached.
+//
+// Pins are cheap and nest, but a thread pinned for long holds back all
+// reclamation. For references held across blocking calls, see HazardPointer.
+//
+//   auto guard = Epoch::Pin();
+//   Node *node = head.load(std::memory_order_acquire);
+//   ... unlink node ...
+//   Epoch::Retire(node);
+class Epoch {
+ public:
+  class Guard {
+   public:
+    TX_DISALLOW_COPY(Guard)
+    ~Guard() { Epoch::unpin(); }
+
+   private:
+    explicit Guard() { Epoch::pin(); }
+    friend class Epoch;
+  };
+
+  TX_NODISCARD static Guard Pin() { return Guard(); }
+
+  template <typename T>
+  static void Retire(T *t) {
+    Retire(t, [](void *p) { delete static_cast<T *>(p); });
+  }
+  // Calls `deleter(p)` once no pinned thread can see `p` any more. Retired
+  // objects are collected in batches by the retiring thread.
+  static void Retire(void *p, void (*deleter)(void *));
+
+  // Tries to advance the epoch and frees whatever is old enough.
+  static void Collect();
+  // Frees what the calling thread retired if it can, and hands the rest over
+  // to the threads that stay. Thread calls it on exit, other threads get it
+  // from a thread_local destructor.
+  static void OnThreadExit();
+
+  static uint64 Current() { return global_.load(std::memory_order_relaxed); }
+
+  // Per-thread state, defined in Epoch.cc.
+  struct Participant;
+
+ private:
+  static void pin();
+  static void unpin();
+
+  static std::atomic<uint64> global_;
+};
+}  // namespace TX
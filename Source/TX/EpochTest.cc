@@ -0,0 +1,102 @@
+#include "TX/Epoch.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "TX/Own.h"
+#include "TX/Thread.h"
+
+namespace TX {
+namespace {
+struct Node {
+  static inline std::atomic<int> live = 0;
+  explicit Node(const int v) : value(v) { live++; }
+  ~Node() {
+    value = -1;
+    live--;
+  }
+  int value;
+  Node *next = nullptr;
+};
+}  // namespace
+
+TEST(EpochTest, PinnedKeepsRetired) {
+  const int live = Node::live.load();
+  {
+    auto guard = Epoch::Pin();
+    Epoch::Retire(new Node(1));
+    for (int i = 0; i < 4; i++) Epoch::Collect();
+    EXPECT_EQ(Node::live.load(), live + 1);
+  }
+  for (int i = 0; i < 3; i++) Epoch::Collect();
+  EXPECT_EQ(Node::live.load(), live);
+}
+
+TEST(EpochTest, PinnedElsewhereKeepsRetired) {
+  const int live = Node::live.load();
+  std::atomic<bool> pinned = false, done = false;
+  {
+    Thread t([&]() {
+      auto guard = Epoch::Pin();
+      pinned = true;
+      while (!done) TX_CPU_RELAX();
+    });
+    while (!pinned) TX_CPU_RELAX();
+    Epoch::Retire(new Node(1));
+    for (int i = 0; i < 4; i++) Epoch::Collect();
+    EXPECT_EQ(Node::live.load(), live + 1);
+    done = true;
+  }
+  for (int i = 0; i < 3; i++) Epoch::Collect();
+  EXPECT_EQ(Node::live.load(), live);
+}
+
+TEST(EpochTest, ThreadExitFrees) {
+  const int live = Node::live.load();
+  {
+    Thread t([]() {
+      for (int i = 0; i < 10; i++) Epoch::Retire(new Node(i));
+    });
+  }
+  EXPECT_EQ(Node::live.load(), live);
+}
+
+// A Treiber stack whose readers peek at the top while it gets popped.
+TEST(EpochTest, Stack) {
+  constexpr int kReaders = 3, N = 20000;
+  std::atomic<Node *> head = nullptr;
+  std::atomic<bool> done = false, freed = false;
+  {
+    std::vector<Own<Thread>> threads;
+    threads.push_back(Thread::Spawn([&]() {
+      for (int i = 0; i < N; i++) {
+        auto *node = new Node(i);
+        node->next = head.load();
+        while (!head.compare_exchange_weak(node->next, node)) {
+        }
+        auto guard = Epoch::Pin();
+        Node *top = head.load();
+        while (top && !head.compare_exchange_weak(top, top->next)) {
+        }
+        if (top) Epoch::Retire(top);
+      }
+      done = true;
+    }));
+    for (int i = 0; i < kReaders; i++) {
+      threads.push_back(Thread::Spawn([&]() {
+        while (!done) {
+          auto guard = Epoch::Pin();
+          if (Node *top = head.load(); top && top->value < 0) freed = true;
+        }
+      }));
+    }
+  }
+  EXPECT_FALSE(freed.load());
+  while (Node *top = head.load()) {
+    head = top->next;
+    delete top;
+  }
+}
+}  // namespace TX
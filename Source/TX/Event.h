@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+
+#include "TX/Bits.h"
+#include "TX/Futex.h"
+#include "TX/Memory.h"
+#include "TX/Time.h"
+
+namespace TX {
+// A one-shot event: once Set, it stays set and every Wait returns at once.
+class Event {
+ public:
+  explicit Event() : state_(kUnset) {}
+  TX_DISALLOW_COPY(Event)
+
+  void Set() {
+    if (state_.exchange(kSet, std::memory_order_release) == kUnset) {
+      Futex::WakeAll(state_);
+    }
+  }
+  TX_NODISCARD bool IsSet() const {
+    return state_.load(std::memory_order_acquire) == kSet;
+  }
+
+  // Returns false if the timeout expired before the event was set.
+  bool Wait(const Duration timeout = Duration::FOREVER) {
+    if (IsSet()) return true;
+    if (timeout == Duration::FOREVER) {
+      while (!IsSet()) Futex::Wait(state_, kUnset);
+      return true;
+    }
+    const Time deadline = Time::After(timeout);
+    while (!IsSet()) {
+      const Duration left = Time::Until(deadline);
+      if (left <= 0) return false;
+      Futex::Wait(state_, kUnset, left);
+    }
+    return true;
+  }
+
+ private:
+  static constexpr uint32 kUnset = 0;
+  static constexpr uint32 kSet = 1;
+  std::atomic<uint32> state_;
+};
+}  // namespace TX
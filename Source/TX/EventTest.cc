@@ -0,0 +1,29 @@
+#include "TX/Event.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "TX/Own.h"
+#include "TX/Thread.h"
+
+namespace TX {
+TEST(EventTest, Wait) {
+  Event event;
+  EXPECT_FALSE(event.IsSet());
+  EXPECT_FALSE(event.Wait(Duration::MilliSecond(10)));
+  std::atomic<int> n = 0;
+  {
+    std::vector<Own<Thread>> threads;
+    for (int i = 0; i < 3; i++) {
+      threads.push_back(Thread::Spawn([&] {
+        event.Wait();
+        n++;
+      }));
+    }
+    event.Set();
+  }
+  EXPECT_EQ(n.load(), 3);
+  EXPECT_TRUE(event.Wait(Duration::MilliSecond(10)));
+}
+}  // namespace TX
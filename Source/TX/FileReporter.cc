@@ -0,0 +1,232 @@
+#include "TX/FileReporter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif  // USE_ZLIB
+
+namespace TX {
+namespace {
+// Gzips `path` into `path`.gz and removes `path`, or leaves it as it was.
+bool gzip(const std::string &path) {
+#ifdef USE_ZLIB
+  std::FILE *in = std::fopen(path.c_str(), "rb");
+  if (!in) return false;
+  const std::string out_path = path + ".gz";
+  gzFile out = gzopen(out_path.c_str(), "wb");
+  if (!out) {
+    std::fclose(in);
+    return false;
+  }
+  bool ok = true;
+  char buf[64 << 10];
+  size_t n;
+  while (ok && (n = std::fread(buf, 1, sizeof(buf), in)) > 0) {
+    ok = gzwrite(out, buf, static_cast<unsigned>(n)) == static_cast<int>(n);
+  }
+  ok = !std::ferror(in) && ok;
+  std::fclose(in);
+  ok = gzclose(out) == Z_OK && ok;
+  std::remove(ok ? path.c_str() : out_path.c_str());
+  return ok;
+#else
+  (void)path;
+  return false;
+#endif  // USE_ZLIB
+}
+
+// Whether `name` is `base` rotated, compressed or not.
+bool isRotated(const std::string &name, const std::string &base) {
+  return name.size() > base.size() + 1 && name.starts_with(base) &&
+         name[base.size()] == '.' &&
+         std::isdigit(static_cast<unsigned char>(name[base.size() + 1]));
+}
+}  // namespace
+
+FileReporter::FileReporter(Options options)
+    : options_(std::move(options)),
+      buffer_(new char[options_.buffer_size]) {
+#ifdef USE_ZLIB
+  if (options_.compress) {
+    compressor_thread_ =
+        Thread::Spawn([this]() { compress(); }, "TXLogCompress");
+  }
+#endif  // USE_ZLIB
+  open(*state_.Lock(), Logger::Now());
+}
+
+FileReporter::~FileReporter() { Close(); }
+
+void FileReporter::Report(const Logger::Log &log) {
+  const std::string_view line = Logger::formatter_->Format(log);
+  const auto size = static_cast<uint32>(
+      std::min<size_t>(line.size(), UINT32_MAX - 2 * sizeof(uint32)));
+  const size_t record = size + 2 * sizeof(size);
+  auto state = state_.Lock();
+  const uint64 now = log.time_.UnixNano();
+  if (state->file &&
+      ((state->size + record > options_.max_size &&
+        state->size > kMagic.size()) ||
+       (options_.max_age.NanoSeconds() > 0 &&
+        now - state->opened >=
+            static_cast<uint64>(options_.max_age.NanoSeconds())))) {
+    rotate(*state, log.time_);
+  }
+  // Nowhere else to go.
+  if (!state->file) {
+    Reporter::Report(log);
+    return;
+  }
+  write(*state, reinterpret_cast<const char *>(&size), sizeof(size));
+  write(*state, line.data(), size);
+  write(*state, reinterpret_cast<const char *>(&size), sizeof(size));
+  state->size += record;
+}
+
+void FileReporter::Flush() {
+  auto state = state_.Lock();
+  flush(*state);
+}
+
+void FileReporter::Close() {
+  {
+    auto state = state_.Lock();
+    flush(*state);
+    if (state->file) std::fclose(state->file);
+    // Never reopened, rotation needs an open file.
+    state->file = nullptr;
+  }
+  compressor_.Lock()->stop = true;
+  compressor_wakeup_.NotifyOne();
+  compressor_thread_.Reset();
+}
+
+bool FileReporter::ReadRecords(const std::string &path,
+                               const std::function<void(std::string_view)> &f) {
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file) return false;
+  std::string data;
+  char buf[64 << 10];
+  size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), file)) > 0) data.append(buf, n);
+  std::fclose(file);
+  if (!std::string_view(data).starts_with(kMagic)) return false;
+  for (size_t pos = kMagic.size(); pos < data.size();) {
+    uint32 size, end;
+    if (data.size() - pos < 2 * sizeof(size)) return false;
+    std::memcpy(&size, data.data() + pos, sizeof(size));
+    if (data.size() - pos - 2 * sizeof(size) < size) return false;
+    std::memcpy(&end, data.data() + pos + sizeof(size) + size, sizeof(end));
+    if (end != size) return false;
+    f(std::string_view(data.data() + pos + sizeof(size), size));
+    pos += size + 2 * sizeof(size);
+  }
+  return true;
+}
+
+void FileReporter::open(State &state, const Time now) {
+  // A file left by a previous run may end with a torn record, appending to
+  // it would make the new records unreadable, so it is moved aside first.
+  std::error_code ec;
+  if (std::filesystem::file_size(options_.path, ec) > 0 && !ec &&
+      !moveAside(now)) {
+    return;
+  }
+  state.file = std::fopen(options_.path.c_str(), "wb");
+  if (!state.file) return;
+  // Buffered here already.
+  std::setvbuf(state.file, nullptr, _IONBF, 0);
+  state.opened = now.UnixNano();
+  write(state, kMagic.data(), kMagic.size());
+  state.size = kMagic.size();
+}
+
+void FileReporter::rotate(State &state, const Time now) {
+  flush(state);
+  std::fclose(state.file);
+  state.file = nullptr;
+  if (moveAside(now)) open(state, now);
+}
+
+bool FileReporter::moveAside(const Time now) {
+  const std::string millis = std::to_string(now.UnixMilli());
+  std::string rotated = options_.path + "." + millis;
+  // Several rotations in a millisecond.
+  for (int i = 1; std::filesystem::exists(rotated) ||
+                  std::filesystem::exists(rotated + ".gz");
+       i++) {
+    rotated = options_.path + "." + millis + "-" + std::to_string(i);
+  }
+  std::error_code ec;
+  std::filesystem::rename(options_.path, rotated, ec);
+  if (ec) return false;
+  if (compressor_thread_) {
+    compressor_.Lock()->paths.push_back(std::move(rotated));
+    compressor_wakeup_.NotifyOne();
+  } else {
+    removeOldFiles();
+  }
+  return true;
+}
+
+void FileReporter::write(State &state, const char *data, const size_t size) {
+  if (state.buffered + size > options_.buffer_size) flush(state);
+  if (size > options_.buffer_size) {
+    std::fwrite(data, 1, size, state.file);
+    return;
+  }
+  std::memcpy(buffer_.get() + state.buffered, data, size);
+  state.buffered += size;
+}
+
+void FileReporter::flush(State &state) {
+  if (state.file && state.buffered) {
+    std::fwrite(buffer_.get(), 1, state.buffered, state.file);
+  }
+  state.buffered = 0;
+}
+
+void FileReporter::removeOldFiles() const {
+  namespace fs = std::filesystem;
+  const fs::path path(options_.path);
+  const std::string base = path.filename().string();
+  const fs::path dir =
+      path.has_parent_path() ? path.parent_path() : fs::path(".");
+  std::vector<std::string> rotated;
+  std::error_code ec;
+  for (const fs::directory_entry &entry : fs::directory_iterator(dir, ec)) {
+    std::string name = entry.path().filename().string();
+    if (isRotated(name, base)) rotated.push_back(std::move(name));
+  }
+  if (rotated.size() <= static_cast<size_t>(std::max(options_.max_files, 0))) {
+    return;
+  }
+  // Named after the time they were rotated.
+  std::sort(rotated.begin(), rotated.end());
+  rotated.resize(rotated.size() - std::max(options_.max_files, 0));
+  for (const std::string &name : rotated) fs::remove(dir / name, ec);
+}
+
+void FileReporter::compress() {
+  while (true) {
+    std::string path;
+    {
+      auto compressor = compressor_.Lock();
+      while (compressor->paths.empty() && !compressor->stop) {
+        compressor_wakeup_.Wait(compressor);
+      }
+      // Whatever is queued is still compressed before stopping.
+      if (compressor->paths.empty()) return;
+      path = std::move(compressor->paths.front());
+      compressor->paths.pop_front();
+    }
+    gzip(path);
+    removeOldFiles();
+  }
+}
+}  // namespace TX
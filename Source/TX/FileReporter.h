@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "TX/Bits.h"
+#include "TX/Condvar.h"
+#include "TX/Log.h"
+#include "TX/Mutex.h"
+#include "TX/Own.h"
+#include "TX/Thread.h"
+#include "TX/Time.h"
+
+namespace TX {
+struct FileReporterOptions {
+  // The file written to. Rotated files are renamed to `path`.<unix millis>.
+  std::string path;
+  // Rotates once the file would grow beyond this many bytes.
+  size_t max_size = 64 << 20;
+  // Rotates once the file is this old, 0 for never.
+  Duration max_age = Duration::Hour(24);
+  // Rotated files kept, older ones are removed.
+  int max_files = 8;
+  // Gzips rotated files in the background, if built with zlib.
+  bool compress = true;
+  // Bytes buffered before a write.
+  size_t buffer_size = 1 << 20;
+};
+
+// A Logger::Reporter that appends records to a file, rotating it by size
+// and age. Each record is stored length-delimited:
+//
+//   uint32 size | size bytes of the formatted line | uint32 size
+//
+// in host byte order, after a file header of kMagic. A record cut short by
+// a crash does not end with its size again, so ReadRecords stops at it and
+// every record before it is intact.
+//
+// Records are buffered until the buffer is full or Flush is called, wrap it
+// in an AsyncReporter to flush them in the background:
+//
+//   AsyncReporter reporter(new FileReporter({.path = "TK.log"}));
+class FileReporter final : public Logger::Reporter {
+ public:
+  using Options = FileReporterOptions;
+
+  static constexpr std::string_view kMagic = "TXLOG01\n";
+
+  explicit FileReporter(Options options);
+  ~FileReporter() override;
+  TX_DISALLOW_COPY(FileReporter)
+
+  // Falls back to Logger::Reporter::Report if the file cannot be written.
+  void Report(const Logger::Log &log) override;
+  void Flush() override;
+  // Writes out what is buffered and closes the file, later records fall back
+  // like above. Unlike destroying the reporter, this leaves it safe to call
+  // for threads that may still be in Report.
+  void Close();
+
+  // Calls f with every intact record of a file written by a FileReporter.
+  // Returns false if the file is not one, or ends with a torn record.
+  static bool ReadRecords(const std::string &path,
+                          const std::function<void(std::string_view)> &f);
+
+ private:
+  struct State {
+    std::FILE *file = nullptr;
+    size_t size = 0;
+    // Unix nanoseconds.
+    uint64 opened = 0;
+    size_t buffered = 0;
+  };
+  struct Compressor {
+    std::deque<std::string> paths;
+    bool stop = false;
+  };
+
+  void open(State &state, Time now);
+  void rotate(State &state, Time now);
+  // Renames the file to a rotated one, returns false if it could not.
+  bool moveAside(Time now);
+  void write(State &state, const char *data, size_t size);
+  void flush(State &state);
+  void removeOldFiles() const;
+  void compress();
+
+  const Options options_;
+  const std::unique_ptr<char[]> buffer_;
+  Mutex<State> state_;
+  Mutex<Compressor> compressor_;
+  Condvar compressor_wakeup_;
+  Own<Thread> compressor_thread_;
+};
+}  // namespace TX
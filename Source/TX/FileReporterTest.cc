@@ -0,0 +1,148 @@
+#include "TX/FileReporter.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace TX {
+namespace fs = std::filesystem;
+
+class FileReporterTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() /
+           ("FileReporterTest." + std::to_string(Logger::Now().UnixNano()));
+    fs::create_directories(dir_);
+    path_ = (dir_ / "TX.log").string();
+  }
+  void TearDown() override { fs::remove_all(dir_); }
+
+  static void report(FileReporter &reporter, const std::string &message,
+                     const Time time = Logger::Now()) {
+    reporter.Report(Logger::Log(Logger::Level::Info, "file.cc", 1, "function",
+                                "TX", message, time));
+  }
+
+  static std::vector<std::string> read(const std::string &path,
+                                       bool *intact = nullptr) {
+    std::vector<std::string> lines;
+    const bool ok = FileReporter::ReadRecords(
+        path, [&](const std::string_view line) { lines.emplace_back(line); });
+    if (intact) *intact = ok;
+    return lines;
+  }
+
+  // The rotated files, compressed or not.
+  std::vector<std::string> rotated() const {
+    std::vector<std::string> names;
+    for (const auto &entry : fs::directory_iterator(dir_)) {
+      const std::string name = entry.path().filename().string();
+      if (name != "TX.log") names.push_back(name);
+    }
+    return names;
+  }
+
+  fs::path dir_;
+  std::string path_;
+};
+
+TEST_F(FileReporterTest, Records) {
+  {
+    FileReporter reporter({.path = path_});
+    report(reporter, "first");
+    report(reporter, "second");
+  }
+  bool intact = false;
+  const std::vector<std::string> lines = read(path_, &intact);
+  EXPECT_TRUE(intact);
+  ASSERT_EQ(lines.size(), 2u);
+  EXPECT_TRUE(lines[0].ends_with("[TX][file.cc:1][function] first"));
+  EXPECT_TRUE(lines[1].ends_with("[TX][file.cc:1][function] second"));
+}
+
+TEST_F(FileReporterTest, Flush) {
+  FileReporter reporter({.path = path_});
+  report(reporter, "message");
+  EXPECT_TRUE(read(path_).empty());
+  reporter.Flush();
+  EXPECT_EQ(read(path_).size(), 1u);
+}
+
+TEST_F(FileReporterTest, Close) {
+  FileReporter reporter({.path = path_});
+  report(reporter, "kept");
+  reporter.Close();
+  EXPECT_EQ(read(path_).size(), 1u);
+  // Goes to the fallback, not to the closed file.
+  report(reporter, "late");
+  reporter.Flush();
+  EXPECT_EQ(read(path_).size(), 1u);
+}
+
+TEST_F(FileReporterTest, TornRecord) {
+  {
+    FileReporter reporter({.path = path_});
+    report(reporter, "intact");
+    report(reporter, "torn");
+  }
+  fs::resize_file(path_, fs::file_size(path_) - 3);
+  bool intact = true;
+  const std::vector<std::string> lines = read(path_, &intact);
+  EXPECT_FALSE(intact);
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_TRUE(lines[0].ends_with("intact"));
+}
+
+TEST_F(FileReporterTest, RotateBySize) {
+  {
+    FileReporter reporter(
+        {.path = path_, .max_size = 256, .max_files = 2, .compress = false});
+    for (int i = 0; i < 20; i++) report(reporter, std::to_string(i));
+  }
+  const std::vector<std::string> names = rotated();
+  EXPECT_EQ(names.size(), 2u);
+  for (const std::string &name : names) {
+    bool intact = false;
+    EXPECT_FALSE(read((dir_ / name).string(), &intact).empty());
+    EXPECT_TRUE(intact);
+  }
+  const std::vector<std::string> lines = read(path_);
+  ASSERT_FALSE(lines.empty());
+  EXPECT_TRUE(lines.back().ends_with("] 19"));
+}
+
+TEST_F(FileReporterTest, RotateByAge) {
+  FileReporter reporter({.path = path_, .compress = false});
+  report(reporter, "old");
+  report(reporter, "new", Logger::Now() + Duration::Hour(25));
+  reporter.Flush();
+  const std::vector<std::string> names = rotated();
+  ASSERT_EQ(names.size(), 1u);
+  EXPECT_EQ(read((dir_ / names[0]).string()).size(), 1u);
+  EXPECT_EQ(read(path_).size(), 1u);
+}
+
+TEST_F(FileReporterTest, PreviousFileIsMovedAside) {
+  {
+    FileReporter previous({.path = path_, .compress = false});
+    report(previous, "previous");
+  }
+  FileReporter reporter({.path = path_, .compress = false});
+  EXPECT_EQ(rotated().size(), 1u);
+  EXPECT_TRUE(read(path_).empty());
+}
+
+#ifdef USE_ZLIB
+TEST_F(FileReporterTest, Compress) {
+  {
+    FileReporter reporter({.path = path_, .max_size = 256});
+    for (int i = 0; i < 10; i++) report(reporter, std::to_string(i));
+  }
+  const std::vector<std::string> names = rotated();
+  ASSERT_FALSE(names.empty());
+  for (const std::string &name : names) EXPECT_TRUE(name.ends_with(".gz"));
+}
+#endif  // USE_ZLIB
+}  // namespace TX
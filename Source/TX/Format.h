@@ -1,11 +1,14 @@
 #pragma once
+#include <algorithm>
 #include <string>
+#include <string_view>
 #if defined(USE_FMT)
 #include "fmt/format.h"
 #elif __cplusplus >= 202002L && !defined(__clang__)
 #include <format>
 #else
 #include <cstdarg>
+#include <cstdio>
 #endif
 
 namespace TX {
@@ -15,8 +18,32 @@ template <class... T>
 std::string TX::fmtlib_format(fmt::format_string<T...> format, T &&...args) {
   return fmt::vformat(format, fmt::make_format_args(args...));
 }
+// Like TX_FORMAT, but formats into a buffer of the thread that is reused by
+// the next call, and cuts the result at 2047 bytes.
+#define TX_FORMAT_VIEW(...) (TX::fmtlib_format_view(__VA_ARGS__))
+template <class... T>
+std::string_view fmtlib_format_view(fmt::format_string<T...> format,
+                                    T &&...args) {
+  thread_local char buf[2048];
+  const auto result = fmt::format_to_n(buf, sizeof(buf) - 1, format,
+                                       std::forward<T>(args)...);
+  *result.out = '\0';
+  return {buf, static_cast<size_t>(result.out - buf)};
+}
 #elif __cplusplus >= 202002L && !defined(__clang__)
 #define TX_FORMAT(fmt, ...) (std::format(fmt, __VA_ARGS__))
+// Like TX_FORMAT, but formats into a buffer of the thread that is reused by
+// the next call, and cuts the result at 2047 bytes.
+#define TX_FORMAT_VIEW(...) (TX::std_format_view(__VA_ARGS__))
+template <class... T>
+std::string_view std_format_view(std::format_string<T...> format,
+                                 T &&...args) {
+  thread_local char buf[2048];
+  const auto result = std::format_to_n(buf, sizeof(buf) - 1, format,
+                                       std::forward<T>(args)...);
+  *result.out = '\0';
+  return {buf, static_cast<size_t>(result.out - buf)};
+}
 #else
 #define TX_FORMAT(...) (TX::legacy_format(__VA_ARGS__))
 inline std::string legacy_format(const char *format, ...) {
@@ -26,5 +53,17 @@ inline std::string legacy_format(const char *format, ...) {
   std::vsnprintf(buf, 2048, format, ap);
   return buf;
 }
+// Like TX_FORMAT, but formats into a buffer of the thread that is reused by
+// the next call, and cuts the result at 2047 bytes.
+#define TX_FORMAT_VIEW(...) (TX::legacy_format_view(__VA_ARGS__))
+inline std::string_view legacy_format_view(const char *format, ...) {
+  thread_local char buf[2048];
+  va_list ap;
+  va_start(ap, format);
+  const int n = std::vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+  if (n < 0) return {};
+  return {buf, std::min<size_t>(n, sizeof(buf) - 1)};
+}
 #endif
 }  // namespace TX
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+
+#include "TX/Bits.h"
+#include "TX/Time.h"
+#ifdef _WIN32
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#else
+#include <algorithm>
+#include <thread>
+#endif
+
+namespace TX {
+// Wait-on-address primitive: futex(2) on Linux, WaitOnAddress on Windows and
+// std::atomic::wait elsewhere. Waiters are only woken by Wake* on the same
+// word, but may also wake up spuriously, so callers must loop.
+class Futex {
+ public:
+  // Blocks while `word` holds `expected`, for at most `timeout` measured on
+  // the monotonic clock. Returns false if the timeout expired.
+  static bool Wait(std::atomic<uint32> &word, const uint32 expected,
+                   const Duration timeout = Duration::FOREVER) {
+    const bool forever = timeout == Duration::FOREVER;
+#ifdef _WIN32
+    const DWORD ms =
+        forever ? INFINITE : static_cast<DWORD>(timeout.MilliSeconds());
+    uint32 compare = expected;
+    return WaitOnAddress(&word, &compare, sizeof(compare), ms) ||
+           GetLastError() != ERROR_TIMEOUT;
+#elif defined(__linux__)
+    struct timespec ts{};
+    if (!forever) {
+      if (timeout <= 0) return word.load(std::memory_order_relaxed) != expected;
+      ts.tv_sec = timeout.NanoSeconds() / 1000000000;
+      ts.tv_nsec = timeout.NanoSeconds() % 1000000000;
+    }
+    // A relative FUTEX_WAIT timeout is measured on CLOCK_MONOTONIC.
+    const long rc =
+        syscall(SYS_futex, reinterpret_cast<uint32 *>(&word),
+                FUTEX_WAIT_PRIVATE, expected, forever ? nullptr : &ts, nullptr,
+                0);
+    return rc == 0 || errno != ETIMEDOUT;
+#else
+    if (forever) {
+      word.wait(expected, std::memory_order_relaxed);
+      return true;
+    }
+    // std::atomic::wait has no timeout, poll with a bounded sleep instead.
+    const Time deadline = Time::After(timeout);
+    while (word.load(std::memory_order_relaxed) == expected) {
+      const Duration left = Time::Until(deadline);
+      if (left <= 0) return false;
+      std::this_thread::sleep_for(std::chrono::nanoseconds(
+          std::min<int64_t>(left.NanoSeconds(), 1000000)));
+    }
+    return true;
+#endif
+  }
+
+  // Returns true if a waiter was woken up. Only Linux can tell, elsewhere it
+  // always returns false.
+  static bool WakeOne(std::atomic<uint32> &word) {
+#ifdef _WIN32
+    WakeByAddressSingle(&word);
+    return false;
+#elif defined(__linux__)
+    return syscall(SYS_futex, reinterpret_cast<uint32 *>(&word),
+                   FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0) > 0;
+#else
+    word.notify_one();
+    return false;
+#endif
+  }
+
+  static void WakeAll(std::atomic<uint32> &word) {
+#ifdef _WIN32
+    WakeByAddressAll(&word);
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32 *>(&word), FUTEX_WAKE_PRIVATE,
+            INT32_MAX, nullptr, nullptr, 0);
+#else
+    word.notify_all();
+#endif
+  }
+};
+}  // namespace TX
@@ -0,0 +1,149 @@
+#include "TX/HazardPointer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "TX/Mutex.h"
+#include "TX/Platform.h"
+
+namespace TX {
+// Slots live in a list that only grows, a released slot is reused by the next
+// HazardPointer.
+struct alignas(TX_CACHE_LINE_SIZE) HazardPointer::Record {
+  std::atomic<const void *> p{nullptr};
+  std::atomic<bool> in_use{true};
+  Record *next = nullptr;
+
+  static std::atomic<Record *> head;
+  static std::atomic<size_t> count;
+
+  static Record *Acquire() {
+    for (Record *r = head.load(std::memory_order_acquire); r; r = r->next) {
+      bool expected = false;
+      if (!r->in_use.load(std::memory_order_relaxed) &&
+          r->in_use.compare_exchange_strong(expected, true,
+                                            std::memory_order_acquire)) {
+        return r;
+      }
+    }
+    auto *r = new Record;
+    r->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+    count.fetch_add(1, std::memory_order_relaxed);
+    return r;
+  }
+};
+
+std::atomic<HazardPointer::Record *> HazardPointer::Record::head = nullptr;
+std::atomic<size_t> HazardPointer::Record::count = 0;
+
+namespace {
+struct Retired {
+  void *p;
+  void (*deleter)(void *);
+};
+
+Mutex<std::vector<Retired>> &orphans() {
+  static Mutex<std::vector<Retired>> orphans;
+  return orphans;
+}
+
+// Scanning costs O(slots), so let the list grow with the number of slots to
+// keep the cost per retired object constant.
+size_t collectThreshold() {
+  return std::max<size_t>(
+      64, 2 * HazardPointer::Record::count.load(std::memory_order_relaxed));
+}
+
+// Frees the entries no slot protects and keeps the rest.
+void reclaim(std::vector<Retired> &retired) {
+  // Pairs with the fence in set(): a slot that still announces an object
+  // after it was unlinked is seen here.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::vector<const void *> hazards;
+  for (auto *r = HazardPointer::Record::head.load(std::memory_order_acquire);
+       r; r = r->next) {
+    if (const void *p = r->p.load(std::memory_order_relaxed)) {
+      hazards.push_back(p);
+    }
+  }
+  std::sort(hazards.begin(), hazards.end());
+  // Deleters may retire more objects, so work on a list of our own.
+  std::vector<Retired> pending;
+  pending.swap(retired);
+  for (const Retired &r : pending) {
+    if (std::binary_search(hazards.begin(), hazards.end(), r.p)) {
+      retired.push_back(r);
+    } else {
+      r.deleter(r.p);
+    }
+  }
+}
+
+// Enough for the few a thread holds at once.
+constexpr size_t kCacheSize = 8;
+
+struct Local {
+  std::vector<Retired> retired;
+  std::vector<HazardPointer *> cache;
+  ~Local() {
+    HazardPointer::OnThreadExit();
+    for (HazardPointer *hp : cache) delete hp;
+  }
+};
+thread_local Local local;
+}  // namespace
+
+HazardPointer::HazardPointer() : record_(Record::Acquire()) {}
+
+HazardPointer::~HazardPointer() {
+  record_->p.store(nullptr, std::memory_order_release);
+  record_->in_use.store(false, std::memory_order_release);
+}
+
+void HazardPointer::set(const void *p) {
+  record_->p.store(p, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+HazardPointer *HazardPointer::Acquire() {
+  if (local.cache.empty()) return new HazardPointer;
+  HazardPointer *hp = local.cache.back();
+  local.cache.pop_back();
+  return hp;
+}
+
+void HazardPointer::Release(HazardPointer *hp) {
+  // Unlike Reset, no fence: a reclaimer that still sees the old value only
+  // keeps the object a little longer.
+  hp->record_->p.store(nullptr, std::memory_order_release);
+  if (local.cache.size() < kCacheSize) {
+    local.cache.push_back(hp);
+  } else {
+    delete hp;
+  }
+}
+
+void HazardPointer::Retire(void *p, void (*deleter)(void *)) {
+  local.retired.push_back({p, deleter});
+  if (local.retired.size() >= collectThreshold()) Collect();
+}
+
+void HazardPointer::Collect() {
+  reclaim(local.retired);
+  if (auto orphans = TX::orphans().TryLock()) reclaim(**orphans);
+}
+
+void HazardPointer::OnThreadExit() {
+  if (local.retired.empty()) return;
+  reclaim(local.retired);
+  if (!local.retired.empty()) {
+    auto orphans = TX::orphans().Lock();
+    orphans->insert(orphans->end(), local.retired.begin(),
+                    local.retired.end());
+    local.retired.clear();
+  }
+}
+}  // namespace TX
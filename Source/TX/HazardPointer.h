@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+
+#include "TX/Bits.h"
+#include "TX/Memory.h"
+
+namespace TX {
+// A hazard pointer announces that its owner is using an object, which keeps
+// the object from being freed when it gets retired. Unlike an Epoch pin, it
+// only protects that one object, so it can be held for long, across blocking
+// calls for instance, without holding back the reclamation of anything else.
+// Protecting costs a store and a full fence per object.
+//
+//   HazardPointer hp;
+//   Node *node = hp.Protect(head);
+//   ... use node ...
+//   hp.Reset();
+//
+// Retired objects are freed in batches by the retiring thread, once a scan of
+// all hazard pointers finds them unprotected.
+class HazardPointer {
+ public:
+  explicit HazardPointer();
+  ~HazardPointer();
+  TX_DISALLOW_COPY(HazardPointer)
+
+  // Loads `src` and protects the result. The object is safe to use until the
+  // next Protect or Reset, or until this HazardPointer is gone.
+  template <typename T>
+  T *Protect(const std::atomic<T *> &src) {
+    T *p = src.load(std::memory_order_relaxed);
+    while (true) {
+      set(p);
+      // Only if it is still there could it not have been retired before we
+      // announced it.
+      T *q = src.load(std::memory_order_acquire);
+      if (p == q) return p;
+      p = q;
+    }
+  }
+  void Reset() { set(nullptr); }
+
+  // A HazardPointer out of the calling thread's cache, which saves looking for
+  // a free slot when many are taken and let go, one per read for instance.
+  // Give it back with Release, from any thread.
+  static HazardPointer *Acquire();
+  static void Release(HazardPointer *hp);
+
+  template <typename T>
+  static void Retire(T *t) {
+    Retire(t, [](void *p) { delete static_cast<T *>(p); });
+  }
+  static void Retire(void *p, void (*deleter)(void *));
+
+  // Frees every retired object that is not protected.
+  static void Collect();
+  // Like Epoch::OnThreadExit.
+  static void OnThreadExit();
+
+  // Slots are shared by all threads, defined in HazardPointer.cc.
+  struct Record;
+
+ private:
+  void set(const void *p);
+
+  Record *record_;
+};
+}  // namespace TX
@@ -0,0 +1,76 @@
+#include "TX/HazardPointer.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "TX/Own.h"
+#include "TX/Thread.h"
+
+namespace TX {
+namespace {
+struct Value {
+  static inline std::atomic<int> live = 0;
+  explicit Value(const int v) : a(v), b(v) { live++; }
+  ~Value() {
+    a = -1;
+    live--;
+  }
+  int a, b;
+};
+}  // namespace
+
+TEST(HazardPointerTest, ProtectedKeepsRetired) {
+  const int live = Value::live.load();
+  std::atomic<Value *> current = new Value(1);
+  HazardPointer hp;
+  Value *v = hp.Protect(current);
+  current = new Value(2);
+  HazardPointer::Retire(v);
+  HazardPointer::Collect();
+  EXPECT_EQ(Value::live.load(), live + 2);
+  EXPECT_EQ(v->a, 1);
+  hp.Reset();
+  HazardPointer::Collect();
+  EXPECT_EQ(Value::live.load(), live + 1);
+  delete current.load();
+}
+
+TEST(HazardPointerTest, ThreadExitFrees) {
+  const int live = Value::live.load();
+  {
+    Thread t([]() {
+      for (int i = 0; i < 10; i++) HazardPointer::Retire(new Value(i));
+    });
+  }
+  EXPECT_EQ(Value::live.load(), live);
+}
+
+TEST(HazardPointerTest, Swap) {
+  constexpr int kReaders = 3, N = 20000;
+  std::atomic<Value *> current = new Value(0);
+  std::atomic<bool> done = false, torn = false;
+  {
+    std::vector<Own<Thread>> threads;
+    threads.push_back(Thread::Spawn([&]() {
+      for (int i = 1; i <= N; i++) {
+        HazardPointer::Retire(current.exchange(new Value(i)));
+      }
+      done = true;
+    }));
+    for (int i = 0; i < kReaders; i++) {
+      threads.push_back(Thread::Spawn([&]() {
+        HazardPointer hp;
+        while (!done) {
+          const Value *v = hp.Protect(current);
+          if (v->a != v->b) torn = true;
+        }
+      }));
+    }
+  }
+  EXPECT_FALSE(torn.load());
+  EXPECT_EQ(current.load()->a, N);
+  delete current.load();
+}
+}  // namespace TX
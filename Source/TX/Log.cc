@@ -1,114 +1,129 @@
 #include "TX/Log.h"
 
-#include <cstddef>
+#include <algorithm>
+#include <charconv>
 #include <cstdio>
+#include <cstdlib>
+#include <ctime>
 #include <string>
 
 #include "TX/Exception.h"
 
-#ifdef USE_FMT
-#include "fmt/base.h"
-#include "fmt/format.h"
-#endif  // USE_FMT
-
-#ifdef _WIN32
-#else
-#include <cstdlib>
-#endif
-
-#ifdef USE_FMT
-template <>
-struct fmt::formatter<TX::Logger::Level> : formatter<string_view> {
-  format_context::iterator format(TX::Logger::Level level,
-                                  format_context &ctx) const {
-    string_view name = "U";
-    switch (level) {
-      case TX::Logger::Level::Trace:
-        name = "T";
-        break;
-      case TX::Logger::Level::Debug:
-        name = "D";
-        break;
-      case TX::Logger::Level::Info:
-        name = "I";
-        break;
-      case TX::Logger::Level::Warn:
-        name = "W";
-        break;
-      case TX::Logger::Level::Error:
-        name = "E";
-        break;
-      case TX::Logger::Level::Fatal:
-        name = "F";
-        break;
-    }
-    return formatter<string_view>::format(name, ctx);
-  }
-};
-#else
-const char *GetLogLevelString(TX::Logger::Level level) {
+namespace TX {
+namespace {
+const char *levelName(const Logger::Level level) {
   switch (level) {
-    case TX::Logger::Level::Trace:
+    case Logger::Level::Trace:
       return "T";
-    case TX::Logger::Level::Debug:
+    case Logger::Level::Debug:
       return "D";
-    case TX::Logger::Level::Info:
+    case Logger::Level::Info:
       return "I";
-    case TX::Logger::Level::Warn:
+    case Logger::Level::Warn:
       return "W";
-    case TX::Logger::Level::Error:
+    case Logger::Level::Error:
       return "E";
-    case TX::Logger::Level::Fatal:
+    case Logger::Level::Fatal:
       return "F";
   }
+  return "U";
+}
+}  // namespace
+
+void Logger::Formatter::AppendNumber(std::string &out, const int64_t n,
+                                     const int width) {
+  char buf[24];
+  const auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), n);
+  for (int i = static_cast<int>(end - buf); i < width; i++) out += '0';
+  out.append(buf, end);
+}
+
+// Down to the second, the time is formatted once per second per thread.
+void Logger::Formatter::AppendTime(std::string &out, const Time &time) {
+  thread_local struct {
+    int64_t sec = -1;
+    char date[32];
+    char zone[8];
+  } cache;
+  const auto ns = static_cast<int64_t>(time.UnixNano());
+  const int64_t sec = ns / 1000000000;
+  if (sec != cache.sec) {
+    const time_t t = sec;
+    struct tm tm {};
+    localtime_r(&t, &tm);
+    std::strftime(cache.date, sizeof(cache.date), "%Y-%m-%dT%H:%M:%S", &tm);
+    long off = tm.tm_gmtoff / 60;
+    if (off == 0) {
+      std::snprintf(cache.zone, sizeof(cache.zone), "Z");
+    } else {
+      const char sign = off < 0 ? '-' : '+';
+      if (off < 0) off = -off;
+      std::snprintf(cache.zone, sizeof(cache.zone), "%c%02ld:%02ld", sign,
+                    off / 60, off % 60);
+    }
+    cache.sec = sec;
+  }
+  out.append(cache.date);
+  out += '.';
+  AppendNumber(out, ns % 1000000000 / 1000000, 3);
+  out.append(cache.zone);
 }
-#endif  // USE_FMT
 
-namespace TX {
 static Logger::Reporter gReporter;
 static Logger::Formatter gFormatter;
 Logger::Level Logger::level_ = Level::Debug;
 Logger::Reporter *Logger::reporter_ = &gReporter;
 Logger::Formatter *Logger::formatter_ = &gFormatter;
 
-void Logger::Log::clean() {
-  const auto pos = file_.find_last_of('/');
-  if (pos != std::string::npos) {
-    file_ = file_.substr(pos + 1);
-  } else {
-#ifdef TK_SOURCE_DIR
-    file_ = file_.substr(sizeof TK_SOURCE_DIR);
-#endif
+void Logger::Log::output() const {
+  reporter_->Report(*this);
+  if (level_ == Level::Fatal) {
+    reporter_->Flush();
+    abort();
   }
 }
 
-void Logger::Log::output() const {
-  reporter_->Report(*this);
-  if (level_ == Level::Fatal) abort();
+void Logger::SetRateLimit(const double per_second, const int burst) {
+  LogRateLimit::burst_.store(std::max(burst, 1), std::memory_order_relaxed);
+  LogRateLimit::interval_.store(
+      per_second > 0 ? std::max<int64_t>(1e9 / per_second, 1) : 0,
+      std::memory_order_relaxed);
 }
 
 void Logger::Log::throwException() const { throw Exception(message_, scope_); }
 
-std::string Logger::Formatter::Format(const Logger::Log &log) {
-#ifdef USE_FMT
-  return fmt::format("[{:s}][{:s}][{:s}][{:s}:{:d}][{:s}] {}", log.level_,
-                     log.time_.Format(), log.scope_, log.file_, log.line_,
-                     log.function_, log.message_);
-#else
-  char buf[128];
-  std::snprintf(buf, sizeof(buf), "[%s][%s][%s][%s:%d][%s] %s",
-                GetLogLevelString(log.level_), log.time_.Format().c_str(),
-                log.scope_.c_str(), log.file_.c_str(), log.line_,
-                log.function_.c_str(), log.message_.c_str());
-  return buf;
-#endif  // USE_FMT
+std::string_view Logger::Formatter::Format(const Logger::Log &log) {
+  // Reused, so that lines stop allocating once it has grown.
+  thread_local std::string line;
+  line.clear();
+  line += '[';
+  line += levelName(log.level_);
+  line += "][";
+  AppendTime(line, log.time_);
+  line += "][";
+  line += log.scope_;
+  line += "][";
+  line += log.file_;
+  line += ':';
+  AppendNumber(line, log.line_);
+  line += "][";
+  line += log.function_;
+  line += "] ";
+  line += log.message_;
+  if (log.suppressed_) {
+    if (!log.message_.empty()) line += ' ';
+    line += "(suppressed ";
+    AppendNumber(line, static_cast<int64_t>(log.suppressed_));
+    line += ')';
+  }
+  return line;
 }
 
 void Logger::Reporter::Report(const Log &log) {
-#ifdef USE_FMT
-  fmt::println("{:s}", formatter_->Format(log));
-#else
-  printf("%s", formatter_->Format(log).c_str());
-#endif  // USE_FMT
+  const std::string_view line = formatter_->Format(log);
+  std::fwrite(line.data(), 1, line.size(), stdout);
+  std::fputc('\n', stdout);
 }
+
+void Logger::Reporter::Flush() { std::fflush(stdout); }
 }  // namespace TX
@@ -1,21 +1,53 @@
 #pragma once
 #include <string>
-#include <utility>
+#include <string_view>
 
+#include "TX/Bits.h"
+#include "TX/Clock.h"
 #include "TX/Format.h"
 #include "TX/Time.h"
 
 namespace TX {
-#define TX_LOG(level, scope, ...)                                             \
-  for (bool shouldLog = TX::Logger::ShouldLog(TX::Logger::Level::level);      \
-       shouldLog; shouldLog = false)                                          \
-  TX::Logger::Log(TX::Logger::Level::level, __FILE__, __LINE__, __FUNCTION__, \
-                  scope, TX_FORMAT(__VA_ARGS__))                              \
-      .output()
-
-#define TX_THROW(...)                                                      \
-  for (TX::Logger::Log log(TX::Logger::Level::Error, __FILE__, __LINE__,   \
-                           __FUNCTION__, "throw", TX_FORMAT(__VA_ARGS__)); \
+#ifdef BINARY_LOG
+// See TX_LOG_BINARY in BinaryLog.h.
+#define TX_LOG(level, scope, ...) TX_LOG_BINARY(level, scope, __VA_ARGS__)
+#else
+#define TX_LOG(level, scope, ...)                                     \
+  TX_LOG_LIMITED(level, scope, TX::LogRateLimit,                      \
+                 TX::Logger::Level::level, __VA_ARGS__)
+#endif  // BINARY_LOG
+
+// Logs if the static `limiter` of the call site lets the record through,
+// see LogLimit.h.
+#define TX_LOG_LIMITED(level, scope, limiter, limit, ...)                   \
+  do {                                                                      \
+    static limiter txLogLimiter;                                            \
+    TX::uint64 txLogSuppressed = 0;                                         \
+    if (TX::Logger::ShouldLog(TX::Logger::Level::level) &&                  \
+        txLogLimiter.Allow(limit, txLogSuppressed)) {                       \
+      TX::Logger::Log(TX::Logger::Level::level,                             \
+                      TX::Logger::Basename(__FILE__), __LINE__,             \
+                      __FUNCTION__, scope, TX_FORMAT_VIEW(__VA_ARGS__),     \
+                      TX::Logger::Now(), txLogSuppressed)                   \
+          .output();                                                        \
+    }                                                                       \
+  } while (false)
+
+// Logs the 1st, the n+1th, the 2n+1th... call of the site.
+#define TX_LOG_EVERY_N(level, scope, n, ...) \
+  TX_LOG_LIMITED(level, scope, TX::LogEveryN, n, __VA_ARGS__)
+// Logs the first n calls of the site.
+#define TX_LOG_FIRST_N(level, scope, n, ...) \
+  TX_LOG_LIMITED(level, scope, TX::LogFirstN, n, __VA_ARGS__)
+// Logs at most once per `duration`, a TX::Duration.
+#define TX_LOG_EVERY_DURATION(level, scope, duration, ...) \
+  TX_LOG_LIMITED(level, scope, TX::LogEveryDuration, duration, __VA_ARGS__)
+
+#define TX_THROW(...)                                                    \
+  for (TX::Logger::Log log(TX::Logger::Level::Error,                     \
+                           TX::Logger::Basename(__FILE__), __LINE__,     \
+                           __FUNCTION__, "throw",                        \
+                           TX_FORMAT_VIEW(__VA_ARGS__));                 \
        ; log.throwException())
 
 #define TX_TRACE(...) TX_LOG(Trace, "TX", __VA_ARGS__)
@@ -32,47 +64,42 @@ namespace TX {
 #define TX_ERROR_SCOPE(scope, ...) TX_LOG(Error, scope, __VA_ARGS__)
 #define TX_FATAL_SCOPE(scope, ...) TX_LOG(Fatal, scope, __VA_ARGS__)
 
+struct LogSite;
+
 class Logger {
  public:
   enum class Level { Trace, Debug, Info, Warn, Error, Fatal };
+  // A log record. It only refers to its strings, which are static or live
+  // at least as long as the record, and are NUL-terminated.
   class Log {
    public:
-    explicit Log(const Level level, const char *file, const int line,
-                 const char *function, const char *scope, std::string message)
-        : level_(level),
-          line_(line),
-          file_(file),
-          scope_(scope),
-          function_(function),
-          message_(std::move(message)),
-          time_(Time::Now()) {
-      clean();
-    }
-    explicit Log(const Level level, const char *file, const int line,
-                 const char *function, const char *scope)
+    explicit Log(const Level level, const std::string_view file,
+                 const int line, const std::string_view function,
+                 const std::string_view scope,
+                 const std::string_view message = {},
+                 const Time time = Logger::Now(), const uint64 suppressed = 0)
         : level_(level),
           line_(line),
+          suppressed_(suppressed),
           file_(file),
           scope_(scope),
           function_(function),
-          time_(Time::Now()) {
-      clean();
-    }
+          message_(message),
+          time_(time) {}
 
     Log(Log &) = delete;
     void output() const;
     void throwException() const;
 
-   private:
-    void clean();
-
-   public:
     Level level_;
     int line_;
-    std::string file_;
-    std::string scope_;
-    std::string function_;
-    std::string message_;
+    // Records of the same call site dropped by its limiter since the
+    // previous one.
+    uint64 suppressed_;
+    std::string_view file_;
+    std::string_view scope_;
+    std::string_view function_;
+    std::string_view message_;
     Time time_;
   };
 
@@ -80,22 +107,60 @@ class Logger {
    public:
     virtual ~Reporter() = default;
     virtual void Report(const Log &);
+    // Reports a record of TX_LOG_BINARY, `args` holds the raw arguments.
+    // Formats it and calls Report unless overridden.
+    virtual void ReportBinary(const LogSite &site, Time time, const char *args,
+                              size_t size);
+    // Makes sure what was reported is written, called before a Fatal record
+    // aborts the process.
+    virtual void Flush();
   };
 
   class Formatter {
    public:
     virtual ~Formatter() = default;
-    virtual std::string Format(const Log &);
+    // The line is valid until the thread formats the next one.
+    virtual std::string_view Format(const Log &);
+
+   protected:
+    // Appends `n`, zero-padded to `width` digits.
+    static void AppendNumber(std::string &out, int64_t n, int width = 0);
+    // Appends `time` in RFC 3339 with milliseconds, like Time::Format.
+    static void AppendTime(std::string &out, const Time &time);
   };
 
+  // Cuts the directories off __FILE__ at compile time.
+  static consteval const char *Basename(const char *path) {
+    const char *base = path;
+    for (const char *p = path; *p; p++) {
+      if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    return base;
+  }
+
+  // The time of a record, only the wall clock is needed.
+  static Time Now() {
+    const Clock::TimePoint now = Clock::Real();
+    return Time(now.sec, now.nsec);
+  }
+
   static Level level_;
   static Reporter *reporter_;
   static Formatter *formatter_;
   static void SetLevel(const Level level) { level_ = level; }
   static void SetReporter(Reporter *r) { reporter_ = r; }
   static void SetFormatter(Formatter *f) { formatter_ = f; }
+  // Lets each TX_LOG call site through at most `per_second` times a second
+  // on average, in bursts of up to `burst`. Fatal records always get
+  // through. A rate of 0 turns the limit off, which is the default.
+  static void SetRateLimit(double per_second, int burst = 1);
   static bool ShouldLog(const Level level) {
     return level >= level_ || level == Level::Trace;
   }
 };
 }  // namespace TX
+
+#include "TX/LogLimit.h"
+#ifdef BINARY_LOG
+#include "TX/BinaryLog.h"
+#endif  // BINARY_LOG
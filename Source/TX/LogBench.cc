@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "TX/AsyncReporter.h"
+#include "TX/BenchAlloc.h"
+#include "TX/BinaryLog.h"
+#include "TX/Log.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+namespace {
+// Formats and writes every record to /dev/null.
+class NullReporter final : public Logger::Reporter {
+ public:
+  NullReporter() : file_(std::fopen("/dev/null", "w")) {}
+  ~NullReporter() override { std::fclose(file_); }
+  void Report(const Logger::Log &log) override {
+    const std::string_view line = Logger::formatter_->Format(log);
+    std::fwrite(line.data(), 1, line.size(), file_);
+    std::fputc('\n', file_);
+  }
+  void Flush() override { std::fflush(file_); }
+
+ private:
+  FILE *file_;
+};
+}  // namespace
+
+// Measures how long a TX_INFO call takes on the logging thread, with the
+// record formatted and written there or handed to the AsyncReporter, and
+// how many allocations it makes on either thread.
+class LogBench : public testing::Test {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  static constexpr int kCalls = 100000;
+
+  void SetUp() override {
+    reporter_ = Logger::reporter_;
+    level_ = Logger::level_;
+    Logger::SetLevel(Logger::Level::Info);
+  }
+  void TearDown() override {
+    Logger::SetReporter(reporter_);
+    Logger::SetLevel(level_);
+  }
+
+  template <class F>
+  static void run(const char *name, Logger::Reporter &reporter, F log) {
+    Logger::SetReporter(&reporter);
+    std::vector<double> ns(kCalls);
+    const uint64_t mallocs = BenchMallocs();
+    for (int i = 0; i < kCalls; i++) {
+      const Clock::time_point start = Clock::now();
+      log(i);
+      ns[i] = std::chrono::duration<double, std::nano>(Clock::now() - start)
+                  .count();
+    }
+    reporter.Flush();
+    const double mallocs_per_call =
+        static_cast<double>(BenchMallocs() - mallocs) / kCalls;
+    double total = 0;
+    for (const double n : ns) total += n;
+    std::sort(ns.begin(), ns.end());
+    std::printf(
+        "%-14s mean %7.1f ns, p50 %7.1f ns, p99 %8.1f ns, %.2f mallocs\n",
+        name, total / kCalls, ns[kCalls / 2], ns[kCalls * 99 / 100],
+        mallocs_per_call);
+  }
+
+ private:
+  Logger::Reporter *reporter_ = nullptr;
+  Logger::Level level_ = Logger::Level::Info;
+};
+
+TEST_F(LogBench, Latency) {
+  const auto text = [](const int i) {
+    TX_INFO("request %d done in %d ms, %s", i, i % 1000, "ok");
+  };
+  const auto binary = [](const int i) {
+    TX_LOG_BINARY(Info, "TX", "request %d done in %d ms, %s", i, i % 1000,
+                  "ok");
+  };
+  NullReporter sync;
+  run("sync", sync, text);
+  run("sync binary", sync, binary);
+  NullReporter downstream;
+  AsyncReporter async(&downstream,
+                      {.ring_size = 1 << 20,
+                       .overflow = AsyncReporter::Overflow::Block});
+  run("async", async, text);
+  run("async binary", async, binary);
+  EXPECT_EQ(async.GetStats().dropped, 0u);
+}
+}  // namespace TX
@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+
+#include "TX/Bits.h"
+#include "TX/Clock.h"
+#include "TX/Log.h"
+#include "TX/Platform.h"
+#include "TX/Time.h"
+
+namespace TX {
+// The limiters of TX_LOG_LIMITED. Each call site has a static one, so their
+// state is atomics only and they start out zero. Allow returns whether a
+// record gets through and sets `suppressed` to how many did not since the
+// last one that did.
+
+namespace detail {
+inline int64_t monotonicNano() {
+  const Clock::TimePoint now = Clock::Fast();
+  return now.sec * 1000000000 + now.nsec;
+}
+}  // namespace detail
+
+class LogEveryN {
+ public:
+  bool Allow(const uint64 n, uint64 &suppressed) {
+    const uint64 count = count_.fetch_add(1, std::memory_order_relaxed);
+    if (n > 1 && count % n != 0) return false;
+    suppressed = count == 0 || n <= 1 ? 0 : n - 1;
+    return true;
+  }
+
+ private:
+  std::atomic<uint64> count_{0};
+};
+
+class LogFirstN {
+ public:
+  bool Allow(const uint64 n, uint64 &) {
+    // Keeps the counter from being written once it is done.
+    if (count_.load(std::memory_order_relaxed) >= n) return false;
+    return count_.fetch_add(1, std::memory_order_relaxed) < n;
+  }
+
+ private:
+  std::atomic<uint64> count_{0};
+};
+
+class LogEveryDuration {
+ public:
+  bool Allow(const Duration duration, uint64 &suppressed) {
+    const int64_t now = detail::monotonicNano();
+    int64_t next = next_.load(std::memory_order_relaxed);
+    if (now < next ||
+        !next_.compare_exchange_strong(next, now + duration.NanoSeconds(),
+                                       std::memory_order_relaxed)) {
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  std::atomic<int64_t> next_{0};
+  std::atomic<uint64> suppressed_{0};
+};
+
+// The token bucket of every TX_LOG call site, set by Logger::SetRateLimit.
+// It is kept as the time the bucket would be full again (GCRA), so one
+// atomic is enough.
+class LogRateLimit {
+ public:
+  bool Allow(const Logger::Level level, uint64 &suppressed) {
+    const int64_t interval = interval_.load(std::memory_order_relaxed);
+    if (TX_LIKELY(interval == 0) || level == Logger::Level::Fatal) {
+      if (TX_UNLIKELY(suppressed_.load(std::memory_order_relaxed))) {
+        suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+      }
+      return true;
+    }
+    const int64_t limit = interval * burst_.load(std::memory_order_relaxed);
+    const int64_t now = detail::monotonicNano();
+    int64_t full = full_.load(std::memory_order_relaxed);
+    int64_t next;
+    do {
+      next = std::max(full, now) + interval;
+      if (next - now > limit) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    } while (!full_.compare_exchange_weak(full, next,
+                                          std::memory_order_relaxed));
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  friend class Logger;
+
+  // Nanoseconds per token, 0 if there is no limit.
+  static inline std::atomic<int64_t> interval_{0};
+  static inline std::atomic<int64_t> burst_{1};
+
+  std::atomic<int64_t> full_{0};
+  std::atomic<uint64> suppressed_{0};
+};
+}  // namespace TX
@@ -0,0 +1,105 @@
+#include "TX/LogLimit.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TX {
+namespace {
+class Collector final : public Logger::Reporter {
+ public:
+  void Report(const Logger::Log &log) override {
+    total_suppressed += log.suppressed_;
+    // Under BINARY_LOG the count comes as a record of its own.
+    if (log.message_.empty()) return;
+    messages.emplace_back(log.message_);
+    suppressed.push_back(log.suppressed_);
+  }
+
+  std::vector<std::string> messages;
+  std::vector<uint64> suppressed;
+  uint64 total_suppressed = 0;
+};
+}  // namespace
+
+class LogLimitTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    reporter_ = Logger::reporter_;
+    Logger::SetReporter(&collector_);
+    Logger::SetLevel(Logger::Level::Debug);
+  }
+  void TearDown() override {
+    Logger::SetRateLimit(0);
+    Logger::SetReporter(reporter_);
+  }
+
+  Collector collector_;
+
+ private:
+  Logger::Reporter *reporter_ = nullptr;
+};
+
+TEST_F(LogLimitTest, EveryN) {
+  for (int i = 0; i < 7; i++) TX_LOG_EVERY_N(Info, "TX", 3, "%d", i);
+  EXPECT_EQ(collector_.messages, (std::vector<std::string>{"0", "3", "6"}));
+  EXPECT_EQ(collector_.suppressed, (std::vector<uint64>{0, 2, 2}));
+}
+
+TEST_F(LogLimitTest, FirstN) {
+  for (int i = 0; i < 5; i++) TX_LOG_FIRST_N(Info, "TX", 2, "%d", i);
+  EXPECT_EQ(collector_.messages, (std::vector<std::string>{"0", "1"}));
+}
+
+TEST_F(LogLimitTest, EveryDuration) {
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 3; j++) {
+      TX_LOG_EVERY_DURATION(Info, "TX", Duration::MilliSecond(50), "%d", j);
+    }
+    if (i == 0) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(collector_.messages, (std::vector<std::string>{"0", "0"}));
+  EXPECT_EQ(collector_.suppressed, (std::vector<uint64>{0, 2}));
+}
+
+TEST_F(LogLimitTest, DisabledLevelIsNotCounted) {
+  Logger::SetLevel(Logger::Level::Info);
+  for (int i = 0; i < 2; i++) {
+    TX_LOG_EVERY_N(Debug, "TX", 2, "debug");
+    TX_LOG_EVERY_N(Info, "TX", 2, "info");
+  }
+  EXPECT_EQ(collector_.messages, (std::vector<std::string>{"info"}));
+}
+
+TEST_F(LogLimitTest, RateLimit) {
+  // One call site.
+  const auto info = [](const int i) { TX_INFO("%d", i); };
+  Logger::SetRateLimit(1, 2);
+  for (int i = 0; i < 5; i++) info(i);
+  EXPECT_EQ(collector_.messages, (std::vector<std::string>{"0", "1"}));
+  Logger::SetRateLimit(0);
+  info(5);
+  EXPECT_EQ(collector_.messages.size(), 3u);
+  EXPECT_EQ(collector_.total_suppressed, 3u);
+}
+
+TEST_F(LogLimitTest, RateLimitRefills) {
+  Logger::SetRateLimit(20);
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 3; j++) TX_INFO("%d", j);
+    if (i == 0) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(collector_.messages, (std::vector<std::string>{"0", "0"}));
+  EXPECT_EQ(collector_.total_suppressed, 2u);
+}
+
+TEST_F(LogLimitTest, FormatSuppressed) {
+  const Logger::Log log(Logger::Level::Info, "file.cc", 1, "function", "TX",
+                        "message", Logger::Now(), 3);
+  Logger::Formatter formatter;
+  EXPECT_TRUE(formatter.Format(log).ends_with("message (suppressed 3)"));
+}
+}  // namespace TX
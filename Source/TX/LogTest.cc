@@ -15,13 +15,32 @@ TEST(LogTest, Simple) {
 }
 
 TEST(LogTest, Reporter) {
-  const auto r = new MockReporter;
-  Logger::SetReportCallback(r);
+  MockReporter r;
+  Logger::Reporter *const reporter = Logger::reporter_;
+  const Logger::Level level = Logger::level_;
+  Logger::SetReporter(&r);
   Logger::SetLevel(Logger::Level::Error);
   TX_DEBUG("debug");
   TX_INFO("info");
   TX_WARN("warn");
   TX_ERROR("error");
-  EXPECT_EQ(r->n, 1);
+  Logger::SetReporter(reporter);
+  Logger::SetLevel(level);
+  EXPECT_EQ(r.n, 1);
+}
+
+TEST(LogTest, Basename) {
+  static_assert(std::string_view(Logger::Basename("a/b/c.cc")) == "c.cc");
+  static_assert(std::string_view(Logger::Basename("c.cc")) == "c.cc");
+  EXPECT_STREQ(Logger::Basename(__FILE__), "LogTest.cc");
+}
+
+TEST(LogTest, Format) {
+  const Logger::Log log(Logger::Level::Warn, "file.cc", 42, "function", "TX",
+                        "message");
+  Logger::Formatter formatter;
+  const std::string_view line = formatter.Format(log);
+  EXPECT_TRUE(line.starts_with("[W]["));
+  EXPECT_TRUE(line.ends_with("][TX][file.cc:42][function] message"));
 }
 }  // namespace TX
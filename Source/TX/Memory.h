@@ -1,4 +1,6 @@
 #pragma once
+#include <utility>
+
 namespace TX {
 #define TX_DISALLOW_COPY(T) \
   T(const T &) = delete;    \
@@ -11,8 +13,12 @@ namespace TX {
 #define TX_COPY(t) (t)
 #define TX_MOVE(t) (std::move(t))
 
+// Releases what `t` holds right away, e.g. unlocks a guard before the end of
+// its scope. `t` is moved from rather than destroyed, so that its destructor
+// at the end of the scope has nothing left to do: calling the destructor
+// twice is undefined, and GCC does drop the stores made by the first call.
 template <typename T>
 void drop(T &t) {
-  t.~T();
+  T dropped(std::move(t));
 }
 }  // namespace TX
@@ -0,0 +1,252 @@
+#include "TX/Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+
+#include "TX/Assert.h"
+#include "TX/Mutex.h"
+#include "TX/Own.h"
+
+namespace TX {
+namespace {
+constexpr size_t kPageSize = 1024;
+constexpr size_t kMaxPages = 256;
+}  // namespace
+
+// The slots of one thread, in pages allocated on first use. Only that thread
+// writes them, any thread reads them.
+class Metrics::Shard {
+ public:
+  Shard() = default;
+  ~Shard() {
+    for (auto &page : pages_) delete[] page.load(std::memory_order_relaxed);
+  }
+  TX_DISALLOW_COPY(Shard)
+
+  // Owner thread only.
+  std::atomic<uint64> &Slot(const uint32 slot) {
+    std::atomic<uint64> *page =
+        pages_[slot / kPageSize].load(std::memory_order_relaxed);
+    if (TX_UNLIKELY(!page)) {
+      page = new std::atomic<uint64>[kPageSize]();
+      pages_[slot / kPageSize].store(page, std::memory_order_release);
+    }
+    return page[slot % kPageSize];
+  }
+
+  TX_NODISCARD uint64 Load(const uint32 slot) const {
+    const std::atomic<uint64> *page =
+        pages_[slot / kPageSize].load(std::memory_order_acquire);
+    return page ? page[slot % kPageSize].load(std::memory_order_relaxed) : 0;
+  }
+
+  template <class F>
+  void ForEach(F f) const {
+    for (size_t i = 0; i < kMaxPages; i++) {
+      const std::atomic<uint64> *page =
+          pages_[i].load(std::memory_order_acquire);
+      if (!page) continue;
+      for (size_t j = 0; j < kPageSize; j++) {
+        const uint64 value = page[j].load(std::memory_order_relaxed);
+        if (value) f(static_cast<uint32>(i * kPageSize + j), value);
+      }
+    }
+  }
+
+ private:
+  std::atomic<std::atomic<uint64> *> pages_[kMaxPages]{};
+};
+
+namespace {
+enum class Kind { Counter, Gauge, Histogram };
+
+struct Registry {
+  struct Metric {
+    Kind kind;
+    void *metric;
+  };
+  std::map<std::string, Metric, std::less<>> metrics;
+  uint32 next_slot = 0;
+  std::vector<Metrics::Shard *> shards;
+  // The slots of exited threads.
+  std::vector<uint64> retired;
+
+  uint32 Allocate(const size_t slots) {
+    TX_ASSERT(next_slot + slots <= kPageSize * kMaxPages,
+              "too many metrics");
+    const uint32 slot = next_slot;
+    next_slot += static_cast<uint32>(slots);
+    return slot;
+  }
+
+  TX_NODISCARD uint64 Sum(const uint32 slot) const {
+    uint64 sum = slot < retired.size() ? retired[slot] : 0;
+    for (const Metrics::Shard *shard : shards) sum += shard->Load(slot);
+    return sum;
+  }
+
+  void Retire(const uint32 slot, const uint64 n) {
+    if (retired.size() <= slot) retired.resize(slot + 1);
+    retired[slot] += n;
+  }
+
+  // Returns the metric named `name`, made by `make` on first use.
+  template <class T, class F>
+  T &Get(const std::string_view name, const Kind kind, F make) {
+    auto it = metrics.find(name);
+    if (it == metrics.end()) {
+      it = metrics.emplace(std::string(name), Metric{kind, make()}).first;
+    }
+    TX_ASSERT(it->second.kind == kind, "metric registered as another kind");
+    return *static_cast<T *>(it->second.metric);
+  }
+};
+
+// Never destroyed, threads may exit after static destructors ran.
+Mutex<Registry> &registry() {
+  static auto *registry = new Mutex<Registry>();
+  return *registry;
+}
+
+Metrics::HistogramSnapshot histogramSnapshot(const Registry &registry,
+                                             const uint32 slot) {
+  Metrics::HistogramSnapshot snapshot;
+  for (uint32 i = 0; i < Metrics::kBuckets; i++) {
+    const uint64 count = registry.Sum(slot + i);
+    if (!count) continue;
+    snapshot.count += count;
+    snapshot.buckets.emplace_back(i, count);
+  }
+  snapshot.sum = registry.Sum(slot + Metrics::kBuckets);
+  return snapshot;
+}
+
+struct LocalShard {
+  Metrics::Shard *shard = nullptr;
+  ~LocalShard();
+};
+
+thread_local LocalShard localShard;
+// Set once the thread's LocalShard is gone, later thread_local destructors
+// add to the registry directly.
+thread_local bool localShardExited = false;
+
+LocalShard::~LocalShard() {
+  localShardExited = true;
+  if (!shard) return;
+  auto registry = TX::registry().Lock();
+  // Under the lock, so that Collect sees the values either in the shard or
+  // in the registry.
+  shard->ForEach([&](const uint32 slot, const uint64 value) {
+    registry->Retire(slot, value);
+  });
+  std::erase(registry->shards, shard);
+  delete shard;
+}
+}  // namespace
+
+void Metrics::add(const uint32 slot, const uint64 n) {
+  Shard *shard = localShard.shard;
+  if (TX_UNLIKELY(!shard)) {
+    if (localShardExited) {
+      registry().Lock()->Retire(slot, n);
+      return;
+    }
+    shard = new Shard;
+    registry().Lock()->shards.push_back(shard);
+    localShard.shard = shard;
+  }
+  std::atomic<uint64> &value = shard->Slot(slot);
+  value.store(value.load(std::memory_order_relaxed) + n,
+              std::memory_order_relaxed);
+}
+
+uint64 Metrics::sum(const uint32 slot) { return registry().Lock()->Sum(slot); }
+
+uint64 Metrics::Counter::Value() const { return Metrics::sum(slot_); }
+
+Metrics::HistogramSnapshot Metrics::Histogram::Snapshot() const {
+  auto registry = TX::registry().Lock();
+  return histogramSnapshot(*registry, slot_);
+}
+
+uint64 Metrics::HistogramSnapshot::Quantile(const double q) const {
+  if (!count) return 0;
+  const auto rank = std::clamp<uint64>(
+      static_cast<uint64>(std::ceil(q * static_cast<double>(count))), 1,
+      count);
+  uint64 seen = 0;
+  for (const auto &[bucket, n] : buckets) {
+    seen += n;
+    if (seen >= rank) return BucketUpperBound(bucket);
+  }
+  return Max();
+}
+
+Metrics::Counter &Metrics::GetCounter(const std::string_view name) {
+  auto registry = TX::registry().Lock();
+  return registry->Get<Counter>(name, Kind::Counter, [&]() {
+    return new Counter(registry->Allocate(1));
+  });
+}
+
+Metrics::Gauge &Metrics::GetGauge(const std::string_view name) {
+  auto registry = TX::registry().Lock();
+  return registry->Get<Gauge>(name, Kind::Gauge, []() { return new Gauge; });
+}
+
+Metrics::Histogram &Metrics::GetHistogram(const std::string_view name) {
+  auto registry = TX::registry().Lock();
+  return registry->Get<Histogram>(name, Kind::Histogram, [&]() {
+    return new Histogram(registry->Allocate(kBuckets + 1));
+  });
+}
+
+Metrics::Snapshot Metrics::Collect() {
+  Snapshot snapshot;
+  auto registry = TX::registry().Lock();
+  for (const auto &[name, metric] : registry->metrics) {
+    switch (metric.kind) {
+      case Kind::Counter:
+        snapshot.counters.emplace_back(
+            name,
+            registry->Sum(static_cast<const Counter *>(metric.metric)->slot_));
+        break;
+      case Kind::Gauge:
+        snapshot.gauges.emplace_back(
+            name, static_cast<const Gauge *>(metric.metric)->Value());
+        break;
+      case Kind::Histogram:
+        snapshot.histograms.emplace_back(
+            name,
+            histogramSnapshot(
+                *registry,
+                static_cast<const Histogram *>(metric.metric)->slot_));
+        break;
+    }
+  }
+  return snapshot;
+}
+
+std::string Metrics::Format() {
+  const Snapshot snapshot = Collect();
+  std::string out;
+  for (const auto &[name, value] : snapshot.counters) {
+    out += name + " " + std::to_string(value) + "\n";
+  }
+  for (const auto &[name, value] : snapshot.gauges) {
+    out += name + " " + std::to_string(value) + "\n";
+  }
+  for (const auto &[name, histogram] : snapshot.histograms) {
+    out += name + " count=" + std::to_string(histogram.count) +
+           " sum=" + std::to_string(histogram.sum) +
+           " p50=" + std::to_string(histogram.Quantile(0.5)) +
+           " p90=" + std::to_string(histogram.Quantile(0.9)) +
+           " p99=" + std::to_string(histogram.Quantile(0.99)) +
+           " max=" + std::to_string(histogram.Max()) + "\n";
+  }
+  return out;
+}
+}  // namespace TX
@@ -0,0 +1,151 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "TX/Bits.h"
+#include "TX/Memory.h"
+#include "TX/Platform.h"
+
+namespace TX {
+// A process-wide registry of named counters, gauges and histograms.
+//
+// Counters and histograms are sharded per thread: each thread adds to its own
+// slots with a relaxed load and store, as WorkerMetrics does, so recording
+// never contends on a cache line. Collect aggregates the shards on read, a
+// snapshot may be slightly stale but each counter is monotonic. A thread's
+// shard is folded into the registry when the thread exits.
+//
+// Metrics are registered once per name and live as long as the process, the
+// macros at the bottom register them on first use:
+//
+//   TX_METRICS_COUNTER(gBytesReceived, "http.bytes_received");
+//   ...
+//   gBytesReceived.Add(size);
+class Metrics {
+ public:
+  // Values below kSubBuckets get a bucket each, then every power of two is
+  // split into kSubBuckets buckets, so a bucket is at most 1/kSubBuckets
+  // wider than its lower bound.
+  static constexpr int kSubBucketBits = 4;
+  static constexpr uint64 kSubBuckets = uint64(1) << kSubBucketBits;
+  static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  class Counter {
+   public:
+    TX_DISALLOW_COPY(Counter)
+    void Add(const uint64 n = 1) const { Metrics::add(slot_, n); }
+    TX_NODISCARD uint64 Value() const;
+
+   private:
+    friend class Metrics;
+    explicit Counter(const uint32 slot) : slot_(slot) {}
+    const uint32 slot_;
+  };
+
+  // A gauge is set as a whole, so it is a single atomic rather than shards.
+  class Gauge {
+   public:
+    TX_DISALLOW_COPY(Gauge)
+    void Set(const int64_t value) {
+      value_.store(value, std::memory_order_relaxed);
+    }
+    void Add(const int64_t n = 1) {
+      value_.fetch_add(n, std::memory_order_relaxed);
+    }
+    void Sub(const int64_t n = 1) { Add(-n); }
+    TX_NODISCARD int64_t Value() const {
+      return value_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    friend class Metrics;
+    Gauge() = default;
+    std::atomic<int64_t> value_{0};
+  };
+
+  struct HistogramSnapshot {
+    uint64 count = 0;
+    uint64 sum = 0;
+    // Non-empty buckets as (index, count), by index.
+    std::vector<std::pair<uint32, uint64>> buckets;
+
+    // The upper bound of the bucket that holds the `q` quantile, 0 <= q <= 1,
+    // or 0 if empty.
+    TX_NODISCARD uint64 Quantile(double q) const;
+    TX_NODISCARD uint64 Max() const {
+      return buckets.empty() ? 0 : BucketUpperBound(buckets.back().first);
+    }
+  };
+
+  class Histogram {
+   public:
+    TX_DISALLOW_COPY(Histogram)
+    void Record(const uint64 value) const {
+      Metrics::add(slot_ + BucketOf(value), 1);
+      Metrics::add(slot_ + kBuckets, value);
+    }
+    TX_NODISCARD HistogramSnapshot Snapshot() const;
+
+   private:
+    friend class Metrics;
+    explicit Histogram(const uint32 slot) : slot_(slot) {}
+    // kBuckets counts, then the sum.
+    const uint32 slot_;
+  };
+
+  struct Snapshot {
+    std::vector<std::pair<std::string, uint64>> counters;
+    std::vector<std::pair<std::string, int64_t>> gauges;
+    std::vector<std::pair<std::string, HistogramSnapshot>> histograms;
+  };
+
+  // Return the metric named `name`, registering it on first use. A name
+  // names one kind of metric only.
+  static Counter &GetCounter(std::string_view name);
+  static Gauge &GetGauge(std::string_view name);
+  static Histogram &GetHistogram(std::string_view name);
+
+  // All metrics, by name.
+  static Snapshot Collect();
+  // Collect as text, a line per metric:
+  //
+  //   http.bytes_received 1048576
+  //   http.response_time_us count=12 sum=3400 p50=255 p90=319 p99=447 max=447
+  static std::string Format();
+
+  static constexpr size_t BucketOf(const uint64 value) {
+    if (value < kSubBuckets) return static_cast<size_t>(value);
+    const int exp = 63 - std::countl_zero(value);
+    const uint64 sub = (value >> (exp - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>((exp - kSubBucketBits + 1) * kSubBuckets + sub);
+  }
+  static constexpr uint64 BucketLowerBound(const size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    const int exp = static_cast<int>(bucket / kSubBuckets) + kSubBucketBits - 1;
+    return (kSubBuckets + bucket % kSubBuckets) << (exp - kSubBucketBits);
+  }
+  static constexpr uint64 BucketUpperBound(const size_t bucket) {
+    return bucket + 1 < kBuckets ? BucketLowerBound(bucket + 1) - 1
+                                 : UINT64_MAX;
+  }
+
+  class Shard;
+
+ private:
+  static void add(uint32 slot, uint64 n);
+  static uint64 sum(uint32 slot);
+};
+}  // namespace TX
+
+// Define a reference `var` to the metric `name`, at namespace or function
+// scope. Either way it is registered once, on first use in the latter case.
+#define TX_METRICS_COUNTER(var, name) \
+  static TX::Metrics::Counter &var = TX::Metrics::GetCounter(name)
+#define TX_METRICS_GAUGE(var, name) \
+  static TX::Metrics::Gauge &var = TX::Metrics::GetGauge(name)
+#define TX_METRICS_HISTOGRAM(var, name) \
+  static TX::Metrics::Histogram &var = TX::Metrics::GetHistogram(name)
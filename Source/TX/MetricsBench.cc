@@ -0,0 +1,51 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "TX/Metrics.h"
+#include "TX/Own.h"
+#include "TX/Thread.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+// Compares adding to a Metrics::Counter, sharded per thread, with a
+// fetch_add on one shared atomic, from 1 to 4 threads at once.
+class MetricsBench : public testing::Test {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  static constexpr int kAdds = 10000000;
+
+  template <class F>
+  static double run(const int threads, F add) {
+    const Clock::time_point start = Clock::now();
+    {
+      std::vector<Own<Thread>> workers;
+      for (int i = 0; i < threads; i++) {
+        workers.push_back(Thread::Spawn(
+            [&]() {
+              for (int j = 0; j < kAdds; j++) add();
+            },
+            "MetricsBench"));
+      }
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start)
+               .count() /
+           kAdds;
+  }
+};
+
+TEST_F(MetricsBench, Counter) {
+  Metrics::Counter &counter = Metrics::GetCounter("MetricsBench.Counter");
+  std::atomic<uint64> shared{0};
+  for (int threads = 1; threads <= 4; threads *= 2) {
+    const double sharded_ns = run(threads, [&]() { counter.Add(); });
+    const double shared_ns = run(threads, [&]() {
+      shared.fetch_add(1, std::memory_order_relaxed);
+    });
+    std::printf("%d threads: Counter::Add %5.2f ns, fetch_add %5.2f ns\n",
+                threads, sharded_ns, shared_ns);
+  }
+  EXPECT_EQ(counter.Value(), shared.load());
+}
+}  // namespace TX
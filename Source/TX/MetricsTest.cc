@@ -0,0 +1,117 @@
+#include "TX/Metrics.h"
+
+#include <string>
+#include <vector>
+
+#include "TX/Own.h"
+#include "TX/Thread.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+TX_METRICS_COUNTER(gStaticCounter, "MetricsTest.Static");
+
+TEST(MetricsTest, Counter) {
+  Metrics::Counter &counter = Metrics::GetCounter("MetricsTest.Counter");
+  EXPECT_EQ(&Metrics::GetCounter("MetricsTest.Counter"), &counter);
+  const uint64 before = counter.Value();
+  counter.Add();
+  counter.Add(41);
+  EXPECT_EQ(counter.Value(), before + 42);
+}
+
+TEST(MetricsTest, StaticRegistration) {
+  gStaticCounter.Add(3);
+  EXPECT_EQ(Metrics::GetCounter("MetricsTest.Static").Value(), 3u);
+  for (int i = 0; i < 2; i++) {
+    TX_METRICS_COUNTER(counter, "MetricsTest.Static");
+    counter.Add();
+  }
+  EXPECT_EQ(gStaticCounter.Value(), 5u);
+}
+
+TEST(MetricsTest, Gauge) {
+  Metrics::Gauge &gauge = Metrics::GetGauge("MetricsTest.Gauge");
+  gauge.Set(10);
+  gauge.Add(5);
+  gauge.Sub(20);
+  EXPECT_EQ(gauge.Value(), -5);
+}
+
+TEST(MetricsTest, Buckets) {
+  for (uint64 v = 0; v < Metrics::kSubBuckets; v++) {
+    EXPECT_EQ(Metrics::BucketOf(v), v);
+  }
+  EXPECT_EQ(Metrics::BucketOf(UINT64_MAX), Metrics::kBuckets - 1);
+  EXPECT_EQ(Metrics::BucketUpperBound(Metrics::kBuckets - 1), UINT64_MAX);
+  for (size_t b = 0; b + 1 < Metrics::kBuckets; b++) {
+    EXPECT_EQ(Metrics::BucketOf(Metrics::BucketLowerBound(b)), b);
+    EXPECT_EQ(Metrics::BucketOf(Metrics::BucketUpperBound(b)), b);
+    EXPECT_EQ(Metrics::BucketUpperBound(b) + 1,
+              Metrics::BucketLowerBound(b + 1));
+  }
+  // At most 1/kSubBuckets wide.
+  EXPECT_EQ(Metrics::BucketLowerBound(Metrics::BucketOf(1000)), 992u);
+  EXPECT_EQ(Metrics::BucketUpperBound(Metrics::BucketOf(1000)), 1023u);
+}
+
+TEST(MetricsTest, Histogram) {
+  Metrics::Histogram &histogram =
+      Metrics::GetHistogram("MetricsTest.Histogram");
+  for (uint64 v = 1; v <= 100; v++) histogram.Record(v);
+  const Metrics::HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.count, 100u);
+  EXPECT_EQ(snapshot.sum, 5050u);
+  EXPECT_EQ(snapshot.Quantile(0), 1u);
+  EXPECT_EQ(snapshot.Quantile(0.5), 51u);
+  EXPECT_EQ(snapshot.Quantile(0.99), 99u);
+  EXPECT_EQ(snapshot.Max(), 103u);
+  EXPECT_EQ(Metrics::HistogramSnapshot().Quantile(0.5), 0u);
+}
+
+TEST(MetricsTest, Threads) {
+  constexpr int kThreads = 4;
+  constexpr int kAdds = 10000;
+  Metrics::Counter &counter = Metrics::GetCounter("MetricsTest.Threads");
+  {
+    std::vector<Own<Thread>> threads;
+    for (int i = 0; i < kThreads; i++) {
+      threads.push_back(Thread::Spawn(
+          [&]() {
+            for (int j = 0; j < kAdds; j++) counter.Add();
+          },
+          "MetricsTest"));
+    }
+  }
+  // The shards of the exited threads are folded into the registry.
+  EXPECT_EQ(counter.Value(), static_cast<uint64>(kThreads * kAdds));
+}
+
+TEST(MetricsTest, Collect) {
+  Metrics::GetCounter("MetricsTest.Collect.Counter").Add(7);
+  Metrics::GetGauge("MetricsTest.Collect.Gauge").Set(-3);
+  Metrics::GetHistogram("MetricsTest.Collect.Histogram").Record(8);
+  const Metrics::Snapshot snapshot = Metrics::Collect();
+  const auto find = [](const auto &metrics, const std::string &name) {
+    for (const auto &metric : metrics) {
+      if (metric.first == name) return &metric.second;
+    }
+    return static_cast<decltype(&metrics.front().second)>(nullptr);
+  };
+  ASSERT_TRUE(find(snapshot.counters, "MetricsTest.Collect.Counter"));
+  EXPECT_EQ(*find(snapshot.counters, "MetricsTest.Collect.Counter"), 7u);
+  ASSERT_TRUE(find(snapshot.gauges, "MetricsTest.Collect.Gauge"));
+  EXPECT_EQ(*find(snapshot.gauges, "MetricsTest.Collect.Gauge"), -3);
+  ASSERT_TRUE(find(snapshot.histograms, "MetricsTest.Collect.Histogram"));
+  EXPECT_EQ(find(snapshot.histograms, "MetricsTest.Collect.Histogram")->count,
+            1u);
+
+  const std::string text = Metrics::Format();
+  EXPECT_NE(text.find("MetricsTest.Collect.Counter 7\n"), std::string::npos)
+      << text;
+  EXPECT_NE(text.find("MetricsTest.Collect.Gauge -3\n"), std::string::npos)
+      << text;
+  EXPECT_NE(text.find("MetricsTest.Collect.Histogram count=1 sum=8 p50=8"),
+            std::string::npos)
+      << text;
+}
+}  // namespace TX
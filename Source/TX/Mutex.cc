@@ -0,0 +1,37 @@
+#include "TX/Mutex.h"
+
+namespace TX {
+uint32 RawMutex::spin() {
+  // Spin while the lock is held by someone who is likely to release it soon.
+  // Stop early if it gets released or somebody else is already sleeping on
+  // it, in which case we would only steal CPU time from the owner.
+  for (int i = 0; i < kSpinLimit; i++) {
+    const uint32 state = state_.load(std::memory_order_relaxed);
+    if (state != kLocked) return state;
+    TX_CPU_RELAX();
+  }
+  return state_.load(std::memory_order_relaxed);
+}
+
+void RawMutex::lockContended() {
+  uint32 state = spin();
+  if (state == kUnlocked) {
+    if (state_.compare_exchange_strong(state, kLocked,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+      return;
+    }
+  }
+  while (true) {
+    // We can't tell whether other waiters are sleeping, so once we have had
+    // to wait we always leave the lock marked as contended. The cost is a
+    // spurious wake-up on unlock at worst.
+    if (state != kContended &&
+        state_.exchange(kContended, std::memory_order_acquire) == kUnlocked) {
+      return;
+    }
+    Futex::Wait(state_, kContended);
+    state = spin();
+  }
+}
+}  // namespace TX
@@ -1,6 +1,13 @@
 #pragma once
+#include <atomic>
+#include <source_location>
+#include <utility>
+
 #include "TX/Assert.h"
+#include "TX/Bits.h"
+#include "TX/Futex.h"
 #include "TX/Memory.h"
+#include "TX/MutexProfiler.h"
 #include "TX/Option.h"
 #ifdef _WIN32
 #include <windows.h>
@@ -9,26 +16,51 @@
 #endif
 
 namespace TX {
-template <typename T>
-class MutexGuard;
-template <typename T>
-class Mutex {
+// A 4-byte non-recursive lock on top of Futex. Uncontended Lock and Unlock are
+// a single atomic instruction each. A contended Lock spins for a bounded time
+// while the owner looks like it is about to release, and goes to sleep right
+// away once there are sleeping waiters, since spinning is pointless then.
+class RawMutex {
  public:
-  explicit Mutex() {
-#ifdef _WIN32
-    InitializeCriticalSection(&cs);
-#else
-    pthread_mutexattr_t attr;
-    TX_ASSERT_SYSCALL(pthread_mutexattr_init(&attr));
-    TX_ASSERT_SYSCALL(
-        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE));
-    TX_ASSERT_SYSCALL(pthread_mutex_init(&inner_, &attr));
-    TX_ASSERT_SYSCALL(pthread_mutexattr_destroy(&attr));
-#endif
+  static constexpr int kSpinLimit = 100;
+
+  explicit RawMutex() : state_(kUnlocked) {}
+  TX_DISALLOW_COPY(RawMutex)
+
+  void Lock() {
+    if (!TryLock()) lockContended();
   }
-  Mutex(T &&t) : t_(t) {
+  bool TryLock() {
+    uint32 expected = kUnlocked;
+    return state_.compare_exchange_strong(expected, kLocked,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+  }
+  void Unlock() {
+    if (state_.exchange(kUnlocked, std::memory_order_release) == kContended) {
+      Futex::WakeOne(state_);
+    }
+  }
+
+ private:
+  static constexpr uint32 kUnlocked = 0;
+  static constexpr uint32 kLocked = 1;
+  // Locked, and there may be waiters sleeping on the futex.
+  static constexpr uint32 kContended = 2;
+
+  void lockContended();
+  uint32 spin();
+
+  std::atomic<uint32> state_;
+};
+
+// A recursive lock, for the rare code that really needs to relock a mutex it
+// already holds. Prefer RawMutex: recursion hides lock ordering bugs.
+class RawRecursiveMutex {
+ public:
+  explicit RawRecursiveMutex() {
 #ifdef _WIN32
-    InitializeCriticalSection(&cs);
+    InitializeCriticalSection(&cs_);
 #else
     pthread_mutexattr_t attr;
     TX_ASSERT_SYSCALL(pthread_mutexattr_init(&attr));
@@ -38,69 +70,114 @@ class Mutex {
     TX_ASSERT_SYSCALL(pthread_mutexattr_destroy(&attr));
 #endif
   }
-  ~Mutex() {
+  ~RawRecursiveMutex() {
 #ifdef _WIN32
-    DeleteCriticalSection(&cs);
+    DeleteCriticalSection(&cs_);
 #else
     TX_ASSERT_SYSCALL(pthread_mutex_destroy(&inner_));
 #endif
   }
+  TX_DISALLOW_COPY(RawRecursiveMutex)
 
-  MutexGuard<T> Lock() {
+  void Lock() {
 #ifdef _WIN32
-    EnterCriticalSection(&cs);
+    EnterCriticalSection(&cs_);
 #else
     TX_ASSERT_SYSCALL(pthread_mutex_lock(&inner_));
 #endif
-    return MutexGuard<T>(this);
   }
-
-  Option<MutexGuard<T>> TryLock() {
-    bool locked = false;
+  bool TryLock() {
 #ifdef _WIN32
-    locked = TryEnterCriticalSection(&cs);
+    return TryEnterCriticalSection(&cs_);
 #else
-    int rc = pthread_mutex_trylock(&inner_);
-    if (rc == 0)
-      locked = true;
-    else if (rc == EBUSY)
-      locked = false;
-    else
-      TX_FATAL("pthread_mutex_trylock: EINVAL");
+    const int rc = pthread_mutex_trylock(&inner_);
+    if (rc == 0) return true;
+    if (rc != EBUSY) TX_FATAL("pthread_mutex_trylock: EINVAL");
+    return false;
 #endif
-    return locked ? TX::Some(MutexGuard<T>(this)) : TX::None;
   }
-
- private:
   void Unlock() {
 #ifdef _WIN32
-    LeaveCriticalSection(&cs);
+    LeaveCriticalSection(&cs_);
 #else
     TX_ASSERT_SYSCALL(pthread_mutex_unlock(&inner_));
 #endif
   }
 
  private:
-  friend MutexGuard<T>;
-  friend class Condvar;
-  T t_;
 #ifdef _WIN32
-  CRITICAL_SECTION cs;
+  CRITICAL_SECTION cs_;
 #else
   pthread_mutex_t inner_{};
 #endif
 };
 
+template <typename T, typename Raw = RawMutex>
+class MutexGuard;
+
+// Owns a T that can only be reached through the guard returned by Lock.
+// Not recursive: locking it again from the thread holding it deadlocks. Use
+// RecursiveMutex where relocking is intended.
+//
+// The caller's location is only used by MutexProfiler.
+template <typename T, typename Raw = RawMutex>
+class Mutex {
+ public:
+  explicit Mutex() : t_() {}
+  Mutex(T &&t) : t_(std::move(t)) {}
+  TX_DISALLOW_COPY(Mutex)
+
+  MutexGuard<T, Raw> Lock(const std::source_location &location =
+                              std::source_location::current()) {
+    if (TX_LIKELY(!MutexProfiler::IsEnabled())) {
+      raw_.Lock();
+      return MutexGuard<T, Raw>(this);
+    }
+    const int64 start = MutexProfiler::Now();
+    const bool contended = !raw_.TryLock();
+    if (contended) raw_.Lock();
+    const int64 now = MutexProfiler::Now();
+    return MutexGuard<T, Raw>(
+        this, MutexProfiler::Acquired(location, now - start, contended), now);
+  }
+
+  Option<MutexGuard<T, Raw>> TryLock(const std::source_location &location =
+                                         std::source_location::current()) {
+    if (!raw_.TryLock()) return None;
+    if (TX_LIKELY(!MutexProfiler::IsEnabled())) {
+      return MutexGuard<T, Raw>(this);
+    }
+    return MutexGuard<T, Raw>(this, MutexProfiler::Acquired(location, 0, false),
+                              MutexProfiler::Now());
+  }
+
+ private:
+  void Unlock() { raw_.Unlock(); }
+
+ private:
+  friend MutexGuard<T, Raw>;
+  friend class Condvar;
+  T t_;
+  Raw raw_;
+};
+
 template <typename T>
+using RecursiveMutex = Mutex<T, RawRecursiveMutex>;
+
+template <typename T, typename Raw>
 class MutexGuard {
  public:
   TX_DISALLOW_COPY(MutexGuard)
   MutexGuard(MutexGuard &&other) noexcept {
     lock_ = other.lock_;
+    slot_ = other.slot_;
+    acquired_ns_ = other.acquired_ns_;
     other.lock_ = nullptr;
   }
   MutexGuard &operator=(MutexGuard &&other) noexcept {
     lock_ = other.lock_;
+    slot_ = other.slot_;
+    acquired_ns_ = other.acquired_ns_;
     other.lock_ = nullptr;
     return *this;
   };
@@ -108,6 +185,7 @@ class MutexGuard {
     if (lock_) {
       // A NULL lock_ means that this MutexGuard has been moved to another
       // MutexGuard, in which case we must avoid a double-unlock on lock_.
+      released();
       lock_->Unlock();
       lock_ = nullptr;
     }
@@ -116,11 +194,25 @@ class MutexGuard {
   T *operator->() { return &lock_->t_; }
 
  private:
-  explicit MutexGuard(Mutex<T> *lock) : lock_(lock) {}
+  explicit MutexGuard(Mutex<T, Raw> *lock, MutexProfiler::Slot *slot = nullptr,
+                      const int64 acquired_ns = 0)
+      : lock_(lock), slot_(slot), acquired_ns_(acquired_ns) {}
+
+  void released() const {
+    if (slot_) {
+      MutexProfiler::Released(slot_, MutexProfiler::Now() - acquired_ns_);
+    }
+  }
+  void reacquired() {
+    if (slot_) acquired_ns_ = MutexProfiler::Now();
+  }
 
-  friend class Mutex<T>;
+  friend class Mutex<T, Raw>;
   friend class Condvar;
-  Mutex<T> *lock_;
+  Mutex<T, Raw> *lock_;
+  // Set when the lock was taken with MutexProfiler enabled.
+  MutexProfiler::Slot *slot_;
+  int64 acquired_ns_;
 };
 
 }  // namespace TX
@@ -0,0 +1,70 @@
+#include <pthread.h>
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "TX/Mutex.h"
+#include "TX/Own.h"
+#include "TX/Thread.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+// Threads increment a shared counter under each lock kind. Reports the
+// average time per lock/unlock pair, all threads together.
+class MutexBench : public testing::TestWithParam<int> {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  static constexpr int kIterations = 1000000;
+
+  template <class Lock, class Unlock>
+  static void run(const char *name, Lock lock, Unlock unlock) {
+    const int n_threads = GetParam();
+    const int per_thread = kIterations / n_threads;
+    uint64 counter = 0;
+    const Clock::time_point start = Clock::now();
+    {
+      std::vector<Own<Thread>> threads;
+      for (int i = 0; i < n_threads; i++) {
+        threads.push_back(Thread::Spawn([&] {
+          for (int j = 0; j < per_thread; j++) {
+            lock();
+            counter++;
+            unlock();
+          }
+        }));
+      }
+    }
+    const double ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    EXPECT_EQ(counter, static_cast<uint64>(per_thread) * n_threads);
+    std::printf("%-20s threads %2d: %7.1f ns/op\n", name, n_threads,
+                ns / (per_thread * n_threads));
+  }
+};
+
+TEST_P(MutexBench, RawMutex) {
+  RawMutex mutex;
+  run("TX::RawMutex", [&] { mutex.Lock(); }, [&] { mutex.Unlock(); });
+}
+
+TEST_P(MutexBench, RawRecursiveMutex) {
+  RawRecursiveMutex mutex;
+  run("TX::RawRecursive", [&] { mutex.Lock(); }, [&] { mutex.Unlock(); });
+}
+
+TEST_P(MutexBench, StdMutex) {
+  std::mutex mutex;
+  run("std::mutex", [&] { mutex.lock(); }, [&] { mutex.unlock(); });
+}
+
+TEST_P(MutexBench, PthreadMutex) {
+  pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  run("pthread_mutex_t", [&] { pthread_mutex_lock(&mutex); },
+      [&] { pthread_mutex_unlock(&mutex); });
+  pthread_mutex_destroy(&mutex);
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, MutexBench, testing::Values(1, 2, 4, 8));
+}  // namespace TX
@@ -0,0 +1,150 @@
+#include "TX/MutexProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "TX/Log.h"
+
+namespace TX {
+#if defined(ENABLE_MUTEX_PROFILER)
+std::atomic<bool> MutexProfiler::enabled_ = true;
+#else
+std::atomic<bool> MutexProfiler::enabled_ = false;
+#endif
+
+// An entry of a fixed open-addressing table keyed by call site. Sites claim
+// an entry with a CAS on `key` and are never removed, so recording is
+// lock-free and never allocates, which matters since the logger itself
+// takes a Mutex.
+struct MutexProfiler::Slot {
+  std::atomic<uint64> key{0};
+  // Written once by the thread that claimed the slot, before `ready`.
+  const char *file = nullptr;
+  const char *function = nullptr;
+  uint32 line = 0;
+  std::atomic<bool> ready{false};
+
+  std::atomic<uint64> acquisitions{0};
+  std::atomic<uint64> contentions{0};
+  std::atomic<uint64> wait_ns{0};
+  std::atomic<uint64> max_wait_ns{0};
+  std::atomic<uint64> hold_ns{0};
+  std::atomic<uint64> max_hold_ns{0};
+};
+
+static constexpr size_t kSlots = 1024;
+static MutexProfiler::Slot gSlots[kSlots];
+
+static uint64 siteKey(const std::source_location &location) {
+  // File names are string literals, so the pointer identifies the file.
+  uint64 h = reinterpret_cast<uintptr_t>(location.file_name());
+  h ^= (static_cast<uint64>(location.line()) << 32 | location.column()) +
+       0x9e3779b97f4a7c15 + (h << 6) + (h >> 2);
+  h *= 0xff51afd7ed558ccd;
+  h ^= h >> 33;
+  // Zero marks a free slot.
+  return h ? h : 1;
+}
+
+static MutexProfiler::Slot *findSlot(const std::source_location &location) {
+  const uint64 key = siteKey(location);
+  for (size_t i = 0; i < kSlots; i++) {
+    MutexProfiler::Slot &slot = gSlots[(key + i) % kSlots];
+    uint64 current = slot.key.load(std::memory_order_acquire);
+    if (current == key) return &slot;
+    if (current == 0) {
+      if (slot.key.compare_exchange_strong(current, key,
+                                           std::memory_order_acq_rel)) {
+        slot.file = location.file_name();
+        slot.function = location.function_name();
+        slot.line = location.line();
+        slot.ready.store(true, std::memory_order_release);
+        return &slot;
+      }
+      // Somebody else claimed it, maybe for the same site.
+      if (current == key) return &slot;
+    }
+  }
+  return nullptr;
+}
+
+static void updateMax(std::atomic<uint64> &max, const uint64 n) {
+  uint64 current = max.load(std::memory_order_relaxed);
+  while (n > current &&
+         !max.compare_exchange_weak(current, n, std::memory_order_relaxed)) {
+  }
+}
+
+int64 MutexProfiler::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+MutexProfiler::Slot *MutexProfiler::Acquired(
+    const std::source_location &location, const int64 wait_ns,
+    const bool contended) {
+  Slot *slot = findSlot(location);
+  if (!slot) return nullptr;
+  slot->acquisitions.fetch_add(1, std::memory_order_relaxed);
+  if (contended) {
+    slot->contentions.fetch_add(1, std::memory_order_relaxed);
+    slot->wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+    updateMax(slot->max_wait_ns, wait_ns);
+  }
+  return slot;
+}
+
+void MutexProfiler::Released(Slot *slot, const int64 hold_ns) {
+  slot->hold_ns.fetch_add(hold_ns, std::memory_order_relaxed);
+  updateMax(slot->max_hold_ns, hold_ns);
+}
+
+void MutexProfiler::Reset() {
+  for (Slot &slot : gSlots) {
+    slot.acquisitions.store(0, std::memory_order_relaxed);
+    slot.contentions.store(0, std::memory_order_relaxed);
+    slot.wait_ns.store(0, std::memory_order_relaxed);
+    slot.max_wait_ns.store(0, std::memory_order_relaxed);
+    slot.hold_ns.store(0, std::memory_order_relaxed);
+    slot.max_hold_ns.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::vector<MutexProfiler::Site> MutexProfiler::Top(const size_t n) {
+  std::vector<Site> sites;
+  for (const Slot &slot : gSlots) {
+    if (!slot.ready.load(std::memory_order_acquire)) continue;
+    const uint64 acquisitions =
+        slot.acquisitions.load(std::memory_order_relaxed);
+    if (acquisitions == 0) continue;
+    sites.push_back({slot.file, slot.function, slot.line, acquisitions,
+                     slot.contentions.load(std::memory_order_relaxed),
+                     slot.wait_ns.load(std::memory_order_relaxed),
+                     slot.max_wait_ns.load(std::memory_order_relaxed),
+                     slot.hold_ns.load(std::memory_order_relaxed),
+                     slot.max_hold_ns.load(std::memory_order_relaxed)});
+  }
+  const size_t top = std::min(n, sites.size());
+  std::partial_sort(sites.begin(), sites.begin() + top, sites.end(),
+                    [](const Site &a, const Site &b) {
+                      return a.wait_ns > b.wait_ns;
+                    });
+  sites.resize(top);
+  return sites;
+}
+
+void MutexProfiler::Dump(const size_t n) {
+  for (const Site &site : Top(n)) {
+    TX_INFO("mutex %s:%u (%s): acquired %llu, contended %llu, "
+            "wait %llu ns (max %llu), hold %llu ns (max %llu)",
+            site.file, site.line, site.function,
+            static_cast<unsigned long long>(site.acquisitions),
+            static_cast<unsigned long long>(site.contentions),
+            static_cast<unsigned long long>(site.wait_ns),
+            static_cast<unsigned long long>(site.max_wait_ns),
+            static_cast<unsigned long long>(site.hold_ns),
+            static_cast<unsigned long long>(site.max_hold_ns));
+  }
+}
+}  // namespace TX
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <source_location>
+#include <vector>
+
+#include "TX/Bits.h"
+
+namespace TX {
+// Contention profiling for Mutex. While enabled, every Lock records, per call
+// site, how often it acquired the lock, how often it had to wait, for how
+// long, and how long the lock was then held. Disabled, it costs Lock one
+// relaxed load.
+//
+// It starts disabled unless built with ENABLE_MUTEX_PROFILER
+// (TK_ENABLE_MUTEX_PROFILER in CMake), and can be switched at any time.
+class MutexProfiler {
+ public:
+  // Counters of one call site, as returned by Top.
+  struct Site {
+    const char *file;
+    const char *function;
+    uint32 line;
+    uint64 acquisitions;
+    uint64 contentions;
+    uint64 wait_ns;
+    uint64 max_wait_ns;
+    uint64 hold_ns;
+    uint64 max_hold_ns;
+  };
+
+  // Where a guard records its hold time, opaque outside MutexProfiler.cc.
+  struct Slot;
+
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+  static void Enable() { enabled_.store(true, std::memory_order_relaxed); }
+  static void Disable() { enabled_.store(false, std::memory_order_relaxed); }
+  // Zeroes the counters of every site seen so far.
+  static void Reset();
+
+  // The `n` sites that waited longest in total, longest first.
+  static std::vector<Site> Top(size_t n);
+  // Logs Top(n) at Info level.
+  static void Dump(size_t n = 10);
+
+  static int64 Now();
+  // Returns the slot of `location`, or nullptr once the site table is full.
+  static Slot *Acquired(const std::source_location &location, int64 wait_ns,
+                        bool contended);
+  static void Released(Slot *slot, int64 hold_ns);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+}  // namespace TX
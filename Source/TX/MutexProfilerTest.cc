@@ -0,0 +1,89 @@
+#include "TX/MutexProfiler.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+
+#include "TX/Condvar.h"
+#include "TX/Event.h"
+#include "TX/Mutex.h"
+#include "TX/Own.h"
+#include "TX/Thread.h"
+
+namespace TX {
+struct MutexProfilerTest : testing::Test {
+  void SetUp() override {
+    MutexProfiler::Reset();
+    MutexProfiler::Enable();
+  }
+  void TearDown() override { MutexProfiler::Disable(); }
+
+  static Option<MutexProfiler::Site> find(const uint32 line) {
+    for (const MutexProfiler::Site &site : MutexProfiler::Top(1024)) {
+      if (site.line == line && std::strstr(site.file, "MutexProfilerTest")) {
+        return site;
+      }
+    }
+    return None;
+  }
+};
+
+TEST_F(MutexProfilerTest, Uncontended) {
+  Mutex<int> n(0);
+  const uint32 line = __LINE__ + 2;
+  for (int i = 0; i < 3; i++) {
+    auto guard = n.Lock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const auto site = find(line);
+  ASSERT_TRUE(site.has_value());
+  EXPECT_EQ(site->acquisitions, 3u);
+  EXPECT_EQ(site->contentions, 0u);
+  EXPECT_EQ(site->wait_ns, 0u);
+  EXPECT_GE(site->hold_ns, 3000000u);
+  EXPECT_GE(site->max_hold_ns, 1000000u);
+}
+
+TEST_F(MutexProfilerTest, Contended) {
+  Mutex<int> n(0);
+  Event locked;
+  uint32 line = 0;
+  {
+    auto holder = Thread::Spawn([&]() {
+      auto guard = n.Lock();
+      locked.Set();
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+    locked.Wait();
+    line = __LINE__ + 1;
+    auto guard = n.Lock();
+  }
+  const auto site = find(line);
+  ASSERT_TRUE(site.has_value());
+  EXPECT_EQ(site->acquisitions, 1u);
+  EXPECT_EQ(site->contentions, 1u);
+  EXPECT_GE(site->wait_ns, 1000000u);
+  EXPECT_EQ(site->wait_ns, site->max_wait_ns);
+}
+
+TEST_F(MutexProfilerTest, CondvarWaitIsNotHold) {
+  Mutex<bool> ready(false);
+  Condvar cv;
+  const uint32 line = __LINE__ + 1;
+  auto guard = ready.Lock();
+  cv.Wait(guard, Duration::MilliSecond(20));
+  drop(guard);
+  const auto site = find(line);
+  ASSERT_TRUE(site.has_value());
+  EXPECT_LT(site->hold_ns, 10000000u);
+}
+
+TEST_F(MutexProfilerTest, Disabled) {
+  MutexProfiler::Disable();
+  Mutex<int> n(0);
+  const uint32 line = __LINE__ + 1;
+  *n.Lock() = 1;
+  EXPECT_FALSE(find(line).has_value());
+}
+}  // namespace TX
@@ -0,0 +1,62 @@
+#include "TX/Mutex.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "TX/Condvar.h"
+#include "TX/Own.h"
+#include "TX/Thread.h"
+
+namespace TX {
+TEST(MutexTest, Size) { EXPECT_EQ(sizeof(RawMutex), 4); }
+
+TEST(MutexTest, TryLock) {
+  Mutex<int> n(0);
+  {
+    auto guard = n.Lock();
+    EXPECT_FALSE(n.TryLock().has_value());
+  }
+  auto guard = n.TryLock();
+  ASSERT_TRUE(guard.has_value());
+  **guard = 42;
+  guard.reset();
+  EXPECT_EQ(*n.Lock(), 42);
+}
+
+TEST(MutexTest, Contended) {
+  constexpr int m = 4, N = 100000;
+  Mutex<int> n(0);
+  {
+    std::vector<Own<Thread>> threads;
+    for (int i = 0; i < m; i++) {
+      threads.push_back(Thread::Spawn([&]() {
+        for (int j = 0; j < N; j++) (*n.Lock())++;
+      }));
+    }
+  }
+  EXPECT_EQ(*n.Lock(), m * N);
+}
+
+TEST(MutexTest, Recursive) {
+  RecursiveMutex<int> n(0);
+  auto outer = n.Lock();
+  {
+    auto inner = n.Lock();
+    (*inner)++;
+    EXPECT_TRUE(n.TryLock().has_value());
+  }
+  EXPECT_EQ(*outer, 1);
+}
+
+TEST(MutexTest, CondvarTimeout) {
+  Mutex<int> n(0);
+  Condvar cv;
+  auto guard = n.Lock();
+  const Time start = Time::Now();
+  EXPECT_TRUE(cv.Wait(guard, Duration::MilliSecond(20)));
+  EXPECT_GE(Time::Since(start).MilliSeconds(), 15);
+  // The lock is held again after waiting.
+  EXPECT_FALSE(n.TryLock().has_value());
+}
+}  // namespace TX
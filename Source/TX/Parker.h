@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+
+#include "TX/Bits.h"
+#include "TX/Futex.h"
+#include "TX/Memory.h"
+#include "TX/Ref.h"
+#include "TX/Time.h"
+
+namespace TX {
+class Unparker;
+
+// A thread parking token. Park blocks the calling thread until the token is
+// made available by Unpark, consuming it; an Unpark that comes first makes
+// the next Park return at once. Tokens don't accumulate. Unpark can be called
+// from any thread through an Unparker, while only the owning thread parks.
+class Parker {
+ public:
+  explicit Parker() : inner_(adoptRef(*new Inner)) {}
+  TX_DISALLOW_COPY(Parker)
+
+  void Park() {
+    // EMPTY -> PARKED or NOTIFIED -> EMPTY.
+    if (state().fetch_sub(1, std::memory_order_acquire) == kNotified) {
+      return;
+    }
+    while (true) {
+      Futex::Wait(state(), kParked);
+      if (consume()) return;
+      // A spurious wake-up, keep waiting.
+    }
+  }
+
+  // Returns false if the timeout expired before we were unparked.
+  bool ParkTimeout(const Duration timeout) {
+    if (state().fetch_sub(1, std::memory_order_acquire) == kNotified) {
+      return true;
+    }
+    const Time deadline = Time::After(timeout);
+    while (true) {
+      const Duration left = Time::Until(deadline);
+      if (left > 0) Futex::Wait(state(), kParked, left);
+      if (consume()) return true;
+      if (Time::Until(deadline) <= 0) {
+        // Unpark may still race with us giving up.
+        return state().exchange(kEmpty, std::memory_order_acquire) == kNotified;
+      }
+    }
+  }
+
+  void Unpark() const { unpark(inner_.get()); }
+  TX_NODISCARD Unparker GetUnparker() const;
+
+ private:
+  friend Unparker;
+  static constexpr uint32 kEmpty = 0;
+  static constexpr uint32 kNotified = 1;
+  static constexpr uint32 kParked = UINT32_MAX;
+
+  // Shared with the Unparkers, which may outlive us.
+  struct Inner final : AtomicRefCounted<Inner> {
+    std::atomic<uint32> state{kEmpty};
+  };
+
+  std::atomic<uint32> &state() const { return inner_.get().state; }
+
+  bool consume() const {
+    uint32 expected = kNotified;
+    return state().compare_exchange_strong(expected, kEmpty,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed);
+  }
+
+  static void unpark(Inner &inner) {
+    if (inner.state.exchange(kNotified, std::memory_order_release) ==
+        kParked) {
+      Futex::WakeOne(inner.state);
+    }
+  }
+
+  Ref<Inner> inner_;
+};
+
+// Unparks a Parker from any thread, it can be freely copied around.
+class Unparker {
+ public:
+  void Unpark() const { Parker::unpark(inner_.get()); }
+
+ private:
+  friend Parker;
+  explicit Unparker(const Ref<Parker::Inner> &inner) : inner_(inner) {}
+  Ref<Parker::Inner> inner_;
+};
+
+inline Unparker Parker::GetUnparker() const { return Unparker(inner_); }
+}  // namespace TX
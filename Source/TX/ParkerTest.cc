@@ -0,0 +1,44 @@
+#include "TX/Parker.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "TX/Thread.h"
+
+namespace TX {
+TEST(ParkerTest, UnparkFirst) {
+  Parker parker;
+  parker.Unpark();
+  parker.Unpark();
+  // Tokens don't accumulate.
+  parker.Park();
+  EXPECT_FALSE(parker.ParkTimeout(Duration::MilliSecond(10)));
+}
+
+TEST(ParkerTest, CrossThread) {
+  Parker parker;
+  std::atomic<int> n = 0;
+  {
+    Thread t([&, unparker = parker.GetUnparker()] {
+      for (int i = 0; i < 100; i++) {
+        n++;
+        unparker.Unpark();
+      }
+    });
+    while (n.load() < 100) parker.Park();
+  }
+  EXPECT_EQ(n.load(), 100);
+}
+
+TEST(ParkerTest, Timeout) {
+  Parker parker;
+  const Time start = Time::Now();
+  EXPECT_FALSE(parker.ParkTimeout(Duration::MilliSecond(20)));
+  EXPECT_GE(Time::Since(start).MilliSeconds(), 15);
+  {
+    Thread t([unparker = parker.GetUnparker()] { unparker.Unpark(); });
+    EXPECT_TRUE(parker.ParkTimeout(Duration::Second(10)));
+  }
+}
+}  // namespace TX
@@ -173,6 +173,18 @@ namespace TX {
 #define TX_NO_UNROLL
 #endif
 
+// Hints the CPU that we are in a spin-wait loop.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define TX_CPU_RELAX() __builtin_ia32_pause()
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define TX_CPU_RELAX() __asm__ __volatile__("yield")
+#elif defined(_MSC_VER)
+#define TX_CPU_RELAX() YieldProcessor()
+#else
+#define TX_CPU_RELAX() ((void)0)
+#endif
+
 #if __GNUC__ || __clang__
 #define TX_SILENCE_DANGLING_ELSE_BEGIN \
   _Pragma("GCC diagnostic push")       \
@@ -0,0 +1,128 @@
+#include "TX/Pool.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "TX/Assert.h"
+#include "TX/Platform.h"
+
+namespace TX {
+namespace {
+struct Node {
+  Node *next;
+};
+
+size_t roundUp(const size_t n, const size_t align) {
+  return (n + align - 1) / align * align;
+}
+
+std::atomic<size_t> nextPoolId = 0;
+}  // namespace
+
+struct alignas(TX_CACHE_LINE_SIZE) SlabPool::Cache {
+  // Owner thread only.
+  Node *free = nullptr;
+  // Pushed to by other threads, taken as a whole by the owner.
+  alignas(TX_CACHE_LINE_SIZE) std::atomic<Node *> remote{nullptr};
+};
+
+namespace {
+// The caches of the current thread, indexed by pool id. Hands them back to
+// their pools when the thread exits.
+struct LocalCaches {
+  struct Entry {
+    SlabPool::Cache *cache;
+    Mutex<std::vector<SlabPool::Cache *>> *abandoned;
+  };
+  std::vector<Entry> entries;
+
+  ~LocalCaches() {
+    for (const Entry &entry : entries) {
+      if (entry.cache) entry.abandoned->Lock()->push_back(entry.cache);
+    }
+    // Frees from later thread_local destructors then count as remote.
+    entries.clear();
+    entries.shrink_to_fit();
+  }
+};
+thread_local LocalCaches localCaches;
+}  // namespace
+
+SlabPool::SlabPool(const size_t size, const size_t align)
+    : id_(nextPoolId.fetch_add(1, std::memory_order_relaxed)),
+      offset_(roundUp(sizeof(Cache *), align)),
+      slot_size_(roundUp(offset_ + std::max(size, sizeof(Node)),
+                         std::max(align, alignof(Cache *)))),
+      align_(std::max(align, alignof(Cache *))),
+      slabs_(0),
+      remote_frees_(0) {}
+
+SlabPool::Cache &SlabPool::local() {
+  auto &entries = localCaches.entries;
+  if (TX_LIKELY(id_ < entries.size() && entries[id_].cache)) {
+    return *entries[id_].cache;
+  }
+  if (entries.size() <= id_) entries.resize(id_ + 1, {nullptr, nullptr});
+  Cache *cache = nullptr;
+  {
+    auto abandoned = abandoned_.Lock();
+    if (!abandoned->empty()) {
+      cache = abandoned->back();
+      abandoned->pop_back();
+    }
+  }
+  if (!cache) cache = new Cache;
+  entries[id_] = {cache, &abandoned_};
+  return *cache;
+}
+
+void SlabPool::refill(Cache &cache) {
+  auto *slab = static_cast<char *>(::operator new(
+      slot_size_ * kSlabSlots, std::align_val_t(align_)));
+  slabs_.fetch_add(1, std::memory_order_relaxed);
+  for (size_t i = kSlabSlots; i-- > 0;) {
+    char *slot = slab + i * slot_size_;
+    *reinterpret_cast<Cache **>(slot) = &cache;
+    auto *node = reinterpret_cast<Node *>(slot + offset_);
+    node->next = cache.free;
+    cache.free = node;
+  }
+}
+
+void *SlabPool::Allocate() {
+  Cache &cache = local();
+  if (TX_UNLIKELY(!cache.free)) {
+    cache.free = cache.remote.exchange(nullptr, std::memory_order_acquire);
+    if (!cache.free) refill(cache);
+  }
+  Node *node = cache.free;
+  cache.free = node->next;
+  return node;
+}
+
+void SlabPool::Free(void *p) {
+  if (!p) return;
+  Cache *owner =
+      *reinterpret_cast<Cache **>(static_cast<char *>(p) - offset_);
+  auto *node = static_cast<Node *>(p);
+  if (id_ < localCaches.entries.size() &&
+      localCaches.entries[id_].cache == owner) {
+    node->next = owner->free;
+    owner->free = node;
+    return;
+  }
+  remote_frees_.fetch_add(1, std::memory_order_relaxed);
+  // Only the owner ever pops, and it takes the whole list, so there is no
+  // ABA problem here.
+  node->next = owner->remote.load(std::memory_order_relaxed);
+  while (!owner->remote.compare_exchange_weak(node->next, node,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+  }
+}
+
+SlabPool::Stats SlabPool::GetStats() const {
+  return {slabs_.load(std::memory_order_relaxed),
+          remote_frees_.load(std::memory_order_relaxed)};
+}
+}  // namespace TX
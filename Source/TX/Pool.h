@@ -0,0 +1,128 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "TX/Bits.h"
+#include "TX/Memory.h"
+#include "TX/Mutex.h"
+
+namespace TX {
+// A thread-caching pool of fixed-size slots. Each thread allocates from and
+// frees to its own cache without atomics; memory comes from the system 64
+// slots at a time and is kept for reuse, never returned.
+//
+// Every slot remembers the cache it came from. A slot freed by another thread
+// is pushed onto a lock-free list of its owner, which takes the whole list
+// back in one exchange once its own slots run out. A cache outlives its
+// thread: it is handed to the next thread that needs one, together with the
+// slots still out.
+//
+// Threads keep pointers into the pool until they exit, so a pool must never
+// be destroyed. Pool<T> below is the usual way to get one.
+class SlabPool {
+ public:
+  struct Stats {
+    // Slabs taken from the system, each one malloc call.
+    uint64 slabs;
+    // Frees from a thread other than the allocating one.
+    uint64 remote_frees;
+  };
+
+  explicit SlabPool(size_t size, size_t align);
+  ~SlabPool() = delete;
+  TX_DISALLOW_COPY(SlabPool)
+
+  TX_NODISCARD void *Allocate();
+  void Free(void *p);
+  TX_NODISCARD Stats GetStats() const;
+
+  struct Cache;
+
+ private:
+  static constexpr size_t kSlabSlots = 64;
+
+  Cache &local();
+  void refill(Cache &cache);
+
+  const size_t id_;
+  // Offset of the object in a slot, after the pointer to the owner cache.
+  const size_t offset_;
+  const size_t slot_size_;
+  const size_t align_;
+  // Caches of exited threads, waiting for a new owner.
+  Mutex<std::vector<Cache *>> abandoned_;
+
+  std::atomic<uint64> slabs_;
+  std::atomic<uint64> remote_frees_;
+};
+
+// The pool of T, created on first use and leaked on purpose.
+template <typename T>
+class Pool {
+ public:
+  static SlabPool &Get() {
+    static auto *pool = new SlabPool(sizeof(T), alignof(T));
+    return *pool;
+  }
+};
+
+// The pool of slots of `Size` bytes, shared by every type in that size class.
+template <size_t Size>
+class SizeClassPool {
+ public:
+  static SlabPool &Get() {
+    static auto *pool = new SlabPool(Size, alignof(std::max_align_t));
+    return *pool;
+  }
+};
+
+// sizeof(T) rounded up to a power of two, at least 64 bytes.
+template <typename T>
+inline constexpr size_t kPoolSizeClass =
+    std::bit_ceil(std::max(sizeof(T), size_t{64}));
+// Larger objects, and over-aligned ones, come from the global heap.
+inline constexpr size_t kMaxPoolSizeClass = 1024;
+
+// Gives T class-specific operator new and delete backed by Pool<T>, so that
+// `adoptRef(*new T(...))` allocates from the pool and the last deref returns
+// the object to it. Subclasses of a different size that are not Pooled
+// themselves fall back to the global heap.
+template <typename T>
+class Pooled {
+ public:
+  static void *operator new(const size_t size) {
+    if (size != sizeof(T)) return ::operator new(size);
+    return Pool<T>::Get().Allocate();
+  }
+  static void operator delete(void *p, const size_t size) {
+    if (size != sizeof(T)) return ::operator delete(p);
+    Pool<T>::Get().Free(p);
+  }
+};
+
+// Like Pooled, but from the pool of T's size class rather than one of its
+// own. For class templates instantiated with many types, such as closures,
+// which would otherwise each keep slabs of their own forever.
+template <typename T>
+class SizeClassPooled {
+ public:
+  static void *operator new(const size_t size) {
+    if (!fits(size)) return ::operator new(size);
+    return SizeClassPool<kPoolSizeClass<T>>::Get().Allocate();
+  }
+  static void operator delete(void *p, const size_t size) {
+    if (!fits(size)) return ::operator delete(p);
+    SizeClassPool<kPoolSizeClass<T>>::Get().Free(p);
+  }
+
+ private:
+  static constexpr bool fits(const size_t size) {
+    return size == sizeof(T) && kPoolSizeClass<T> <= kMaxPoolSizeClass &&
+           alignof(T) <= alignof(std::max_align_t);
+  }
+};
+}  // namespace TX
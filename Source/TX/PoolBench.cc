@@ -0,0 +1,94 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "TX/BenchAlloc.h"
+#include "TX/Mutex.h"
+#include "TX/Pool.h"
+#include "TX/Ref.h"
+#include "TX/Thread.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+namespace {
+// About the size of a BlockingTask with a small capture.
+struct PlainTask final : AtomicRefCounted<PlainTask> {
+  char payload[64] = {};
+};
+struct PooledTask final : AtomicRefCounted<PooledTask>, Pooled<PooledTask> {
+  char payload[64] = {};
+};
+}  // namespace
+
+// Creates tasks in batches and drops them, on one thread or handing them to
+// another thread to drop. Reports malloc calls and time per task.
+class PoolBench : public testing::Test {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  static constexpr int kTasks = 1000000;
+  static constexpr int kBatch = 100;
+
+  template <class T>
+  static void churn(const char *name) {
+    const uint64_t mallocs = BenchMallocs();
+    const Clock::time_point start = Clock::now();
+    std::vector<Ref<T>> batch;
+    batch.reserve(kBatch);
+    for (int i = 0; i < kTasks / kBatch; i++) {
+      for (int j = 0; j < kBatch; j++) batch.push_back(adoptRef(*new T));
+      batch.clear();
+    }
+    report(name, mallocs, start);
+  }
+
+  template <class T>
+  static void crossThread(const char *name) {
+    const uint64_t mallocs = BenchMallocs();
+    const Clock::time_point start = Clock::now();
+    Mutex<std::vector<T *>> queue;
+    std::atomic<bool> done = false;
+    {
+      Thread consumer([&]() {
+        std::vector<T *> batch;
+        while (true) {
+          const bool last = done.load();
+          std::swap(batch, *queue.Lock());
+          for (T *t : batch) t->deref();
+          batch.clear();
+          if (last) break;
+        }
+      });
+      std::vector<T *> batch;
+      for (int i = 0; i < kTasks / kBatch; i++) {
+        for (int j = 0; j < kBatch; j++) batch.push_back(&adoptRef(*new T).leakRef());
+        auto guard = queue.Lock();
+        guard->insert(guard->end(), batch.begin(), batch.end());
+        drop(guard);
+        batch.clear();
+      }
+      done = true;
+    }
+    report(name, mallocs, start);
+  }
+
+  static void report(const char *name, const uint64_t mallocs,
+                     const Clock::time_point start) {
+    const double ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    std::printf("%-28s mallocs %8llu, %6.1f ns/task\n", name,
+                static_cast<unsigned long long>(BenchMallocs() - mallocs),
+                ns / kTasks);
+  }
+};
+
+TEST_F(PoolBench, Churn) {
+  churn<PlainTask>("new/delete");
+  churn<PooledTask>("Pooled");
+}
+
+TEST_F(PoolBench, CrossThread) {
+  crossThread<PlainTask>("new/delete, cross-thread");
+  crossThread<PooledTask>("Pooled, cross-thread");
+}
+}  // namespace TX
@@ -0,0 +1,106 @@
+#include "TX/Pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "TX/Ref.h"
+#include "TX/Thread.h"
+
+namespace TX {
+namespace {
+struct Item final : AtomicRefCounted<Item>, Pooled<Item> {
+  static inline std::atomic<int> live = 0;
+  explicit Item(const int v) : value(v) { live++; }
+  ~Item() override { live--; }
+  int value;
+  char payload[40] = {};
+};
+
+struct alignas(64) Aligned : Pooled<Aligned> {
+  char c;
+};
+
+template <size_t N>
+struct Sized : SizeClassPooled<Sized<N>> {
+  char c[N];
+};
+}  // namespace
+
+TEST(PoolTest, ReuseOnSameThread) {
+  auto &pool = *new SlabPool(24, 8);
+  void *p = pool.Allocate();
+  pool.Free(p);
+  EXPECT_EQ(pool.Allocate(), p);
+  EXPECT_EQ(pool.GetStats().slabs, 1u);
+}
+
+TEST(PoolTest, RemoteFreeGoesBackToOwner) {
+  auto &pool = *new SlabPool(24, 8);
+  std::vector<void *> ps;
+  // Drains the first slab, so the next Allocate has to look at the frees
+  // coming back from the other thread.
+  for (int i = 0; i < 64; i++) ps.push_back(pool.Allocate());
+  {
+    Thread t([&]() {
+      for (void *p : ps) pool.Free(p);
+    });
+  }
+  EXPECT_EQ(pool.GetStats().remote_frees, 64u);
+  for (int i = 0; i < 64; i++) EXPECT_NE(pool.Allocate(), nullptr);
+  EXPECT_EQ(pool.GetStats().slabs, 1u);
+}
+
+TEST(PoolTest, CacheOutlivesThread) {
+  auto &pool = *new SlabPool(24, 8);
+  void *p = nullptr;
+  {
+    Thread t([&]() { p = pool.Allocate(); });
+  }
+  pool.Free(p);
+  {
+    // The exited thread's cache is adopted, with the slot freed meanwhile.
+    Thread t([&]() {
+      for (int i = 0; i < 64; i++) EXPECT_NE(pool.Allocate(), nullptr);
+    });
+  }
+  EXPECT_EQ(pool.GetStats().slabs, 1u);
+}
+
+TEST(PoolTest, Alignment) {
+  std::vector<Aligned *> as;
+  for (int i = 0; i < 100; i++) {
+    as.push_back(new Aligned);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(as.back()) % 64, 0u);
+  }
+  for (Aligned *a : as) delete a;
+}
+
+TEST(PoolTest, RefCounted) {
+  const uint64 slabs = Pool<Item>::Get().GetStats().slabs;
+  {
+    std::vector<Ref<Item>> items;
+    for (int i = 0; i < 1000; i++) items.push_back(adoptRef(*new Item(i)));
+    EXPECT_EQ(Item::live.load(), 1000);
+  }
+  EXPECT_EQ(Item::live.load(), 0);
+  // Churn after that is served by the freed slots.
+  for (int i = 0; i < 1000; i++) {
+    auto item = adoptRef(*new Item(i));
+    EXPECT_EQ(item->value, i);
+  }
+  EXPECT_LE(Pool<Item>::Get().GetStats().slabs, slabs + 1000 / 64 + 1);
+}
+
+TEST(PoolTest, SizeClass) {
+  static_assert(kPoolSizeClass<Sized<1>> == 64);
+  static_assert(kPoolSizeClass<Sized<65>> == 128);
+  // Types of one size class share its pool.
+  auto *a = new Sized<40>;
+  delete a;
+  auto *b = new Sized<50>;
+  EXPECT_EQ(static_cast<void *>(b), static_cast<void *>(a));
+  delete b;
+}
+}  // namespace TX
@@ -120,12 +120,16 @@ class Ref final {
   T *t_;
 };
 
+// Passed to take over a reference the caller already holds.
+struct AdoptTag {};
+
 // Unlike TX::Ref<T>, T can be type of std::nullptr_t.
 template <class T>
 class RefPtr {
  public:
   RefPtr() : t_(nullptr) {}
   RefPtr(T *t) : t_(ref(t)) {}            /* NOLINT(*-explicit-constructor) */
+  RefPtr(T *t, AdoptTag) : t_(t) {}
   RefPtr(std::nullptr_t) : t_(nullptr) {} /* NOLINT(*-explicit-constructor) */
   RefPtr(const RefPtr &other) : t_(ref(other.get())) {}
   RefPtr(RefPtr &&other) noexcept : t_(other.leakRef()) {}
@@ -0,0 +1,56 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "TX/Ref.h"
+#include "TX/WeakRef.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+namespace {
+struct Virtual final : AtomicRefCounted<Virtual> {
+  int value = 0;
+};
+struct Packed final : WeakRefCounted<Packed> {
+  int value = 0;
+};
+}  // namespace
+
+// Compares AtomicRefCounted with WeakRefCounted: object size, copying a Ref
+// (ref and deref) and creating and dropping an object.
+class RefBench : public testing::Test {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  static constexpr int kCopies = 10000000;
+  static constexpr int kObjects = 1000000;
+
+  template <class T>
+  static void run(const char *name) {
+    Ref t = adoptRef(*new T);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < kCopies; i++) {
+      Ref copy = t;
+      copy->value++;
+    }
+    const double copy_ns = since(start) / kCopies;
+
+    start = Clock::now();
+    std::vector<RefPtr<T>> objects(100);
+    for (int i = 0; i < kObjects; i++) objects[i % 100] = adoptRef(new T);
+    const double churn_ns = since(start) / kObjects;
+
+    std::printf("%-16s size %2zu, ref+deref %5.2f ns, new+drop %6.1f ns\n",
+                name, sizeof(T), copy_ns, churn_ns);
+  }
+
+  static double since(const Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start)
+        .count();
+  }
+};
+
+TEST_F(RefBench, RefDeref) {
+  run<Virtual>("AtomicRefCounted");
+  run<Packed>("WeakRefCounted");
+}
+}  // namespace TX
@@ -2,8 +2,10 @@
 
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "TX/Mutex.h"
+#include "TX/RwLock.h"
 #include "TX/Trace.h"
 
 namespace TX {
@@ -13,14 +15,22 @@ struct RunLoopGlobalContext {
   void Clear() { run_loop_map_.clear(); }
 };
 
-static Mutex<RunLoopGlobalContext> runLoopGlobalContext;
+static RwLock<RunLoopGlobalContext> runLoopGlobalContext;
 
-Own<Thread> RunLoop::SpawnThread(const String &name) {
-  return Thread::Spawn([] { Current()->Run(); }, name);
+Own<Thread> RunLoop::SpawnThread(const String &name,
+                                 const Thread::Options &options) {
+  return Thread::Spawn([] { Current()->Run(); }, name, options);
 }
 
 Ref<RunLoop> RunLoop::FromThread(const Thread::Id &id) {
-  auto global_context = runLoopGlobalContext.Lock();
+  {
+    const auto global_context = runLoopGlobalContext.Read();
+    if (const auto it = global_context->run_loop_map_.find(id);
+        it != global_context->run_loop_map_.end())
+      return it->second;
+  }
+  // Someone may have created it since we looked.
+  auto global_context = runLoopGlobalContext.Write();
   if (const auto it = global_context->run_loop_map_.find(id);
       it != global_context->run_loop_map_.end())
     return it->second;
@@ -57,7 +67,9 @@ RunLoop::Status RunLoop::Run(const uint64_t repeat, const Duration timeout,
   const RefPtr<Scope> previous_scope = guard->current_scope_;
   guard->current_scope_ = scope;
   drop(guard);
+  depth_++;
   const Status status = Schedule(scope, timeout, repeat);
+  depth_--;
   guard = shared_.Lock();
   guard->current_scope_ = previous_scope;
   return status;
@@ -78,9 +90,11 @@ RunLoop::Status RunLoop::Schedule(RefPtr<Scope> &scope,
 
   do {
     if (IsStopped()) return Status::Stopped;
-    TX_TRACE_START(std::to_string(tick_));
+    TX_TRACE_SPAN("RunLoop::Iteration");
+    if (depth_ == 1) iteration_arena_.Reset();
 
-    Time start = Time::Now();
+    now_ = Time::FastNow();
+    const Time start = now_;
     Duration scope_timeout = scope->Timeout(start);
     if (scope_timeout <= 0) {
       DoObservers(scope, Activity::BeforeTimers);
@@ -91,7 +105,7 @@ RunLoop::Status RunLoop::Schedule(RefPtr<Scope> &scope,
     DoObservers(scope, Activity::BeforeSources);
     DoSources(scope);
 
-    Duration loop_timeout = scope_timeout - Time::Since(start);
+    Duration loop_timeout = scope_timeout - (Time::FastNow() - start);
     if (loop_timeout <= 0) {
       DoObservers(scope, Activity::BeforeTimers);
       DoTimers(scope);
@@ -100,6 +114,7 @@ RunLoop::Status RunLoop::Schedule(RefPtr<Scope> &scope,
 
     DoObservers(scope, Activity::BeforeWaiting);
     timeout = Wait(std::min(loop_timeout, period_));
+    now_ = Time::FastNow();
     DoObservers(scope, Activity::AfterWaiting);
 
     if (timeout && loop_timeout <= period_) {
@@ -110,13 +125,9 @@ RunLoop::Status RunLoop::Schedule(RefPtr<Scope> &scope,
     DoObservers(scope, Activity::BeforeBlocks);
     DoBlocks(scope);
 
-    elapse_total += Time::Since(start);
-    if (elapse_total >= max_timeout) {
-      TX_TRACE_END;
-      return Status::Timeout;
-    }
+    elapse_total += Time::FastNow() - start;
+    if (elapse_total >= max_timeout) return Status::Timeout;
     tick_++;
-    TX_TRACE_END;
   } while (repeat--);
   return Status::Finished;
 }
@@ -134,6 +145,7 @@ void RunLoop::Stop() {
 void RunLoop::Wakeup() { cond_.NotifyOne(); }
 
 bool RunLoop::Wait(const Duration timeout) {
+  TX_TRACE_SPAN("RunLoop::Wait");
   auto guard = shared_.Lock();
   return cond_.Wait(guard, timeout);
 }
@@ -153,6 +165,7 @@ void RunLoop::RemoveSource(Source *source, const String &scope_name) {
   drop(guard);
   if (!scope) return;
   scope->shared_.Lock()->source_set_.erase(source);
+  scope->removals_.fetch_add(1, std::memory_order_release);
   source->OnCancel(*this, scope);
 }
 
@@ -183,6 +196,7 @@ void RunLoop::RemoveObserver(Observer *observer, const String &scope_name) {
   drop(guard);
   if (!scope) return;
   scope->shared_.Lock()->observer_set_.erase(observer);
+  scope->removals_.fetch_add(1, std::memory_order_release);
 }
 
 void RunLoop::PerformBlock(std::function<void()> func,
@@ -194,55 +208,100 @@ void RunLoop::PerformBlock(std::function<void()> func,
   scope->shared_.Lock()->block_queue_.push(std::move(func));
 }
 
+void RunLoop::PerformBlock(std::function<void()> func,
+                           const CancellationToken &token,
+                           const String &scope_name) {
+  PerformBlock(
+      [func = std::move(func), token] {
+        if (!token.IsCancelled()) func();
+      },
+      scope_name);
+}
+
+// The Do* functions run callbacks without holding the scope lock, since they
+// may add or remove timers, sources and blocks of the same scope. Observers
+// and sources are run off a copy of their set, and the ones an earlier
+// callback of the pass removed, and maybe freed, are skipped.
 void RunLoop::DoObservers(RefPtr<Scope> scope, const Activity activity) {
+  // Taken rather than borrowed, in case a callback runs the loop nested.
+  std::vector<Observer *> observers = std::move(scope->observer_buffer_);
   auto scope_guard = scope->shared_.Lock();
-  for (const auto it : scope_guard->observer_set_) {
-    it->OnActivity(*this, activity);
+  observers.assign(scope_guard->observer_set_.begin(),
+                   scope_guard->observer_set_.end());
+  const uint64_t removals = scope->removals_.load(std::memory_order_relaxed);
+  drop(scope_guard);
+  for (Observer *observer : observers) {
+    if (scope->removals_.load(std::memory_order_acquire) != removals &&
+        !scope->shared_.Lock()->observer_set_.contains(observer)) {
+      continue;
+    }
+    observer->OnActivity(*this, activity);
   }
+  observers.clear();
+  scope->observer_buffer_ = std::move(observers);
 }
 
 void RunLoop::DoSources(RefPtr<Scope> scope) {
+  TX_TRACE_SPAN("RunLoop::DoSources");
+  std::vector<Source *> sources = std::move(scope->source_buffer_);
   auto scope_guard = scope->shared_.Lock();
-  for (const auto source : scope_guard->source_set_) {
-    if (source && source->IsSignaled()) {
+  sources.assign(scope_guard->source_set_.begin(),
+                 scope_guard->source_set_.end());
+  const uint64_t removals = scope->removals_.load(std::memory_order_relaxed);
+  drop(scope_guard);
+  for (Source *source : sources) {
+    if (scope->removals_.load(std::memory_order_acquire) != removals &&
+        !scope->shared_.Lock()->source_set_.contains(source)) {
+      continue;
+    }
+    if (source->IsSignaled()) {
       source->Clear();
       source->OnPerform(*this, scope);
     }
   }
+  sources.clear();
+  scope->source_buffer_ = std::move(sources);
 }
 
 void RunLoop::DoTimers(RefPtr<Scope> scope) {
+  TX_TRACE_SPAN("RunLoop::DoTimers");
   auto scope_guard = scope->shared_.Lock();
   if (scope_guard->timer_heap_.empty()) return;
   Timer *timer = scope_guard->timer_heap_.top();
   scope_guard->timer_heap_.pop();
+  drop(scope_guard);
   TX_ASSERT(timer);
-  if (!timer->alive_) return;
+  if (!timer->IsAlive()) return;
   timer->OnTimeout(*this, scope);
   timer->tick_++;
   if (timer->repeat_ == timer->tick_ - 1) return;
   if (timer->period_ > 0) {
-    timer->deadline_ = Time::Now() + timer->period_;
-    scope_guard->timer_heap_.push(timer);
-    TX_DEBUG("timer refreshed, tick/repeat: %lu/%lu", timer->tick_,
-             timer->repeat_);
+    timer->deadline_ = Time::FastNow() + timer->period_;
+    scope->shared_.Lock()->timer_heap_.push(timer);
+    TX_LOG_EVERY_DURATION(Debug, "TX", Duration::Second(1),
+                          "timer refreshed, tick/repeat: %lu/%lu", timer->tick_,
+                          timer->repeat_);
   }
 }
 
 void RunLoop::DoBlocks(RefPtr<Scope> scope) {
-  auto scope_guard = scope->shared_.Lock();
-  while (!scope_guard->block_queue_.empty()) {
-    const auto func = std::move(scope_guard->block_queue_.front());
-    scope_guard->block_queue_.pop();
+  TX_TRACE_SPAN("RunLoop::DoBlocks");
+  std::queue<FnOnce> blocks;
+  std::swap(blocks, scope->shared_.Lock()->block_queue_);
+  // Blocks performed by these blocks run on the next iteration.
+  while (!blocks.empty()) {
+    const auto func = std::move(blocks.front());
+    blocks.pop();
     func();
   }
 }
 
 void RunLoop::Source::Signal() {
   uint64_t expected = 0;
-  signaled_time_.compare_exchange_strong(expected, Time::Now().UnixNano(),
-                                         std::memory_order_acq_rel,
-                                         std::memory_order_relaxed);
+  const Clock::TimePoint now = Clock::Fast();
+  signaled_time_.compare_exchange_strong(
+      expected, static_cast<uint64_t>(now.sec * 1000000000 + now.nsec),
+      std::memory_order_acq_rel, std::memory_order_relaxed);
 }
 
 bool RunLoop::IsStopped() const {
@@ -263,7 +322,7 @@ Duration RunLoop::Scope::Timeout(const Time &now) {
 retry:
   if (guard->timer_heap_.empty() || retries > 5) return Duration::FOREVER;
   const auto timer = guard->timer_heap_.top();
-  if (!timer->alive_) {
+  if (!timer->IsAlive()) {
     guard->timer_heap_.pop();
     retries++;
     goto retry;
@@ -271,7 +330,9 @@ retry:
   return timer->deadline_ - now;
 }
 
-void RunLoop::ClearGlobalContext() { runLoopGlobalContext.Lock()->Clear(); }
+void RunLoop::ClearGlobalContext() {
+  runLoopGlobalContext.Write()->Clear();
+}
 
 String RunLoop::Scope::Default = "default";
 
@@ -1,16 +1,21 @@
 #pragma once
+#include <atomic>
 #include <queue>
 #include <unordered_set>
+#include <vector>
 
 #include "RunLoop.h"
+#include "TX/Arena.h"
+#include "TX/Cancellation.h"
 #include "TX/Condvar.h"
 #include "TX/Mutex.h"
 #include "TX/Ref.h"
 #include "TX/Thread.h"
 #include "TX/Time.h"
+#include "TX/WeakRef.h"
 
 namespace TX {
-class RunLoop final : public AtomicRefCounted<RunLoop> {
+class RunLoop final : public WeakRefCounted<RunLoop> {
  public:
   enum class Status { Finished, Timeout, Stopped };
   enum class Activity : uint8_t {
@@ -54,6 +59,7 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
     virtual void OnSchedule(RunLoop &, RefPtr<Scope> &) {}
     virtual void OnCancel(RunLoop &, RefPtr<Scope> &) {}
     virtual void OnPerform(RunLoop &, RefPtr<Scope> &) {}
+    // Nanoseconds of Clock::Id::Fast when signaled, 0 if not.
     TX_NODISCARD uint64_t SignaledTime() const;
     TX_NODISCARD bool IsSignaled() const { return SignaledTime() != 0; }
     void Signal();
@@ -72,7 +78,7 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
     explicit Timer(const Duration timeout, const Duration period = -1,
                    const uint64_t repeat = kTimerRepeatNever,
                    const String &name = "Timer")
-        : deadline_(Time::Now() + timeout),
+        : deadline_(Time::FastNow() + timeout),
           period_(period),
           repeat_(repeat),
           tick_(0),
@@ -83,9 +89,18 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
     virtual void OnTimeout(RunLoop &, RefPtr<Scope> &) {}
     TX_NODISCARD Tick GetTick() const { return tick_; }
 
+    // Once `token` is cancelled the timer never fires again and is dropped by
+    // the run loop as if it were removed.
+    void SetCancellationToken(const CancellationToken &token) {
+      token_ = token;
+    }
+
    private:
     friend RunLoop;
     void Cancel() { alive_ = false; }
+    TX_NODISCARD bool IsAlive() const {
+      return alive_ && !token_.IsCancelled();
+    }
 
     Time deadline_;
     Duration period_;
@@ -93,6 +108,7 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
     Tick tick_;
     String name_;
     std::atomic<bool> alive_;
+    CancellationToken token_;
   };
 
   class Scope final : public AtomicRefCounted<Scope> {
@@ -120,6 +136,13 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
       std::queue<FnOnce> block_queue_;
     };
     Mutex<Shared> shared_{};
+    // Bumped whenever a source or observer is removed, so that a pass over
+    // a copy of the sets only looks them up again after a removal.
+    std::atomic<uint64_t> removals_{0};
+    // The copies of the sets, kept across passes so that they don't allocate.
+    // Loop thread only.
+    std::vector<Observer *> observer_buffer_;
+    std::vector<Source *> source_buffer_;
     String name_;
     RunLoop *run_loop_;
   };
@@ -137,8 +160,19 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
 
   void PerformBlock(std::function<void()> func,
                     const String &scope_name = Scope::Default);
+  // The block is skipped if `token` gets cancelled before it runs.
+  void PerformBlock(std::function<void()> func,
+                    const CancellationToken &token,
+                    const String &scope_name = Scope::Default);
 
   void SetPeriod(const Duration period) { period_ = period; }
+  // Scratch memory for the current iteration, reset when the next one begins.
+  // Nested runs share the outermost run's iteration. Loop thread only.
+  TX_NODISCARD Arena &IterationArena() { return iteration_arena_; }
+  // The time of the current iteration, taken with Time::FastNow as it begins
+  // and again after the loop waits, so reading it is free. Compare it with
+  // FastNow times only. Loop thread only.
+  TX_NODISCARD const Time &Now() const { return now_; }
   TX_NODISCARD uint64_t GetTick() const { return tick_; }
   TX_NODISCARD bool IsInCurrentThread() const {
     return IsInThread(Thread::Current());
@@ -151,7 +185,8 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
   }
 
   static void ClearGlobalContext();
-  static Own<Thread> SpawnThread(const String &name = "TXRunLoop");
+  static Own<Thread> SpawnThread(const String &name = "TXRunLoop",
+                                 const Thread::Options &options = {});
   static Ref<RunLoop> FromThread(const Thread::Id &id);
   static Ref<RunLoop> Current() { return FromThread(Thread::Current()); }
   static Ref<RunLoop> Main() { return FromThread(Thread::Main()); }
@@ -163,13 +198,16 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
   };
 
   explicit RunLoop(const Thread::Id thread_id)
-      : shared_({}),
+      : shared_(),
         thread_id_(thread_id),
         period_(Duration::Second(1)),
         tick_(0),
+        depth_(0),
         stopped_(false) {}
 
   static Ref<RunLoop> Create(const Thread::Id thread_id) {
+    // Timers read Clock::Fast.
+    Clock::Calibrate();
     return adoptRef(*new RunLoop(thread_id));
   }
   Status Schedule(RefPtr<Scope> &scope, Duration max_timeout, uint64_t repeat);
@@ -189,6 +227,9 @@ class RunLoop final : public AtomicRefCounted<RunLoop> {
   Thread::Id thread_id_;
   Duration period_;
   Tick tick_;
+  uint32_t depth_;
+  Arena iteration_arena_;
+  Time now_;
   std::atomic<bool> stopped_;
 };
 }  // namespace TX
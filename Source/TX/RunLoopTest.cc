@@ -90,6 +90,35 @@ TEST_F(RunLoopTest, Run) {
   EXPECT_EQ(s1.n_perform_, 1);
 }
 
+TEST_F(RunLoopTest, RemoveDuringPass) {
+  // Frees the other source when performed.
+  class KillerSource final : public RunLoop::Source {
+   public:
+    explicit KillerSource(int *n_perform) : n_perform_(n_perform) {
+      RunLoop::Current()->AddSource(this);
+    }
+    ~KillerSource() override { RunLoop::Current()->RemoveSource(this); }
+    void OnPerform(RunLoop &, RefPtr<RunLoop::Scope> &) override {
+      (*n_perform_)++;
+      other_->Reset();
+    }
+    int *n_perform_;
+    Own<KillerSource> *other_ = nullptr;
+  };
+  Ref<RunLoop> loop = RunLoop::Current();
+  int n_perform = 0;
+  Own<KillerSource> s1(new KillerSource(&n_perform));
+  Own<KillerSource> s2(new KillerSource(&n_perform));
+  s1->other_ = &s2;
+  s2->other_ = &s1;
+  s1->Signal();
+  s2->Signal();
+  // Whichever runs first, the other is skipped rather than run freed.
+  EXPECT_EQ(loop->Run(0), RunLoop::Status::Finished);
+  EXPECT_EQ(n_perform, 1);
+  EXPECT_NE(!s1, !s2);
+}
+
 TEST_F(RunLoopTest, RunOnlyTimers) {
   Ref<RunLoop> loop = RunLoop::Current();
   const MockTimer t1(0, 50_ms, 5);
@@ -97,4 +126,28 @@ TEST_F(RunLoopTest, RunOnlyTimers) {
   EXPECT_EQ(loop->Run(5), RunLoop::Status::Finished);
   EXPECT_EQ(t1.n_timeout_, 6);
 }
+
+TEST_F(RunLoopTest, IterationArena) {
+  Ref<RunLoop> loop = RunLoop::Current();
+  EXPECT_NE(loop->IterationArena().Allocate(100), nullptr);
+  size_t used = 0;
+  loop->PerformBlock([&]() {
+    // The last iteration's memory is gone.
+    used = loop->IterationArena().BytesUsed();
+    EXPECT_NE(loop->IterationArena().Allocate(100), nullptr);
+  });
+  EXPECT_EQ(loop->Run(0), RunLoop::Status::Finished);
+  EXPECT_EQ(used, 0);
+  EXPECT_GE(loop->IterationArena().BytesUsed(), 100);
+}
+
+TEST_F(RunLoopTest, Now) {
+  Ref<RunLoop> loop = RunLoop::Current();
+  const Time before = Time::FastNow();
+  Time now;
+  loop->PerformBlock([&]() { now = loop->Now(); });
+  EXPECT_EQ(loop->Run(0), RunLoop::Status::Finished);
+  EXPECT_GE(now - before, 0);
+  EXPECT_LE(loop->Now() - before, Time::FastNow() - before);
+}
 }  // namespace TX
@@ -7,8 +7,9 @@
 namespace TX {
 class RunLoopThread {
  public:
-  static Own<RunLoopThread> Spawn(const String &name = "RunLoop") {
-    auto thread = RunLoop::SpawnThread(name);
+  static Own<RunLoopThread> Spawn(const String &name = "RunLoop",
+                                  const Thread::Options &options = {}) {
+    auto thread = RunLoop::SpawnThread(name, options);
     // If we do not detach here, ~RunLoopThread will block on join,
     // before it stops the underlying run loop.
     thread->Detach();
@@ -0,0 +1,150 @@
+#include "TX/RwLock.h"
+
+#include <thread>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "TX/Assert.h"
+#include "TX/Thread.h"
+
+namespace TX {
+template <class F>
+uint32 RawRwLock::spinUntil(F f) {
+  for (int i = 0; i < kSpinLimit; i++) {
+    const uint32 state = state_.load(std::memory_order_relaxed);
+    if (f(state)) return state;
+    TX_CPU_RELAX();
+  }
+  return state_.load(std::memory_order_relaxed);
+}
+
+void RawRwLock::lockSharedContended() {
+  // Spinning is only worth it while a writer holds the lock and nobody is
+  // queued yet.
+  auto spin = [this] {
+    return spinUntil([](const uint32 s) {
+      return !isWriteLocked(s) || hasReadersWaiting(s) || hasWritersWaiting(s);
+    });
+  };
+  uint32 state = spin();
+  while (true) {
+    if (isReadLockable(state)) {
+      if (state_.compare_exchange_weak(state, state + kReadLocked,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    TX_ASSERT((state & kMask) != kWriteLocked - 1, "Too many readers");
+    if (!hasReadersWaiting(state)) {
+      if (!state_.compare_exchange_weak(state, state | kReadersWaiting,
+                                        std::memory_order_relaxed,
+                                        std::memory_order_relaxed)) {
+        continue;
+      }
+    }
+    Futex::Wait(state_, state | kReadersWaiting);
+    state = spin();
+  }
+}
+
+void RawRwLock::lockContended() {
+  auto spin = [this] {
+    return spinUntil([](const uint32 s) {
+      return isUnlocked(s) || hasWritersWaiting(s);
+    });
+  };
+  uint32 state = spin();
+  // Once we have slept, we can't tell whether other writers are still
+  // waiting, so keep the bit set when we take the lock.
+  uint32 other_writers_waiting = 0;
+  while (true) {
+    if (isUnlocked(state)) {
+      if (state_.compare_exchange_weak(
+              state, state | kWriteLocked | other_writers_waiting,
+              std::memory_order_acquire, std::memory_order_relaxed)) {
+        return;
+      }
+      continue;
+    }
+    if (!hasWritersWaiting(state)) {
+      if (!state_.compare_exchange_weak(state, state | kWritersWaiting,
+                                        std::memory_order_relaxed,
+                                        std::memory_order_relaxed)) {
+        continue;
+      }
+    }
+    other_writers_waiting = kWritersWaiting;
+    // Read the notification counter before checking the state again, so a
+    // wake-up in between makes the futex return at once.
+    const uint32 seq = writer_notify_.load(std::memory_order_acquire);
+    state = state_.load(std::memory_order_relaxed);
+    if (isUnlocked(state) || !hasWritersWaiting(state)) continue;
+    Futex::Wait(writer_notify_, seq);
+    state = spin();
+  }
+}
+
+void RawRwLock::wakeWriterOrReaders(uint32 state) {
+  TX_ASSERT(isUnlocked(state));
+  // If the lock gets locked meanwhile, whoever locked it wakes the waiters
+  // on unlock, and the compare-exchanges below fail.
+  if (state == kWritersWaiting) {
+    if (state_.compare_exchange_strong(state, 0, std::memory_order_relaxed,
+                                       std::memory_order_relaxed)) {
+      wakeWriter();
+      return;
+    }
+  }
+  // Both are waiting: leave the readers waiting and wake one writer.
+  if (state == kReadersWaiting + kWritersWaiting) {
+    if (!state_.compare_exchange_strong(state, kReadersWaiting,
+                                        std::memory_order_relaxed,
+                                        std::memory_order_relaxed)) {
+      return;
+    }
+    if (wakeWriter()) return;
+    // We can't tell whether a writer was asleep, wake the readers as well.
+    state = kReadersWaiting;
+  }
+  if (state == kReadersWaiting) {
+    if (state_.compare_exchange_strong(state, 0, std::memory_order_relaxed,
+                                       std::memory_order_relaxed)) {
+      Futex::WakeAll(state_);
+    }
+  }
+}
+
+bool RawRwLock::wakeWriter() {
+  writer_notify_.fetch_add(1, std::memory_order_release);
+  return Futex::WakeOne(writer_notify_);
+}
+
+RawShardedRwLock::RawShardedRwLock() {
+  // A power of two so that picking a shard is a mask.
+  const size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+  num_shards_ = 1;
+  while (num_shards_ < cpus && num_shards_ < 64) num_shards_ <<= 1;
+  shards_.reset(new Shard[num_shards_]);
+}
+
+bool RawShardedRwLock::TryLock() {
+  for (size_t i = 0; i < num_shards_; i++) {
+    if (!shards_[i].lock.TryLock()) {
+      while (i > 0) shards_[--i].lock.Unlock();
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t RawShardedRwLock::currentShard() const {
+#ifdef __linux__
+  const int cpu = sched_getcpu();
+  if (cpu >= 0) return static_cast<size_t>(cpu) & (num_shards_ - 1);
+#endif
+  return std::hash<Thread::Id>()(Thread::Current()) & (num_shards_ - 1);
+}
+}  // namespace TX
@@ -0,0 +1,261 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "TX/Bits.h"
+#include "TX/Futex.h"
+#include "TX/Memory.h"
+#include "TX/Option.h"
+#include "TX/Platform.h"
+
+namespace TX {
+// An 8-byte writer-preferring reader-writer lock on top of Futex. Once a
+// writer is waiting, new readers queue up behind it, so a steady stream of
+// readers cannot starve writers.
+//
+// LockShared returns a token to hand back to UnlockShared, unused here but
+// needed by RawShardedRwLock.
+class RawRwLock {
+ public:
+  explicit RawRwLock() : state_(0), writer_notify_(0) {}
+  TX_DISALLOW_COPY(RawRwLock)
+
+  size_t LockShared() {
+    uint32 state = state_.load(std::memory_order_relaxed);
+    if (!isReadLockable(state) ||
+        !state_.compare_exchange_weak(state, state + kReadLocked,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      lockSharedContended();
+    }
+    return 0;
+  }
+  Option<size_t> TryLockShared() {
+    uint32 state = state_.load(std::memory_order_relaxed);
+    while (isReadLockable(state)) {
+      if (state_.compare_exchange_weak(state, state + kReadLocked,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return 0;
+      }
+    }
+    return None;
+  }
+  void UnlockShared(size_t) {
+    const uint32 state =
+        state_.fetch_sub(kReadLocked, std::memory_order_release) -
+        kReadLocked;
+    // Readers never wait while the lock is read-locked unless a writer is
+    // waiting, so only the last reader has someone to wake up.
+    if (isUnlocked(state) && hasWritersWaiting(state)) {
+      wakeWriterOrReaders(state);
+    }
+  }
+
+  void Lock() {
+    uint32 expected = 0;
+    if (!state_.compare_exchange_weak(expected, kWriteLocked,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      lockContended();
+    }
+  }
+  bool TryLock() {
+    uint32 state = state_.load(std::memory_order_relaxed);
+    while (isUnlocked(state)) {
+      if (state_.compare_exchange_weak(state, state + kWriteLocked,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  void Unlock() {
+    const uint32 state =
+        state_.fetch_sub(kWriteLocked, std::memory_order_release) -
+        kWriteLocked;
+    if (hasReadersWaiting(state) || hasWritersWaiting(state)) {
+      wakeWriterOrReaders(state);
+    }
+  }
+
+ private:
+  // The low 30 bits count readers, all ones means write-locked.
+  static constexpr uint32 kReadLocked = 1;
+  static constexpr uint32 kMask = (1u << 30) - 1;
+  static constexpr uint32 kWriteLocked = kMask;
+  static constexpr uint32 kReadersWaiting = 1u << 30;
+  static constexpr uint32 kWritersWaiting = 1u << 31;
+  static constexpr int kSpinLimit = 100;
+
+  static bool isUnlocked(const uint32 state) { return (state & kMask) == 0; }
+  static bool isWriteLocked(const uint32 state) {
+    return (state & kMask) == kWriteLocked;
+  }
+  static bool hasReadersWaiting(const uint32 state) {
+    return (state & kReadersWaiting) != 0;
+  }
+  static bool hasWritersWaiting(const uint32 state) {
+    return (state & kWritersWaiting) != 0;
+  }
+  // Readers queue behind anyone waiting, which is what prefers writers.
+  static bool isReadLockable(const uint32 state) {
+    return (state & kMask) < kWriteLocked - 1 && !hasReadersWaiting(state) &&
+           !hasWritersWaiting(state);
+  }
+
+  void lockSharedContended();
+  void lockContended();
+  void wakeWriterOrReaders(uint32 state);
+  bool wakeWriter();
+  template <class F>
+  uint32 spinUntil(F f);
+
+  std::atomic<uint32> state_;
+  // Bumped to wake up a writer. Writers sleep here rather than on state_ so
+  // that waking one does not wake the readers.
+  std::atomic<uint32> writer_notify_;
+};
+
+// A reader-writer lock with one RawRwLock per CPU slot, each on its own cache
+// line. Readers only touch the slot of the CPU they run on, so read-mostly
+// workloads scale with the number of cores, at the cost of writers having to
+// lock every slot.
+class RawShardedRwLock {
+ public:
+  explicit RawShardedRwLock();
+  TX_DISALLOW_COPY(RawShardedRwLock)
+
+  size_t LockShared() {
+    const size_t shard = currentShard();
+    shards_[shard].lock.LockShared();
+    return shard;
+  }
+  Option<size_t> TryLockShared() {
+    const size_t shard = currentShard();
+    if (!shards_[shard].lock.TryLockShared()) return None;
+    return shard;
+  }
+  void UnlockShared(const size_t shard) {
+    shards_[shard].lock.UnlockShared(0);
+  }
+
+  void Lock() {
+    for (size_t i = 0; i < num_shards_; i++) shards_[i].lock.Lock();
+  }
+  bool TryLock();
+  void Unlock() {
+    for (size_t i = 0; i < num_shards_; i++) shards_[i].lock.Unlock();
+  }
+
+ private:
+  struct alignas(TX_CACHE_LINE_SIZE) Shard {
+    RawRwLock lock;
+  };
+
+  size_t currentShard() const;
+
+  size_t num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+template <typename T, typename Raw = RawRwLock>
+class RwLockReadGuard;
+template <typename T, typename Raw = RawRwLock>
+class RwLockWriteGuard;
+
+// Like Mutex, but any number of readers can hold the lock together. Read
+// guards only give const access.
+template <typename T, typename Raw = RawRwLock>
+class RwLock {
+ public:
+  explicit RwLock() : t_() {}
+  RwLock(T &&t) : t_(std::move(t)) {}
+  TX_DISALLOW_COPY(RwLock)
+
+  RwLockReadGuard<T, Raw> Read() {
+    return RwLockReadGuard<T, Raw>(this, raw_.LockShared());
+  }
+  Option<RwLockReadGuard<T, Raw>> TryRead() {
+    const Option<size_t> token = raw_.TryLockShared();
+    if (!token) return None;
+    return RwLockReadGuard<T, Raw>(this, *token);
+  }
+
+  RwLockWriteGuard<T, Raw> Write() {
+    raw_.Lock();
+    return RwLockWriteGuard<T, Raw>(this);
+  }
+  Option<RwLockWriteGuard<T, Raw>> TryWrite() {
+    if (!raw_.TryLock()) return None;
+    return RwLockWriteGuard<T, Raw>(this);
+  }
+
+ private:
+  friend RwLockReadGuard<T, Raw>;
+  friend RwLockWriteGuard<T, Raw>;
+  T t_;
+  Raw raw_;
+};
+
+// For read-mostly data on hot paths, see RawShardedRwLock.
+template <typename T>
+using ShardedRwLock = RwLock<T, RawShardedRwLock>;
+
+template <typename T, typename Raw>
+class RwLockReadGuard {
+ public:
+  TX_DISALLOW_COPY(RwLockReadGuard)
+  RwLockReadGuard(RwLockReadGuard &&other) noexcept
+      : lock_(std::exchange(other.lock_, nullptr)), token_(other.token_) {}
+  RwLockReadGuard &operator=(RwLockReadGuard &&other) noexcept {
+    lock_ = std::exchange(other.lock_, nullptr);
+    token_ = other.token_;
+    return *this;
+  }
+  ~RwLockReadGuard() {
+    if (lock_) {
+      lock_->raw_.UnlockShared(token_);
+      lock_ = nullptr;
+    }
+  }
+  const T &operator*() const { return lock_->t_; }
+  const T *operator->() const { return &lock_->t_; }
+
+ private:
+  explicit RwLockReadGuard(RwLock<T, Raw> *lock, const size_t token)
+      : lock_(lock), token_(token) {}
+
+  friend class RwLock<T, Raw>;
+  RwLock<T, Raw> *lock_;
+  size_t token_;
+};
+
+template <typename T, typename Raw>
+class RwLockWriteGuard {
+ public:
+  TX_DISALLOW_COPY(RwLockWriteGuard)
+  RwLockWriteGuard(RwLockWriteGuard &&other) noexcept
+      : lock_(std::exchange(other.lock_, nullptr)) {}
+  RwLockWriteGuard &operator=(RwLockWriteGuard &&other) noexcept {
+    lock_ = std::exchange(other.lock_, nullptr);
+    return *this;
+  }
+  ~RwLockWriteGuard() {
+    if (lock_) {
+      lock_->raw_.Unlock();
+      lock_ = nullptr;
+    }
+  }
+  T &operator*() { return lock_->t_; }
+  T *operator->() { return &lock_->t_; }
+
+ private:
+  explicit RwLockWriteGuard(RwLock<T, Raw> *lock) : lock_(lock) {}
+
+  friend class RwLock<T, Raw>;
+  RwLock<T, Raw> *lock_;
+};
+}  // namespace TX
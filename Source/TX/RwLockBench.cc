@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+#include "TX/Mutex.h"
+#include "TX/Own.h"
+#include "TX/RwLock.h"
+#include "TX/Thread.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+// Threads look up a small map, the way TaskManager::findTask does, with one
+// write every kWriteEvery operations. Reports the average time per operation,
+// all threads together; it only drops with more threads if reads scale.
+class RwLockBench : public testing::TestWithParam<int> {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  using Map = std::unordered_map<int, int>;
+  static constexpr int kOperations = 2000000;
+  static constexpr int kWriteEvery = 1000;
+
+  static Map map() {
+    Map map;
+    for (int i = 0; i < 64; i++) map[i] = i;
+    return map;
+  }
+
+  template <class Read, class Write>
+  static void run(const char *name, Read read, Write write) {
+    const int n_threads = GetParam();
+    const int per_thread = kOperations / n_threads;
+    const Clock::time_point start = Clock::now();
+    {
+      std::vector<Own<Thread>> threads;
+      for (int i = 0; i < n_threads; i++) {
+        threads.push_back(Thread::Spawn([&] {
+          uint64 sum = 0;
+          for (int j = 0; j < per_thread; j++) {
+            if (j % kWriteEvery == 0) {
+              write(j % 64);
+            } else {
+              sum += read(j % 64);
+            }
+          }
+          EXPECT_GT(sum, 0);
+        }));
+      }
+    }
+    const double ns =
+        std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    std::printf("%-16s threads %2d: %7.1f ns/op\n", name, n_threads,
+                ns / (per_thread * n_threads));
+  }
+};
+
+TEST_P(RwLockBench, Mutex) {
+  Mutex<Map> m(map());
+  run(
+      "Mutex", [&](const int k) { return m.Lock()->at(k); },
+      [&](const int k) { (*m.Lock())[k] = k; });
+}
+
+TEST_P(RwLockBench, RwLock) {
+  RwLock<Map> m(map());
+  run(
+      "RwLock", [&](const int k) { return m.Read()->at(k); },
+      [&](const int k) { (*m.Write())[k] = k; });
+}
+
+TEST_P(RwLockBench, ShardedRwLock) {
+  ShardedRwLock<Map> m(map());
+  run(
+      "ShardedRwLock", [&](const int k) { return m.Read()->at(k); },
+      [&](const int k) { (*m.Write())[k] = k; });
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, RwLockBench, testing::Values(1, 2, 4, 8));
+}  // namespace TX
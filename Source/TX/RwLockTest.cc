@@ -0,0 +1,83 @@
+#include "TX/RwLock.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "TX/Own.h"
+#include "TX/Thread.h"
+
+namespace TX {
+template <class L>
+struct RwLockTest : testing::Test {};
+using RwLockTypes = testing::Types<RwLock<int>, ShardedRwLock<int>>;
+TYPED_TEST_SUITE(RwLockTest, RwLockTypes);
+
+TYPED_TEST(RwLockTest, Exclusion) {
+  TypeParam n(1);
+  {
+    auto r1 = n.Read();
+    auto r2 = n.Read();
+    EXPECT_EQ(*r1 + *r2, 2);
+    EXPECT_FALSE(n.TryWrite().has_value());
+    EXPECT_TRUE(n.TryRead().has_value());
+  }
+  {
+    auto w = n.Write();
+    *w = 42;
+    EXPECT_FALSE(n.TryRead().has_value());
+    EXPECT_FALSE(n.TryWrite().has_value());
+  }
+  EXPECT_EQ(*n.Read(), 42);
+}
+
+TYPED_TEST(RwLockTest, Contended) {
+  constexpr int kWriters = 2, kReaders = 4, N = 20000;
+  TypeParam n(0);
+  std::atomic<bool> torn = false;
+  {
+    std::vector<Own<Thread>> threads;
+    for (int i = 0; i < kWriters; i++) {
+      threads.push_back(Thread::Spawn([&]() {
+        for (int j = 0; j < N; j++) {
+          auto w = n.Write();
+          // Readers must never see the odd intermediate value.
+          (*w)++;
+          (*w)++;
+        }
+      }));
+    }
+    for (int i = 0; i < kReaders; i++) {
+      threads.push_back(Thread::Spawn([&]() {
+        for (int j = 0; j < N; j++) {
+          if (*n.Read() % 2 != 0) torn = true;
+        }
+      }));
+    }
+  }
+  EXPECT_FALSE(torn.load());
+  EXPECT_EQ(*n.Read(), kWriters * N * 2);
+}
+
+TEST(RwLockTest, WriterPreferring) {
+  RwLock<int> n(0);
+  Option<RwLockReadGuard<int>> reader = n.Read();
+  std::atomic<bool> written = false;
+  {
+    Thread writer([&] {
+      *n.Write() = 1;
+      written = true;
+    });
+    // Wait until the writer is queued, new readers must then block.
+    while (n.TryRead().has_value()) {
+      std::this_thread::yield();
+    }
+    EXPECT_FALSE(written.load());
+    reader.reset();
+  }
+  EXPECT_TRUE(written.load());
+  EXPECT_EQ(*n.Read(), 1);
+}
+}  // namespace TX
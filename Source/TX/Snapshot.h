@@ -0,0 +1,189 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "TX/Bits.h"
+#include "TX/HazardPointer.h"
+#include "TX/Memory.h"
+#include "TX/Mutex.h"
+#include "TX/Platform.h"
+
+namespace TX {
+// Small trivially copyable values are kept behind a seqlock, anything else
+// behind an RCU-style pointer.
+template <typename T>
+inline constexpr bool kSnapshotUseSeqlock =
+    std::is_trivially_copyable_v<T> && sizeof(T) <= TX_CACHE_LINE_SIZE;
+
+template <typename T, bool Seqlock = kSnapshotUseSeqlock<T>>
+class Snapshot;
+
+// A read-mostly value, such as a global option, that readers see as an
+// immutable version and writers replace as a whole. Publishing never blocks
+// readers, and readers take no lock and share no cache line with each other.
+//
+// This one is a seqlock: readers copy the value out and retry if a writer
+// got in the way. Load is the only read access.
+template <typename T>
+class Snapshot<T, true> {
+ public:
+  explicit Snapshot(const T &t = T()) : seq_(0) { store(t); }
+  TX_DISALLOW_COPY(Snapshot)
+
+  T Load() const {
+    uint64 buf[kWords];
+    while (true) {
+      const uint64 seq = seq_.load(std::memory_order_acquire);
+      if (seq & 1) {
+        TX_CPU_RELAX();
+        continue;
+      }
+      for (size_t i = 0; i < kWords; i++) {
+        buf[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      // Keeps the loads above from moving past the re-check below.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == seq) break;
+    }
+    T t;
+    std::memcpy(&t, buf, sizeof(T));
+    return t;
+  }
+
+  void Store(const T &t) {
+    writer_.Lock();
+    store(t);
+    writer_.Unlock();
+  }
+
+  // Publishes f(current value) with writers serialized, so that concurrent
+  // updates are not lost.
+  template <typename F>
+  void Update(F f) {
+    writer_.Lock();
+    store(f(Load()));
+    writer_.Unlock();
+  }
+
+  // Bumped by every Store and Update, starting at 1.
+  uint64 Version() const {
+    return seq_.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  static constexpr size_t kWords = (sizeof(T) + 7) / 8;
+
+  void store(const T &t) {
+    uint64 buf[kWords] = {};
+    std::memcpy(buf, &t, sizeof(T));
+    const uint64 seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+      words_[i].store(buf[i], std::memory_order_relaxed);
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // Odd while a writer is in the middle of a store.
+  std::atomic<uint64> seq_;
+  std::atomic<uint64> words_[kWords];
+  RawMutex writer_;
+};
+
+// This one swaps a pointer to an immutable version. Read protects the current
+// version with a hazard pointer, which writes only the reader's own slot, and
+// the writer retires a replaced version to be freed once no reader protects
+// it, so readers do not contend with each other and writers never wait for
+// readers either. A read retries only if a writer published in the meantime.
+template <typename T>
+class Snapshot<T, false> {
+  struct Node;
+
+ public:
+  class Ref {
+   public:
+    TX_DISALLOW_COPY(Ref)
+    Ref(Ref &&other) noexcept
+        : hp_(std::exchange(other.hp_, nullptr)),
+          version_(std::exchange(other.version_, nullptr)) {}
+    Ref &operator=(Ref &&other) noexcept {
+      if (this != &other) {
+        release();
+        hp_ = std::exchange(other.hp_, nullptr);
+        version_ = std::exchange(other.version_, nullptr);
+      }
+      return *this;
+    }
+    ~Ref() { release(); }
+
+    const T &operator*() const { return version_->value; }
+    const T *operator->() const { return &version_->value; }
+    uint64 Version() const { return version_->version; }
+
+   private:
+    explicit Ref(HazardPointer *hp, const Node *version)
+        : hp_(hp), version_(version) {}
+    void release() {
+      if (hp_) {
+        HazardPointer::Release(hp_);
+        hp_ = nullptr;
+        version_ = nullptr;
+      }
+    }
+
+    friend class Snapshot;
+    HazardPointer *hp_;
+    const Node *version_;
+  };
+
+  explicit Snapshot(T t = T()) : head_(new Node(std::move(t), 1)) {}
+  ~Snapshot() {
+    // All Refs must be gone by now, and replaced versions were retired.
+    delete head_.load(std::memory_order_acquire);
+  }
+  TX_DISALLOW_COPY(Snapshot)
+
+  // Pins the current version for as long as the returned Ref lives.
+  TX_NODISCARD Ref Read() const {
+    HazardPointer *hp = HazardPointer::Acquire();
+    return Ref(hp, hp->Protect(head_));
+  }
+  T Load() const { return *Read(); }
+
+  void Store(T t) {
+    writer_.Lock();
+    publish(std::move(t));
+    writer_.Unlock();
+  }
+
+  template <typename F>
+  void Update(F f) {
+    writer_.Lock();
+    publish(f(*Read()));
+    writer_.Unlock();
+  }
+
+  uint64 Version() const { return Read().Version(); }
+
+ private:
+  struct Node {
+    explicit Node(T &&v, const uint64 n) : value(std::move(v)), version(n) {}
+    const T value;
+    const uint64 version;
+  };
+
+  void publish(T &&t) {
+    const uint64 next = head_.load(std::memory_order_relaxed)->version + 1;
+    Node *prev = head_.exchange(new Node(std::move(t), next),
+                                std::memory_order_acq_rel);
+    HazardPointer::Retire(prev);
+  }
+
+  std::atomic<Node *> head_;
+  RawMutex writer_;
+};
+}  // namespace TX
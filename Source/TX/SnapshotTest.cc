@@ -0,0 +1,114 @@
+#include "TX/Snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "TX/Own.h"
+#include "TX/Thread.h"
+
+namespace TX {
+namespace {
+struct Pair {
+  uint64 a, b;
+};
+
+// Counts live instances, to check that replaced versions get freed.
+struct Tracked {
+  static inline std::atomic<int> live = 0;
+  explicit Tracked(const uint64 n = 0) : a(n), b(n) { live++; }
+  Tracked(const Tracked &other) : a(other.a), b(other.b) { live++; }
+  Tracked(Tracked &&other) noexcept : a(other.a), b(other.b) { live++; }
+  ~Tracked() { live--; }
+  uint64 a, b;
+};
+}  // namespace
+
+TEST(SnapshotTest, Seqlock) {
+  static_assert(kSnapshotUseSeqlock<Pair>);
+  Snapshot<Pair> s({1, 2});
+  EXPECT_EQ(s.Version(), 1u);
+  EXPECT_EQ(s.Load().b, 2u);
+  s.Store({3, 4});
+  s.Update([](Pair p) { return Pair{p.a + 1, p.b + 1}; });
+  EXPECT_EQ(s.Load().a, 4u);
+  EXPECT_EQ(s.Version(), 3u);
+}
+
+TEST(SnapshotTest, Rcu) {
+  static_assert(!kSnapshotUseSeqlock<std::string>);
+  Snapshot<std::string> s("foo");
+  {
+    auto r = s.Read();
+    s.Store("bar");
+    // A pinned version stays as it was.
+    EXPECT_EQ(*r, "foo");
+    EXPECT_EQ(r.Version(), 1u);
+  }
+  s.Update([](const std::string &v) { return v + "baz"; });
+  EXPECT_EQ(s.Load(), "barbaz");
+  EXPECT_EQ(s.Version(), 3u);
+}
+
+TEST(SnapshotTest, RcuReclaim) {
+  {
+    Snapshot<Tracked> s;
+    auto r1 = s.Read();
+    s.Store(Tracked(1));
+    auto r2 = s.Read();
+    s.Store(Tracked(2));
+    // Both replaced versions are still pinned.
+    EXPECT_EQ(Tracked::live.load(), 3);
+    drop(r1);
+    HazardPointer::Collect();
+    EXPECT_EQ(Tracked::live.load(), 2);
+    drop(r2);
+    HazardPointer::Collect();
+    EXPECT_EQ(Tracked::live.load(), 1);
+    s.Store(Tracked(3));
+    HazardPointer::Collect();
+    EXPECT_EQ(Tracked::live.load(), 1);
+  }
+  EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+template <class S, class V = typename S::Value>
+static void ContendedTest() {
+  constexpr int kReaders = 4, N = 20000;
+  S s;
+  std::atomic<bool> torn = false;
+  {
+    std::vector<Own<Thread>> threads;
+    threads.push_back(Thread::Spawn([&]() {
+      for (uint64 i = 1; i <= N; i++) s.Store(V(i));
+    }));
+    for (int i = 0; i < kReaders; i++) {
+      threads.push_back(Thread::Spawn([&]() {
+        for (int j = 0; j < N; j++) {
+          const auto v = s.Load();
+          if (v.a != v.b) torn = true;
+        }
+      }));
+    }
+  }
+  EXPECT_FALSE(torn.load());
+  EXPECT_EQ(s.Load().a, static_cast<uint64>(N));
+  EXPECT_EQ(s.Version(), static_cast<uint64>(N + 1));
+}
+
+TEST(SnapshotTest, Contended) {
+  struct SeqlockPair : Snapshot<Pair> {
+    struct Value : Pair {
+      explicit Value(const uint64 n) : Pair{n, n} {}
+    };
+    void Store(const Value &v) { Snapshot<Pair>::Store(v); }
+  };
+  ContendedTest<SeqlockPair>();
+  ContendedTest<Snapshot<Tracked>, Tracked>();
+  // Versions still protected when the writer exited were left to others.
+  HazardPointer::Collect();
+  EXPECT_EQ(Tracked::live.load(), 0);
+}
+}  // namespace TX
@@ -4,7 +4,11 @@
 #include <utility>
 
 #include "TX/Assert.h"
+#include "TX/Bits.h"
+#include "TX/Epoch.h"
+#include "TX/HazardPointer.h"
 #include "TX/Memory.h"
+#include "TX/Option.h"
 #include "TX/Own.h"
 #include "TX/Platform.h"
 #include "TX/String.h"
@@ -13,21 +17,73 @@
 #include <windows.h>
 #else
 #include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <cerrno>
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 namespace TX {
+// Scheduling and stack settings for a new Thread. The defaults leave
+// everything as the platform has it.
+struct ThreadOptions {
+  enum class Policy {
+    kDefault,
+    // Linux only, SCHED_BATCH and SCHED_IDLE. Elsewhere same as kDefault.
+    kBatch,
+    kIdle,
+    // Real-time policies, which need privileges. `priority` applies to these.
+    kFifo,
+    kRoundRobin,
+  };
+
+  // CPUs the thread may run on, bit i for CPU i. Zero leaves it unpinned.
+  // Ignored on Apple platforms, which have no affinity API.
+  uint64 affinity = 0;
+  Policy policy = Policy::kDefault;
+  int priority = 0;
+  // Nice value of the thread, -20 to 19. Only Linux can set it per thread,
+  // Windows maps it to the nearest thread priority.
+  Option<int> nice;
+  // Zero means the platform default, usually 8 MiB on Linux.
+  size_t stack_size = 0;
+  // Size of the guard area below the stack, zero for none.
+  Option<size_t> guard_size;
+};
+
 class TX_NODISCARD Thread final {
  public:
   using Func = std::function<void()>;
-  explicit Thread(Func f, String name = "")
-      : detached_(false), func_(std::move(f)), name_(std::move(name)) {
+  using Options = ThreadOptions;
+
+  explicit Thread(Func f, String name = "", Options options = {})
+      : detached_(false),
+        func_(std::move(f)),
+        name_(std::move(name)),
+        options_(std::move(options)) {
 #ifdef _WIN32
-    handle_ =
-        CreateThread(nullptr, 0, ThreadProc, this, CREATE_SUSPENDED, nullptr);
+    handle_ = CreateThread(nullptr, options_.stack_size, ThreadProc, this,
+                           CREATE_SUSPENDED | STACK_SIZE_PARAM_IS_A_RESERVATION,
+                           nullptr);
     if (!handle_) TX_FATAL("CreateThread, error code %d", GetLastError());
     ResumeThread(handle_);
 #else
-    TX_ASSERT_SYSCALL(pthread_create(&tid_, nullptr, &Run, this));
+    // Stack settings can only be made before the thread exists, the rest is
+    // applied by the thread itself in Run.
+    pthread_attr_t attr;
+    TX_ASSERT_SYSCALL(pthread_attr_init(&attr));
+    if (options_.stack_size) {
+      TX_ASSERT_SYSCALL(pthread_attr_setstacksize(&attr, options_.stack_size));
+    }
+    if (options_.guard_size) {
+      TX_ASSERT_SYSCALL(pthread_attr_setguardsize(&attr, *options_.guard_size));
+    }
+    TX_ASSERT_SYSCALL(pthread_create(&tid_, &attr, &Run, this));
+    TX_ASSERT_SYSCALL(pthread_attr_destroy(&attr));
 #endif
   }
 
@@ -103,8 +159,9 @@ class TX_NODISCARD Thread final {
 #endif
   }
 
-  static Own<Thread> Spawn(Func f, const String &name = "") {
-    return Own(new Thread(std::move(f), name));
+  static Own<Thread> Spawn(Func f, const String &name = "",
+                           const Options &options = {}) {
+    return Own(new Thread(std::move(f), name, options));
   }
 
  private:
@@ -122,15 +179,106 @@ class TX_NODISCARD Thread final {
 #else
 #endif
     }
+    t->applyOptions();
 
     try {
       t->func_();
     } catch (...) {
       t->eptr_ = std::current_exception();
     }
+    // Free what the thread retired while it can still do so itself, rather
+    // than later from thread_local destructors.
+    Epoch::OnThreadExit();
+    HazardPointer::OnThreadExit();
     return nullptr;
   }
 
+  // Runs on the new thread. Raising the priority or picking a real-time
+  // policy fails without privileges, which is not worth dying for, so only
+  // invalid options are fatal.
+  void applyOptions() const {
+#ifdef _WIN32
+    if (options_.affinity) {
+      if (!SetThreadAffinityMask(GetCurrentThread(),
+                                 static_cast<DWORD_PTR>(options_.affinity)))
+        TX_FATAL("SetThreadAffinityMask, error code %d", GetLastError());
+    }
+    int priority = THREAD_PRIORITY_NORMAL;
+    if (options_.policy == Options::Policy::kFifo ||
+        options_.policy == Options::Policy::kRoundRobin) {
+      priority = THREAD_PRIORITY_TIME_CRITICAL;
+    } else if (options_.policy == Options::Policy::kIdle) {
+      priority = THREAD_PRIORITY_IDLE;
+    } else if (options_.nice) {
+      priority = *options_.nice <= -15 ? THREAD_PRIORITY_HIGHEST
+                 : *options_.nice < 0  ? THREAD_PRIORITY_ABOVE_NORMAL
+                 : *options_.nice == 0 ? THREAD_PRIORITY_NORMAL
+                 : *options_.nice < 15 ? THREAD_PRIORITY_BELOW_NORMAL
+                                       : THREAD_PRIORITY_LOWEST;
+    }
+    if (priority != THREAD_PRIORITY_NORMAL) {
+      SetThreadPriority(GetCurrentThread(), priority);
+    }
+#else
+#ifdef __linux__
+    if (options_.affinity) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (int i = 0; i < 64; i++) {
+        if (options_.affinity & (uint64{1} << i)) CPU_SET(i, &set);
+      }
+      // pid 0 is the calling thread. Unlike pthread_setaffinity_np, this is
+      // in bionic as well as glibc.
+      const int rc = sched_setaffinity(0, sizeof(set), &set);
+      checkOption(rc == 0 ? 0 : errno, "sched_setaffinity");
+    }
+#endif
+    if (options_.policy != Options::Policy::kDefault) {
+      int policy = SCHED_OTHER;
+      sched_param param{};
+      switch (options_.policy) {
+#ifdef __linux__
+        case Options::Policy::kBatch:
+          policy = SCHED_BATCH;
+          break;
+        case Options::Policy::kIdle:
+          policy = SCHED_IDLE;
+          break;
+#endif
+        case Options::Policy::kFifo:
+          policy = SCHED_FIFO;
+          param.sched_priority = options_.priority;
+          break;
+        case Options::Policy::kRoundRobin:
+          policy = SCHED_RR;
+          param.sched_priority = options_.priority;
+          break;
+        default:
+          break;
+      }
+      checkOption(pthread_setschedparam(pthread_self(), policy, &param),
+                  "pthread_setschedparam");
+    }
+#ifdef __linux__
+    // Linux threads have their own nice value, unlike POSIX says.
+    if (options_.nice) {
+      const int rc = setpriority(PRIO_PROCESS,
+                                 static_cast<id_t>(syscall(SYS_gettid)),
+                                 *options_.nice);
+      checkOption(rc == 0 ? 0 : errno, "setpriority");
+    }
+#endif
+#endif
+  }
+
+#ifndef _WIN32
+  static void checkOption(const int rc, const char *what) {
+    if (rc != 0 && rc != EPERM && rc != EACCES) {
+      TX_FATAL("%s: rc(%d)", what, rc);
+    }
+  }
+#endif
+
 #ifdef _WIN32
   static DWORD WINAPI ThreadProc(LPVOID arg) {
     Run(arg);
@@ -142,6 +290,7 @@ class TX_NODISCARD Thread final {
   bool detached_;
   Func func_;
   String name_;
+  Options options_;
   std::exception_ptr eptr_;
 #ifdef _WIN32
   HANDLE handle_;
@@ -50,4 +50,39 @@ TEST(ThreadTest, Adder) {
   }
   EXPECT_EQ(n.load(), N * m);
 }
+
+#ifdef __linux__
+TEST(ThreadTest, Options) {
+  Thread::Options options;
+  options.affinity = 1;
+  options.policy = Thread::Options::Policy::kBatch;
+  options.nice = 5;
+  options.stack_size = 256 * 1024;
+  options.guard_size = 0;
+  size_t stack_size = 0, guard_size = 1;
+  int policy = -1, nice = 0;
+  bool pinned = false;
+  {
+    Thread t(
+        [&]() {
+          pthread_attr_t attr;
+          pthread_getattr_np(pthread_self(), &attr);
+          pthread_attr_getstacksize(&attr, &stack_size);
+          pthread_attr_getguardsize(&attr, &guard_size);
+          pthread_attr_destroy(&attr);
+          cpu_set_t set;
+          sched_getaffinity(0, sizeof(set), &set);
+          pinned = CPU_COUNT(&set) == 1 && CPU_ISSET(0, &set);
+          policy = sched_getscheduler(0);
+          nice = getpriority(PRIO_PROCESS, 0);
+        },
+        "Options", options);
+  }
+  EXPECT_EQ(stack_size, 256u * 1024);
+  EXPECT_EQ(guard_size, 0u);
+  EXPECT_TRUE(pinned);
+  EXPECT_EQ(policy, SCHED_BATCH);
+  EXPECT_EQ(nice, 5);
+}
+#endif
 }  // namespace TX
@@ -1,4 +1,7 @@
 #include "TX/Time.h"
+
+#include <thread>
+
 #include "gtest/gtest.h"
 
 namespace TX {
@@ -74,4 +77,42 @@ TEST(TimeTest, Arithmetic) {
   t2 = t1 + 1_s;
   EXPECT_EQ(t2 - t1, 1_s);
 }
+
+TEST(TimeTest, FastClock) {
+  const auto nanos = [](const Clock::TimePoint tp) {
+    return tp.sec * 1000000000 + tp.nsec;
+  };
+  int64_t last = nanos(Clock::Fast());
+  for (int i = 0; i < 1000; i++) {
+    const int64_t now = nanos(Clock::Fast());
+    EXPECT_GE(now, last);
+    last = now;
+  }
+  // Calibrated against Monotonic, or coarse by a scheduler tick at most.
+  EXPECT_NEAR(static_cast<double>(nanos(Clock::Fast())),
+              static_cast<double>(nanos(Clock::Monotonic())), 20e6)
+      << Clock::FastSource();
+
+  const Time start = Time::FastNow();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const Duration elapsed = Time::FastNow() - start;
+  EXPECT_GE(elapsed, 40_ms);
+  EXPECT_LT(elapsed, 1_s);
+  EXPECT_NEAR(static_cast<double>(Time::FastNow().UnixNano()),
+              static_cast<double>(Time::Now().UnixNano()), 20e6);
+}
+
+TEST(TimeTest, FastClockCalibration) {
+  // Switching from the coarse clock to the TSC does not go back in time.
+  const auto nanos = [](const Clock::TimePoint tp) {
+    return tp.sec * 1000000000 + tp.nsec;
+  };
+  const int64_t before = nanos(Clock::Fast());
+  Clock::Calibrate(true);
+  const int64_t after = nanos(Clock::Fast());
+  EXPECT_GE(after, before);
+  EXPECT_NEAR(static_cast<double>(after),
+              static_cast<double>(nanos(Clock::Monotonic())), 20e6)
+      << Clock::FastSource();
+}
 }  // namespace TX
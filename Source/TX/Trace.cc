@@ -0,0 +1,248 @@
+#include "TX/Trace.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "TX/Mutex.h"
+#include "TX/Ref.h"
+
+namespace TX {
+namespace {
+struct Event {
+  uint32 name;
+  int64_t start;
+  int64_t end;
+};
+}  // namespace
+
+// The spans of one thread. Only that thread pushes, any thread reads. A
+// reader copies the spans out, then leaves out the ones the writer may have
+// overwritten meanwhile, as a seqlock would.
+class Tracer::Ring final : public AtomicRefCounted<Ring> {
+ public:
+  Ring(const uint64 id, std::string name)
+      : id_(id), name_(std::move(name)), closed_(false), first_(0), head_(0) {}
+
+  void Push(const uint32 name, const int64_t start, const int64_t end) {
+    const uint64 head = head_.load(std::memory_order_relaxed);
+    Slot &slot = slots_[head & (kRingSize - 1)];
+    // Orders the previous head before the stores below, see Read.
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  void Read(std::vector<Event> &events) const {
+    const uint64 head = head_.load(std::memory_order_acquire);
+    const uint64 first = std::max(head > kRingSize ? head - kRingSize : 0,
+                                  first_.load(std::memory_order_relaxed));
+    const size_t at = events.size();
+    for (uint64 i = first; i < head; i++) {
+      const Slot &slot = slots_[i & (kRingSize - 1)];
+      events.push_back({slot.name.load(std::memory_order_relaxed),
+                        slot.start.load(std::memory_order_relaxed),
+                        slot.end.load(std::memory_order_relaxed)});
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // The writer may be storing span `now`, over span `now` - kRingSize.
+    const uint64 now = head_.load(std::memory_order_relaxed);
+    const uint64 torn = now + 1 > kRingSize ? now + 1 - kRingSize : 0;
+    if (torn > first) {
+      events.erase(events.begin() + at,
+                   events.begin() + at +
+                       static_cast<ptrdiff_t>(std::min(torn, head) - first));
+    }
+  }
+
+  void Clear() {
+    first_.store(head_.load(std::memory_order_acquire),
+                 std::memory_order_relaxed);
+  }
+
+  TX_NODISCARD uint64 Id() const { return id_; }
+  TX_NODISCARD const std::string &Name() const { return name_; }
+
+  void Close() { closed_.store(true, std::memory_order_release); }
+  TX_NODISCARD bool IsClosed() const {
+    return closed_.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<uint32> name{0};
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> end{0};
+  };
+
+  const uint64 id_;
+  const std::string name_;
+  std::atomic<bool> closed_;
+  std::atomic<uint64> first_;
+  alignas(TX_CACHE_LINE_SIZE) std::atomic<uint64> head_;
+  Slot slots_[kRingSize];
+};
+
+namespace {
+struct Names {
+  std::unordered_map<std::string, uint32> ids;
+  std::vector<std::string> names;
+};
+
+Mutex<Names> gNames;
+Mutex<std::vector<Ref<Tracer::Ring>>> gRings;
+std::atomic<uint64> gNextRingId = 1;
+
+std::string currentThreadName() {
+#ifdef _WIN32
+  return "";
+#else
+  char name[64] = {};
+  pthread_getname_np(pthread_self(), name, sizeof(name));
+  return name;
+#endif
+}
+
+struct LocalRing {
+  Tracer::Ring *ring = nullptr;
+  ~LocalRing();
+};
+
+thread_local LocalRing localRing;
+// Set once the thread's LocalRing is gone, spans of later thread_local
+// destructors are not recorded.
+thread_local bool localRingExited = false;
+
+LocalRing::~LocalRing() {
+  if (ring) {
+    ring->Close();
+    ring->deref();
+  }
+  localRingExited = true;
+}
+
+Tracer::Ring *ring() {
+  if (TX_LIKELY(localRing.ring)) return localRing.ring;
+  if (localRingExited) return nullptr;
+  auto *ring = new Tracer::Ring(
+      gNextRingId.fetch_add(1, std::memory_order_relaxed),
+      currentThreadName());
+  gRings.Lock()->push_back(adoptRef(*ring));
+  localRing.ring = ref(ring);
+  return ring;
+}
+
+void appendEscaped(std::string &out, const std::string_view s) {
+  for (const char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      out += c;
+    }
+  }
+}
+
+void appendNumber(std::string &out, const int64_t n) {
+  char buf[24];
+  const auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), n);
+  out.append(buf, end);
+}
+
+// Trace-event times are in microseconds.
+void appendMicros(std::string &out, const int64_t ns) {
+  appendNumber(out, ns / 1000);
+  out += '.';
+  const int64_t frac = ns % 1000;
+  if (frac < 100) out += '0';
+  if (frac < 10) out += '0';
+  appendNumber(out, frac);
+}
+
+int64_t processId() {
+#ifdef _WIN32
+  return static_cast<int64_t>(GetCurrentProcessId());
+#else
+  return getpid();
+#endif
+}
+}  // namespace
+
+uint32 Tracer::Intern(const std::string_view name) {
+  auto names = gNames.Lock();
+  const auto [it, inserted] = names->ids.try_emplace(
+      std::string(name), static_cast<uint32>(names->names.size()));
+  if (inserted) names->names.emplace_back(name);
+  return it->second;
+}
+
+int64_t Tracer::Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void Tracer::Record(const uint32 name, const int64_t start,
+                    const int64_t end) {
+  if (Ring *ring = TX::ring()) ring->Push(name, start, end);
+}
+
+std::string Tracer::ExportChromeJSON() {
+  std::vector<Ref<Ring>> rings = *gRings.Lock();
+  const int64_t pid = processId();
+  std::string out = R"({"displayTimeUnit":"ns","traceEvents":[)";
+  bool first = true;
+  const auto begin = [&](const std::string_view name) {
+    if (!first) out += ',';
+    first = false;
+    out += R"({"name":")";
+    appendEscaped(out, name);
+    out += R"(","pid":)";
+    appendNumber(out, pid);
+  };
+  std::vector<Event> events;
+  for (Ref<Ring> &ring : rings) {
+    events.clear();
+    ring->Read(events);
+    if (events.empty()) continue;
+    begin("thread_name");
+    out += R"(,"tid":)";
+    appendNumber(out, static_cast<int64_t>(ring->Id()));
+    out += R"(,"ph":"M","args":{"name":")";
+    appendEscaped(out, ring->Name().empty() ? "thread " +
+                                                  std::to_string(ring->Id())
+                                            : ring->Name());
+    out += R"("}})";
+    auto names = gNames.Lock();
+    for (const Event &event : events) {
+      begin(event.name < names->names.size() ? names->names[event.name] : "");
+      out += R"(,"tid":)";
+      appendNumber(out, static_cast<int64_t>(ring->Id()));
+      out += R"(,"ph":"X","ts":)";
+      appendMicros(out, event.start);
+      out += R"(,"dur":)";
+      appendMicros(out, event.end - event.start);
+      out += '}';
+    }
+  }
+  out += "]}";
+  return out;
+}
+
+void Tracer::Clear() {
+  auto rings = gRings.Lock();
+  std::erase_if(*rings, [](Ref<Ring> &ring) { return ring->IsClosed(); });
+  for (Ref<Ring> &ring : *rings) ring->Clear();
+}
+}  // namespace TX
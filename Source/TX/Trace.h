@@ -1,49 +1,96 @@
 #pragma once
-#include <stack>
+#include <atomic>
 #include <string>
+#include <string_view>
 
-#include "TX/Assert.h"
-#include "TX/Time.h"
+#include "TX/Bits.h"
+#include "TX/Memory.h"
+#include "TX/Platform.h"
 
 namespace TX {
-struct Trace {
-  std::string key;
-  Time start;
-  Duration elapse;
+// Records spans of time into a ring buffer per thread, and exports them in
+// the Chrome trace-event format, which chrome://tracing and Perfetto open.
+// A ring keeps the last kRingSize - 1 spans of its thread. Recording is off
+// until Enable, and then costs two clock reads and a few stores per span.
+//
+// Trace points are compiled in with ENABLE_TRACE (TK_ENABLE_TRACE):
+//
+//   void RunLoop::DoTimers() {
+//     TX_TRACE_SPAN("RunLoop::DoTimers");
+//     ...
+//   }
+class Tracer {
+ public:
+  static constexpr size_t kRingSize = 4096;
+
+  class Ring;
+
+  static void Enable(const bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+  TX_NODISCARD static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the id of `name`, the same for equal names.
+  static uint32 Intern(std::string_view name);
+  // Nanoseconds of a monotonic clock.
+  static int64_t Now();
+  // Records a span of the current thread.
+  static void Record(uint32 name, int64_t start, int64_t end);
+
+  // The recorded spans of all threads as a trace-event JSON object.
+  static std::string ExportChromeJSON();
+  // Forgets the recorded spans.
+  static void Clear();
+
+ private:
+  static inline std::atomic<bool> enabled_{false};
+};
+
+// A span that is recorded when it ends, on the thread that ends it. It does
+// nothing if tracing was off when it began.
+class TraceSpan {
+ public:
+  TraceSpan() = default;
+  explicit TraceSpan(const uint32 name) { Begin(name); }
+  ~TraceSpan() { End(); }
+  TX_DISALLOW_COPY(TraceSpan)
+
+  // Ends the span in progress, if any, and begins another.
+  void Begin(const uint32 name) {
+    End();
+    if (!Tracer::IsEnabled()) return;
+    name_ = name;
+    start_ = Tracer::Now();
+  }
+  void End() {
+    if (!start_) return;
+    Tracer::Record(name_, start_, Tracer::Now());
+    start_ = 0;
+  }
+
+ private:
+  uint32 name_ = 0;
+  int64_t start_ = 0;
 };
-static thread_local std::stack<Trace> gTraceStack;
-inline bool GlobalTraceStackEmpty() { return gTraceStack.empty(); }
-inline void GlobalTraceStackPush(const Trace &t) { gTraceStack.push(t); }
-inline void GlobalTraceStackPop() { gTraceStack.pop(); }
-inline Trace &GlobalTraceStackTop() { return gTraceStack.top(); }
 }  // namespace TX
 
 #if defined(ENABLE_TRACE)
-#define TX_TRACE_START(k)                     \
-  do {                                        \
-    TX::Trace trace;                          \
-    trace.key = k;                            \
-    trace.start = TX::Time::Now();            \
-    TX::GlobalTraceStackPush(trace);          \
-    TX_TRACE("START(%s)", trace.key.c_str()); \
-  } while (0)
-#define TX_TRACE_SPAN                                      \
-  do {                                                     \
-    if (TX::GlobalTraceStackEmpty()) break;                \
-    TX::Trace &trace = TX::GlobalTraceStackTop();          \
-    trace.elapse = TX::Time::Since(trace.start);           \
-    TX_TRACE("SPAN(%s) elapse: %lf ms", trace.key.c_str(), \
-             static_cast<double>(trace.elapse) / 1000000); \
-  } while (0)
-#define TX_TRACE_END                             \
-  do {                                           \
-    TX::Trace trace = TX::GlobalTraceStackTop(); \
-    TX_TRACE_SPAN;                               \
-    TX_TRACE("END(%s)", trace.key.c_str());      \
-    TX::GlobalTraceStackPop();                   \
-  } while (0)
+// The interned id of a string literal, looked up once per call site.
+#define TX_TRACE_NAME(name)                                          \
+  ([]() {                                                            \
+    static const TX::uint32 txTraceName = TX::Tracer::Intern(name);  \
+    return txTraceName;                                              \
+  }())
+// Traces the rest of the enclosing scope.
+#define TX_TRACE_SPAN(name) \
+  TX::TraceSpan TX_UNIQUE_NAME(txTraceSpan)(TX_TRACE_NAME(name))
+// Begin and end a TX::TraceSpan that outlives a scope.
+#define TX_TRACE_BEGIN(span, name) (span).Begin(TX_TRACE_NAME(name))
+#define TX_TRACE_END(span) (span).End()
 #else
-#define TX_TRACE_START(k)
-#define TX_TRACE_SPAN
-#define TX_TRACE_END
-#endif  // namespace TX
+#define TX_TRACE_SPAN(name) ((void)0)
+#define TX_TRACE_BEGIN(span, name) ((void)0)
+#define TX_TRACE_END(span) ((void)0)
+#endif  // defined(ENABLE_TRACE)
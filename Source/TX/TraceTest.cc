@@ -1,18 +1,102 @@
 #include "TX/Trace.h"
+
+#include <string>
+
+#include "TX/Thread.h"
 #include "gtest/gtest.h"
 
 namespace TX {
-TEST(TraceTest, Trace) {
-  TX_TRACE_START("A");
-  usleep(1000);
-  TX_TRACE_SPAN;
-  TX_TRACE_START("A1");
-  usleep(1000);
-  TX_TRACE_SPAN;
-  TX_TRACE_END;
-  usleep(1000);
-  TX_TRACE_SPAN;
-  usleep(1000);
-  TX_TRACE_END;
+namespace {
+size_t count(const std::string &s, const std::string &what) {
+  size_t n = 0;
+  for (size_t at = s.find(what); at != std::string::npos;
+       at = s.find(what, at + 1)) {
+    n++;
+  }
+  return n;
+}
+}  // namespace
+
+class TraceTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    Tracer::Clear();
+    Tracer::Enable(true);
+  }
+  void TearDown() override {
+    Tracer::Enable(false);
+    Tracer::Clear();
+  }
+};
+
+TEST_F(TraceTest, Intern) {
+  const uint32 a = Tracer::Intern("TraceTest.A");
+  EXPECT_EQ(Tracer::Intern("TraceTest.A"), a);
+  EXPECT_NE(Tracer::Intern("TraceTest.B"), a);
+}
+
+TEST_F(TraceTest, Span) {
+  {
+    TraceSpan span(Tracer::Intern("TraceTest.Span"));
+    TraceSpan nested(Tracer::Intern("TraceTest.Nested"));
+  }
+  const std::string json = Tracer::ExportChromeJSON();
+  EXPECT_TRUE(json.starts_with("{")) << json;
+  EXPECT_TRUE(json.ends_with("]}")) << json;
+  EXPECT_EQ(count(json, R"("name":"TraceTest.Span")"), 1u) << json;
+  EXPECT_EQ(count(json, R"("name":"TraceTest.Nested")"), 1u) << json;
+  EXPECT_EQ(count(json, R"("ph":"X")"), 2u) << json;
+  EXPECT_EQ(count(json, R"("ph":"M")"), 1u) << json;
+}
+
+TEST_F(TraceTest, Disabled) {
+  Tracer::Enable(false);
+  { TraceSpan span(Tracer::Intern("TraceTest.Disabled")); }
+  EXPECT_EQ(count(Tracer::ExportChromeJSON(), "TraceTest.Disabled"), 0u);
+}
+
+TEST_F(TraceTest, BeginEnd) {
+  TraceSpan span;
+  span.Begin(Tracer::Intern("TraceTest.First"));
+  span.Begin(Tracer::Intern("TraceTest.Second"));
+  span.End();
+  span.End();
+  const std::string json = Tracer::ExportChromeJSON();
+  EXPECT_EQ(count(json, R"("ph":"X")"), 2u) << json;
+}
+
+TEST_F(TraceTest, RingKeepsTheLatest) {
+  const uint32 name = Tracer::Intern("TraceTest.Ring");
+  for (size_t i = 0; i < Tracer::kRingSize + 10; i++) {
+    Tracer::Record(name, static_cast<int64_t>(i) * 1000,
+                   static_cast<int64_t>(i) * 1000 + 1);
+  }
+  const std::string json = Tracer::ExportChromeJSON();
+  // The oldest slot is left out, it is the next one to be overwritten.
+  EXPECT_EQ(count(json, "TraceTest.Ring"), Tracer::kRingSize - 1);
+  EXPECT_EQ(count(json, R"("ts":10.000)"), 0u);
+  EXPECT_EQ(count(json, R"("ts":11.000)"), 1u);
+  EXPECT_EQ(count(json, R"("ts":)" + std::to_string(Tracer::kRingSize + 9) +
+                            ".000"),
+            1u);
+}
+
+TEST_F(TraceTest, Threads) {
+  const uint32 name = Tracer::Intern("TraceTest.Thread");
+  {
+    Own<Thread> a = Thread::Spawn([&]() { TraceSpan span(name); }, "TraceA");
+    Own<Thread> b = Thread::Spawn([&]() { TraceSpan span(name); }, "TraceB");
+  }
+  const std::string json = Tracer::ExportChromeJSON();
+  EXPECT_EQ(count(json, "TraceTest.Thread"), 2u) << json;
+  EXPECT_EQ(count(json, R"("args":{"name":"TraceA"})"), 1u) << json;
+  EXPECT_EQ(count(json, R"("args":{"name":"TraceB"})"), 1u) << json;
+}
+
+#if defined(ENABLE_TRACE)
+TEST_F(TraceTest, Macros) {
+  { TX_TRACE_SPAN("TraceTest.Macro"); }
+  EXPECT_EQ(count(Tracer::ExportChromeJSON(), "TraceTest.Macro"), 1u);
 }
+#endif  // defined(ENABLE_TRACE)
 }  // namespace TX
@@ -1,26 +1,52 @@
 #pragma once
-#include "TX/Condvar.h"
-#include "TX/Mutex.h"
+#include <atomic>
+
+#include "TX/Assert.h"
+#include "TX/Bits.h"
+#include "TX/Futex.h"
+#include "TX/Memory.h"
+#include "TX/Time.h"
 
 namespace TX {
+// Waits for a number of jobs to finish. The count is a futex word: Add and
+// Done are a single atomic operation, and the Done that brings the count to
+// zero wakes every waiter.
 class WaitGroup {
  public:
   explicit WaitGroup() : count_(0) {}
   explicit WaitGroup(const int n) : count_(0) { Add(n); }
-  void Add(const int n) { (*count_.Lock()) += n; }
+  TX_DISALLOW_COPY(WaitGroup)
+
+  void Add(const int n) {
+    const uint32 previous =
+        count_.fetch_add(static_cast<uint32>(n), std::memory_order_relaxed);
+    TX_ASSERT(static_cast<int32_t>(previous + static_cast<uint32>(n)) >= 0,
+              "WaitGroup count went negative");
+  }
   void Done() {
-    (*count_.Lock())--;
-    cond_.NotifyOne();
+    const uint32 previous = count_.fetch_sub(1, std::memory_order_acq_rel);
+    TX_ASSERT(previous > 0, "WaitGroup::Done called too many times");
+    if (previous == 1) Futex::WakeAll(count_);
   }
-  void Wait(const Duration& timeout = Duration::FOREVER) {
-    auto count_locked = count_.Lock();
-    while (*count_locked > 0) {
-      cond_.Wait(count_locked, timeout);
+
+  // Returns false if the timeout expired before the count dropped to zero.
+  bool Wait(const Duration &timeout = Duration::FOREVER) {
+    const bool forever = timeout == Duration::FOREVER;
+    const Time deadline = forever ? Time() : Time::After(timeout);
+    while (true) {
+      const uint32 count = count_.load(std::memory_order_acquire);
+      if (count == 0) return true;
+      if (forever) {
+        Futex::Wait(count_, count);
+        continue;
+      }
+      const Duration left = Time::Until(deadline);
+      if (left <= 0) return false;
+      Futex::Wait(count_, count, left);
     }
   }
 
  private:
-  Mutex<int> count_;
-  Condvar cond_;
+  std::atomic<uint32> count_;
 };
 }  // namespace TX
@@ -0,0 +1,45 @@
+#include "TX/WaitGroup.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "TX/Own.h"
+#include "TX/Thread.h"
+
+namespace TX {
+TEST(WaitGroupTest, ManyWaiters) {
+  constexpr int N = 4;
+  WaitGroup wg(N);
+  std::atomic<int> n_done = 0, n_woken = 0;
+  {
+    std::vector<Own<Thread>> threads;
+    // Several threads waiting at once must all be woken up.
+    for (int i = 0; i < 3; i++) {
+      threads.push_back(Thread::Spawn([&] {
+        wg.Wait();
+        EXPECT_EQ(n_done.load(), N);
+        n_woken++;
+      }));
+    }
+    for (int i = 0; i < N; i++) {
+      threads.push_back(Thread::Spawn([&] {
+        n_done++;
+        wg.Done();
+      }));
+    }
+  }
+  EXPECT_EQ(n_woken.load(), 3);
+}
+
+TEST(WaitGroupTest, Timeout) {
+  WaitGroup wg(1);
+  const Time start = Time::Now();
+  EXPECT_FALSE(wg.Wait(Duration::MilliSecond(20)));
+  EXPECT_GE(Time::Since(start).MilliSeconds(), 15);
+  wg.Done();
+  EXPECT_TRUE(wg.Wait(Duration::MilliSecond(20)));
+  EXPECT_TRUE(wg.Wait());
+}
+}  // namespace TX
@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "TX/Memory.h"
+#include "TX/Platform.h"
+#include "TX/Ref.h"
+
+namespace TX {
+// Like AtomicRefCounted, but without a vtable and with weak references. Strong
+// and weak counts share one atomic word, strong in the low half. All strong
+// references together hold one weak reference, so the last strong deref
+// destroys T and the last weak deref, possibly the same one, frees its memory.
+//
+// T is destroyed as T, so it should be final or have no derived classes that
+// add members. Use it with Ref<T>, RefPtr<T> and WeakRef<T> as usual.
+template <class T>
+class WeakRefCounted {
+ public:
+  WeakRefCounted() : counts_(kWeakOne) {}
+  TX_DISALLOW_COPY(WeakRefCounted)
+
+  void ref() { counts_.fetch_add(kStrongOne, std::memory_order_relaxed); }
+  void deref() {
+    const uint64_t old =
+        counts_.fetch_sub(kStrongOne, std::memory_order_acq_rel);
+    if ((old & kStrongMask) != kStrongOne) return;
+    T *t = static_cast<T *>(this);
+    t->~T();
+    // Without weak references none can show up anymore, so skip the second
+    // atomic. Otherwise the last weak reference frees the memory; the count
+    // word is still usable after ~T since ~WeakRefCounted does nothing.
+    if (old == kWeakOne + kStrongOne) {
+      deallocate(t);
+    } else {
+      weakDeref();
+    }
+  }
+  TX_NODISCARD unsigned refCount() const {
+    return counts_.load(std::memory_order_relaxed) & kStrongMask;
+  }
+
+  void weakRef() { counts_.fetch_add(kWeakOne, std::memory_order_relaxed); }
+  void weakDeref() {
+    if (counts_.fetch_sub(kWeakOne, std::memory_order_acq_rel) == kWeakOne) {
+      deallocate(static_cast<T *>(this));
+    }
+  }
+  // Takes a strong reference unless the last one is already gone.
+  TX_NODISCARD bool tryRef() {
+    uint64_t counts = counts_.load(std::memory_order_relaxed);
+    do {
+      if (!(counts & kStrongMask)) return false;
+    } while (!counts_.compare_exchange_weak(counts, counts + kStrongOne,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed));
+    return true;
+  }
+
+  static void adopted(WeakRefCounted *) {}
+
+ protected:
+  ~WeakRefCounted() = default;
+
+ private:
+  static constexpr uint64_t kStrongOne = 1;
+  static constexpr uint64_t kStrongMask = 0xFFFFFFFF;
+  static constexpr uint64_t kWeakOne = kStrongMask + 1;
+
+  static void deallocate(T *t) {
+    if constexpr (requires { T::operator delete(t, sizeof(T)); }) {
+      T::operator delete(t, sizeof(T));
+    } else if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(t, std::align_val_t(alignof(T)));
+    } else {
+      ::operator delete(t);
+    }
+  }
+
+  std::atomic<uint64_t> counts_;
+};
+
+// A reference that does not keep T alive. upgrade() gives a strong reference
+// if T still is, without taking a lock.
+template <class T>
+class WeakRef {
+ public:
+  WeakRef() : t_(nullptr) {}
+  WeakRef(const Ref<T> &t) /* NOLINT(*-explicit-constructor) */
+      : t_(weakRef(t.ptr())) {}
+  WeakRef(const RefPtr<T> &t) /* NOLINT(*-explicit-constructor) */
+      : t_(weakRef(t.get())) {}
+  WeakRef(const WeakRef &other) : t_(weakRef(other.t_)) {}
+  WeakRef(WeakRef &&other) noexcept : t_(std::exchange(other.t_, nullptr)) {}
+  ~WeakRef() { weakDeref(std::exchange(t_, nullptr)); }
+
+  WeakRef &operator=(const WeakRef &other) {
+    WeakRef copy = other;
+    swap(copy);
+    return *this;
+  }
+
+  WeakRef &operator=(WeakRef &&other) noexcept {
+    WeakRef move = std::move(other);
+    swap(move);
+    return *this;
+  }
+
+  TX_NODISCARD RefPtr<T> upgrade() const {
+    if (!t_ || !t_->tryRef()) return nullptr;
+    return RefPtr<T>(t_, AdoptTag());
+  }
+  // Whether T is gone. A false answer may be stale by the time it is used.
+  TX_NODISCARD bool expired() const { return !t_ || !t_->refCount(); }
+
+  void swap(WeakRef &other) noexcept { std::swap(t_, other.t_); }
+
+ private:
+  static T *weakRef(T *t) {
+    if (t) t->weakRef();
+    return t;
+  }
+  static void weakDeref(T *t) {
+    if (t) t->weakDeref();
+  }
+
+  T *t_;
+};
+}  // namespace TX
@@ -0,0 +1,92 @@
+#include "TX/WeakRef.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include "TX/Thread.h"
+
+namespace TX {
+namespace {
+struct Node final : WeakRefCounted<Node> {
+  static inline int live = 0;
+  static inline int freed = 0;
+  Node() { live++; }
+  ~Node() { live--; }
+  static void *operator new(const size_t size) {
+    return ::operator new(size);
+  }
+  static void operator delete(void *p, const size_t) {
+    freed++;
+    ::operator delete(p);
+  }
+  WeakRef<Node> parent;
+  RefPtr<Node> child;
+};
+
+struct Counter final : WeakRefCounted<Counter> {
+  int n = 0;
+};
+}  // namespace
+
+struct WeakRefTest : testing::Test {
+  void SetUp() override { Node::live = Node::freed = 0; }
+};
+
+TEST_F(WeakRefTest, NoVtable) {
+  static_assert(!std::is_polymorphic_v<Counter>);
+  EXPECT_EQ(sizeof(Counter), 2 * sizeof(uint64_t));
+}
+
+TEST_F(WeakRefTest, Upgrade) {
+  WeakRef<Node> weak;
+  EXPECT_EQ(weak.upgrade(), nullptr);
+  {
+    Ref node = adoptRef(*new Node);
+    weak = node;
+    EXPECT_FALSE(weak.expired());
+    RefPtr<Node> strong = weak.upgrade();
+    EXPECT_EQ(strong.get(), node.ptr());
+    EXPECT_EQ(node->refCount(), 2);
+  }
+  // Destroyed, but the memory stays until the weak reference goes.
+  EXPECT_EQ(Node::live, 0);
+  EXPECT_EQ(Node::freed, 0);
+  EXPECT_TRUE(weak.expired());
+  EXPECT_EQ(weak.upgrade(), nullptr);
+  weak = WeakRef<Node>();
+  EXPECT_EQ(Node::freed, 1);
+}
+
+TEST_F(WeakRefTest, NoWeakRefs) {
+  { Ref node = adoptRef(*new Node); }
+  EXPECT_EQ(Node::live, 0);
+  EXPECT_EQ(Node::freed, 1);
+}
+
+TEST_F(WeakRefTest, BreaksCycle) {
+  {
+    Ref parent = adoptRef(*new Node);
+    parent->child = adoptRef(new Node);
+    parent->child->parent = parent;
+  }
+  EXPECT_EQ(Node::live, 0);
+  EXPECT_EQ(Node::freed, 2);
+}
+
+TEST_F(WeakRefTest, UpgradeRacesDeref) {
+  for (int i = 0; i < 1000; i++) {
+    RefPtr<Counter> strong = adoptRef(new Counter);
+    WeakRef<Counter> weak = strong;
+    std::atomic<bool> go = false;
+    Thread t([&]() {
+      while (!go) {
+      }
+      if (RefPtr<Counter> c = weak.upgrade()) c->n++;
+    });
+    go = true;
+    strong = nullptr;
+  }
+}
+}  // namespace TX
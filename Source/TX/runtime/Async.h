@@ -1,8 +1,11 @@
 #pragma once
 #include "TX/Result.h"
+#include "TX/runtime/TaskLocal.h"
 #include <algorithm>
 #include <coroutine>
 #include <exception>
+#include <type_traits>
+#include <utility>
 
 namespace TX {
 template <class T> class Promise;
@@ -12,6 +15,7 @@ public:
   using Handle = std::coroutine_handle<promise_type>;
   using Output = T;
 
+  Async(Async &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
   ~Async() {
     if (handle_)
       handle_.destroy();
@@ -22,6 +26,9 @@ public:
   template <class PromiseType>
   Handle await_suspend(std::coroutine_handle<PromiseType> h) {
     handle_.promise().continuation_ = h;
+    // Children run on behalf of the same task as their parent.
+    if constexpr (std::is_base_of_v<TaskLocalContext, PromiseType>)
+      handle_.promise().SetTaskLocals(h.promise().GetTaskLocals());
     return handle_;
   }
 
@@ -31,15 +38,16 @@ private:
   Handle handle_;
 };
 
-template <class T> class Promise {
+template <class T> class Promise : public TaskLocalContext {
 public:
   Async<T> get_return_object() noexcept {
     return Async<T>(Async<T>::Handle::from_promise(*this));
   }
 
   struct InitialAwaiter {
+    Promise *promise;
     bool await_ready() noexcept { return false; }
-    void await_resume() noexcept {}
+    void await_resume() noexcept { promise->EnterTaskLocals(); }
     void await_suspend(std::coroutine_handle<> h) noexcept {}
   };
 
@@ -48,11 +56,37 @@ public:
     void await_resume() noexcept {}
     template <class PromiseType>
     auto await_suspend(std::coroutine_handle<PromiseType> h) noexcept {
+      h.promise().LeaveTaskLocals();
       return h.promise().continuation_;
     }
   };
 
-  InitialAwaiter initial_suspend() noexcept { return {}; }
+  // Wraps every co_await in the coroutine to switch task-locals around the
+  // suspension. The awaiter is held by reference, temporaries of a co_await
+  // expression live until it completes.
+  template <class A> struct TaskLocalAwaiter {
+    A &&inner;
+    Promise *promise;
+    bool left = false;
+    bool await_ready() { return inner.await_ready(); }
+    template <class PromiseType>
+    auto await_suspend(std::coroutine_handle<PromiseType> h) {
+      promise->LeaveTaskLocals();
+      left = true;
+      return inner.await_suspend(h);
+    }
+    decltype(auto) await_resume() {
+      if (left)
+        promise->EnterTaskLocals();
+      return inner.await_resume();
+    }
+  };
+
+  template <class A> TaskLocalAwaiter<A> await_transform(A &&a) noexcept {
+    return {std::forward<A>(a), this};
+  }
+
+  InitialAwaiter initial_suspend() noexcept { return {this}; }
   FinalAwaiter final_suspend() noexcept { return {}; }
   void return_value(T t) { value_ = std::move(t); }
   void unhandled_exception() { eptr_ = std::current_exception(); }
@@ -0,0 +1,77 @@
+#pragma once
+#include "TX/Option.h"
+#include "TX/runtime/AsyncSemaphore.h"
+
+namespace TX {
+template <class T>
+class AsyncMutexGuard;
+
+// The coroutine counterpart of TX::Mutex. Lock() suspends the awaiting
+// coroutine rather than the thread, so it can be held across co_await points
+// without stalling a runtime worker. Ownership is handed to waiters in FIFO
+// order.
+//
+//   AsyncMutex<int> n(0);
+//   auto guard = co_await n.Lock();
+//   (*guard)++;
+template <class T>
+class AsyncMutex {
+ public:
+  explicit AsyncMutex() : semaphore_(1) {}
+  explicit AsyncMutex(T &&t) : t_(std::move(t)), semaphore_(1) {}
+  TX_DISALLOW_COPY(AsyncMutex)
+
+  class LockAwaiter {
+   public:
+    bool await_ready() { return inner_.await_ready(); }
+    bool await_suspend(std::coroutine_handle<> h) {
+      return inner_.await_suspend(h);
+    }
+    AsyncMutexGuard<T> await_resume() {
+      return AsyncMutexGuard<T>(mutex_, inner_.await_resume());
+    }
+
+   private:
+    friend AsyncMutex;
+    explicit LockAwaiter(AsyncMutex *mutex)
+        : mutex_(mutex), inner_(mutex->semaphore_.Acquire()) {}
+
+    AsyncMutex *mutex_;
+    AsyncSemaphore::AcquireAwaiter inner_;
+  };
+
+  LockAwaiter Lock() { return LockAwaiter(this); }
+
+  Option<AsyncMutexGuard<T>> TryLock() {
+    TX_IF_SOME(permit, semaphore_.TryAcquire()) {
+      return AsyncMutexGuard<T>(this, std::move(permit));
+    }
+    return None;
+  }
+
+ private:
+  friend AsyncMutexGuard<T>;
+  T t_;
+  AsyncSemaphore semaphore_;
+};
+
+template <class T>
+class TX_NODISCARD AsyncMutexGuard {
+ public:
+  TX_DISALLOW_COPY(AsyncMutexGuard)
+  TX_DEFAULT_MOVE(AsyncMutexGuard)
+  ~AsyncMutexGuard() = default;
+
+  T &operator*() { return mutex_->t_; }
+  T *operator->() { return &mutex_->t_; }
+
+ private:
+  friend class AsyncMutex<T>;
+  explicit AsyncMutexGuard(AsyncMutex<T> *mutex, AsyncSemaphorePermit permit)
+      : mutex_(mutex), permit_(std::move(permit)) {}
+
+  AsyncMutex<T> *mutex_;
+  // Unlocks the mutex on destruction.
+  AsyncSemaphorePermit permit_;
+};
+}  // namespace TX
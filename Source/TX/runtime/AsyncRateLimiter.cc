@@ -0,0 +1,69 @@
+#include "TX/runtime/AsyncRateLimiter.h"
+
+#include <algorithm>
+
+namespace TX {
+AsyncRateLimiter::AsyncRateLimiter(const double rate, const uint64 burst,
+                                   const Duration period)
+    : Timer(period, period, kTimerRepeatAlways, "AsyncRateLimiter"),
+      rate_(rate),
+      burst_(burst) {
+  TX_ASSERT(rate > 0 && burst > 0, "rate(%lf), burst(%lu)", rate, burst);
+  auto shared = shared_.Lock();
+  // The bucket starts full.
+  shared->tokens = static_cast<double>(burst);
+  shared->last_refill = Time::Now();
+}
+
+AsyncRateLimiter::~AsyncRateLimiter() {
+  TX_ASSERT(shared_.Lock()->waiters.Empty());
+}
+
+void AsyncRateLimiter::refillLocked(MutexGuard<Shared> &shared,
+                                    const Time &now) const {
+  const Duration elapse = now - shared->last_refill;
+  if (elapse <= 0) return;
+  shared->tokens = std::min(static_cast<double>(burst_),
+                            shared->tokens + elapse.Seconds() * rate_);
+  shared->last_refill = now;
+}
+
+bool AsyncRateLimiter::TryAcquire(const uint64 tokens) {
+  auto shared = shared_.Lock();
+  if (!shared->waiters.Empty()) return false;
+  refillLocked(shared, Time::Now());
+  if (shared->tokens < static_cast<double>(tokens)) return false;
+  shared->tokens -= static_cast<double>(tokens);
+  return true;
+}
+
+bool AsyncRateLimiter::enqueue(AcquireAwaiter::Node *node) {
+  auto shared = shared_.Lock();
+  refillLocked(shared, Time::Now());
+  if (shared->waiters.Empty() &&
+      shared->tokens >= static_cast<double>(node->tokens)) {
+    shared->tokens -= static_cast<double>(node->tokens);
+    return false;
+  }
+  shared->waiters.PushBack(node);
+  return true;
+}
+
+void AsyncRateLimiter::Poll() {
+  WaitList ready;
+  {
+    auto shared = shared_.Lock();
+    if (shared->waiters.Empty()) return;
+    refillLocked(shared, Time::Now());
+    while (!shared->waiters.Empty()) {
+      const auto *node =
+          static_cast<AcquireAwaiter::Node *>(shared->waiters.Front());
+      const auto tokens = static_cast<double>(node->tokens);
+      if (tokens > shared->tokens) break;
+      shared->tokens -= tokens;
+      ready.PushBack(shared->waiters.PopFront());
+    }
+  }
+  ready.ResumeAll();
+}
+}  // namespace TX
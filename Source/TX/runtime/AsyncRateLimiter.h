@@ -0,0 +1,83 @@
+#pragma once
+#include <coroutine>
+
+#include "TX/Bits.h"
+#include "TX/Mutex.h"
+#include "TX/RunLoop.h"
+#include "TX/Time.h"
+#include "TX/runtime/Coop.h"
+#include "TX/runtime/WaitList.h"
+
+namespace TX {
+// A token-bucket rate limiter for coroutines. The bucket holds at most `burst`
+// tokens and is refilled at `rate` tokens per second. co_await Acquire(n)
+// completes at once if n tokens are in the bucket, otherwise the coroutine is
+// queued in FIFO order until the bucket has been refilled enough.
+//
+// Refilling is lazy: it happens on every Acquire and on Poll. Add the limiter
+// to a RunLoop as a timer to have queued coroutines resumed on that loop
+// every `period`.
+//
+//   AsyncRateLimiter limiter(100, 10);
+//   RunLoop::Current()->AddTimer(&limiter);
+//   co_await limiter.Acquire();
+class AsyncRateLimiter final : public RunLoop::Timer {
+ public:
+  explicit AsyncRateLimiter(double rate, uint64 burst,
+                            Duration period = Duration::MilliSecond(10));
+  ~AsyncRateLimiter() override;
+  TX_DISALLOW_COPY(AsyncRateLimiter)
+
+  class AcquireAwaiter {
+   public:
+    bool await_ready() {
+      return Coop::HasBudget() && limiter_->TryAcquire(node_.tokens) &&
+             Coop::Proceed();
+    }
+    bool await_suspend(const std::coroutine_handle<> h) {
+      node_.handle = h;
+      return limiter_->enqueue(&node_) || Coop::YieldIfExhausted(h);
+    }
+    void await_resume() {}
+
+   private:
+    friend AsyncRateLimiter;
+    explicit AcquireAwaiter(AsyncRateLimiter *limiter, const uint64 tokens)
+        : limiter_(limiter) {
+      node_.tokens = tokens;
+    }
+
+    AsyncRateLimiter *limiter_;
+    struct Node : WaitList::Node {
+      uint64 tokens = 0;
+    } node_;
+  };
+
+  // `tokens` must not be greater than `burst`, or the waiter would never be
+  // resumed.
+  AcquireAwaiter Acquire(const uint64 tokens = 1) {
+    TX_ASSERT(tokens <= burst_, "tokens(%lu) > burst(%lu)", tokens, burst_);
+    return AcquireAwaiter(this, tokens);
+  }
+
+  bool TryAcquire(uint64 tokens = 1);
+
+  // Refills the bucket and resumes the queued coroutines it can satisfy.
+  void Poll();
+
+  void OnTimeout(RunLoop &, RefPtr<RunLoop::Scope> &) override { Poll(); }
+
+ private:
+  struct Shared {
+    double tokens = 0;
+    Time last_refill;
+    WaitList waiters;
+  };
+  void refillLocked(MutexGuard<Shared> &shared, const Time &now) const;
+  bool enqueue(AcquireAwaiter::Node *node);
+
+  double rate_;
+  uint64 burst_;
+  Mutex<Shared> shared_;
+};
+}  // namespace TX
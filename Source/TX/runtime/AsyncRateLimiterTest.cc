@@ -0,0 +1,60 @@
+#include <unistd.h>
+
+#include "TX/runtime/AsyncRateLimiter.h"
+#include "TX/runtime/TestDetached.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+struct AsyncRateLimiterTest : testing::Test {
+  void TearDown() override { RunLoop::ClearGlobalContext(); }
+};
+
+TEST_F(AsyncRateLimiterTest, TryAcquire) {
+  AsyncRateLimiter limiter(100, 5);
+  for (int i = 0; i < 5; i++) EXPECT_TRUE(limiter.TryAcquire());
+  EXPECT_FALSE(limiter.TryAcquire());
+  usleep(30 * 1000);
+  // ~3 tokens have been refilled.
+  EXPECT_TRUE(limiter.TryAcquire(2));
+}
+
+TEST_F(AsyncRateLimiterTest, Poll) {
+  AsyncRateLimiter limiter(100, 2);
+  int n = 0;
+  auto worker = [&]() -> TestDetached {
+    co_await limiter.Acquire(2);
+    n++;
+  };
+  worker();
+  EXPECT_EQ(n, 1);
+  worker();
+  worker();
+  EXPECT_EQ(n, 1);
+  limiter.Poll();
+  EXPECT_EQ(n, 1);
+  usleep(25 * 1000);
+  limiter.Poll();
+  EXPECT_EQ(n, 2);
+  usleep(25 * 1000);
+  limiter.Poll();
+  EXPECT_EQ(n, 3);
+}
+
+TEST_F(AsyncRateLimiterTest, RunLoop) {
+  Ref<RunLoop> loop = RunLoop::Current();
+  AsyncRateLimiter limiter(1000, 1, 1_ms);
+  loop->AddTimer(&limiter);
+  int n = 0;
+  auto worker = [&]() -> TestDetached {
+    for (int i = 0; i < 20; i++) co_await limiter.Acquire();
+    n++;
+    loop->Stop();
+  };
+  const Time start = Time::Now();
+  worker();
+  EXPECT_EQ(loop->Run(UINT64_MAX, 1_s), RunLoop::Status::Stopped);
+  EXPECT_EQ(n, 1);
+  EXPECT_GE(Time::Since(start), 15_ms);
+  loop->RemoveTimer(&limiter);
+}
+}  // namespace TX
@@ -0,0 +1,41 @@
+#include "TX/runtime/AsyncSemaphore.h"
+
+namespace TX {
+bool AsyncSemaphore::tryAcquire(const uint32 permits) {
+  auto shared = shared_.Lock();
+  // Queued waiters go first, otherwise a stream of small acquires could
+  // starve a large one forever.
+  if (!shared->waiters.Empty() || shared->permits < permits) return false;
+  shared->permits -= permits;
+  return true;
+}
+
+bool AsyncSemaphore::enqueue(AcquireAwaiter::Node *node) {
+  auto shared = shared_.Lock();
+  // Permits may have been released between await_ready and await_suspend.
+  if (shared->waiters.Empty() && shared->permits >= node->permits) {
+    shared->permits -= node->permits;
+    return false;
+  }
+  shared->waiters.PushBack(node);
+  return true;
+}
+
+void AsyncSemaphore::Release(const uint32 permits) {
+  WaitList ready;
+  {
+    auto shared = shared_.Lock();
+    shared->permits += permits;
+    while (!shared->waiters.Empty()) {
+      auto *node =
+          static_cast<AcquireAwaiter::Node *>(shared->waiters.Front());
+      if (node->permits > shared->permits) break;
+      shared->permits -= node->permits;
+      ready.PushBack(shared->waiters.PopFront());
+    }
+  }
+  // Permits are handed over to the waiters before they are resumed, so no
+  // one can barge in between.
+  ready.ResumeAll();
+}
+}  // namespace TX
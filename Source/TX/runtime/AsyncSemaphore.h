@@ -0,0 +1,119 @@
+#pragma once
+#include <coroutine>
+
+#include "TX/Bits.h"
+#include "TX/Mutex.h"
+#include "TX/Option.h"
+#include "TX/runtime/Coop.h"
+#include "TX/runtime/WaitList.h"
+
+namespace TX {
+class AsyncSemaphore;
+
+// Returns its permits to the semaphore when destructed.
+class TX_NODISCARD AsyncSemaphorePermit {
+ public:
+  TX_DISALLOW_COPY(AsyncSemaphorePermit)
+  AsyncSemaphorePermit(AsyncSemaphorePermit &&other) noexcept
+      : semaphore_(std::exchange(other.semaphore_, nullptr)),
+        permits_(std::exchange(other.permits_, 0)) {}
+  AsyncSemaphorePermit &operator=(AsyncSemaphorePermit &&other) noexcept {
+    AsyncSemaphorePermit move = std::move(other);
+    std::swap(semaphore_, move.semaphore_);
+    std::swap(permits_, move.permits_);
+    return *this;
+  }
+  ~AsyncSemaphorePermit();
+
+  TX_NODISCARD uint32 Permits() const { return permits_; }
+
+  // Keeps the permits acquired forever, i.e. they won't be returned to the
+  // semaphore.
+  void Forget() {
+    semaphore_ = nullptr;
+    permits_ = 0;
+  }
+
+ private:
+  friend AsyncSemaphore;
+  explicit AsyncSemaphorePermit(AsyncSemaphore *semaphore,
+                                const uint32 permits)
+      : semaphore_(semaphore), permits_(permits) {}
+
+  AsyncSemaphore *semaphore_;
+  uint32 permits_;
+};
+
+// A FIFO-fair counting semaphore for coroutines. A waiter asking for more
+// permits than are available blocks all the waiters queued after it even if
+// they ask for fewer, so weighted acquires cannot be starved by small ones.
+//
+// Unlike TX::Mutex, a waiting coroutine suspends instead of blocking the
+// thread, and is resumed on the thread that releases the permits it waits
+// for.
+class AsyncSemaphore {
+ public:
+  explicit AsyncSemaphore(const uint32 permits) {
+    shared_.Lock()->permits = permits;
+  }
+  ~AsyncSemaphore() { TX_ASSERT(shared_.Lock()->waiters.Empty()); }
+  TX_DISALLOW_COPY(AsyncSemaphore)
+
+  class AcquireAwaiter {
+   public:
+    // Without coop budget left, permits are still taken at once but the
+    // coroutine yields to its scheduler before it gets them.
+    bool await_ready() {
+      return Coop::HasBudget() && semaphore_->tryAcquire(node_.permits) &&
+             Coop::Proceed();
+    }
+    bool await_suspend(const std::coroutine_handle<> h) {
+      node_.handle = h;
+      return semaphore_->enqueue(&node_) || Coop::YieldIfExhausted(h);
+    }
+    AsyncSemaphorePermit await_resume() {
+      return AsyncSemaphorePermit(semaphore_, node_.permits);
+    }
+
+   private:
+    friend AsyncSemaphore;
+    explicit AcquireAwaiter(AsyncSemaphore *semaphore, const uint32 permits)
+        : semaphore_(semaphore) {
+      node_.permits = permits;
+    }
+
+    AsyncSemaphore *semaphore_;
+    struct Node : WaitList::Node {
+      uint32 permits = 0;
+    } node_;
+  };
+
+  // co_await Acquire(n) suspends until n permits are available, and yields an
+  // AsyncSemaphorePermit holding them.
+  AcquireAwaiter Acquire(const uint32 permits = 1) {
+    return AcquireAwaiter(this, permits);
+  }
+
+  Option<AsyncSemaphorePermit> TryAcquire(const uint32 permits = 1) {
+    if (!tryAcquire(permits)) return None;
+    return AsyncSemaphorePermit(this, permits);
+  }
+
+  void Release(uint32 permits = 1);
+  TX_NODISCARD uint32 AvailablePermits() { return shared_.Lock()->permits; }
+
+ private:
+  bool tryAcquire(uint32 permits);
+  bool enqueue(AcquireAwaiter::Node *node);
+
+  struct Shared {
+    uint32 permits = 0;
+    WaitList waiters;
+  };
+  Mutex<Shared> shared_;
+};
+
+inline AsyncSemaphorePermit::~AsyncSemaphorePermit() {
+  if (semaphore_) semaphore_->Release(permits_);
+}
+}  // namespace TX
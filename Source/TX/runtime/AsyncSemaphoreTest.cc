@@ -0,0 +1,83 @@
+#include <vector>
+
+#include "TX/runtime/AsyncMutex.h"
+#include "TX/runtime/AsyncSemaphore.h"
+#include "TX/runtime/TestDetached.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+TEST(AsyncSemaphoreTest, TryAcquire) {
+  AsyncSemaphore sem(3);
+  {
+    auto p1 = sem.TryAcquire(2);
+    EXPECT_TRUE(p1.has_value());
+    EXPECT_EQ(sem.AvailablePermits(), 1);
+    EXPECT_FALSE(sem.TryAcquire(2).has_value());
+    auto p2 = sem.TryAcquire();
+    EXPECT_TRUE(p2.has_value());
+    EXPECT_EQ(sem.AvailablePermits(), 0);
+  }
+  EXPECT_EQ(sem.AvailablePermits(), 3);
+}
+
+TEST(AsyncSemaphoreTest, Fifo) {
+  AsyncSemaphore sem(0);
+  std::vector<int> order;
+  auto waiter = [&](const int id, const uint32 permits) -> TestDetached {
+    auto permit = co_await sem.Acquire(permits);
+    order.push_back(id);
+    permit.Forget();
+  };
+  waiter(1, 2);
+  waiter(2, 1);
+  waiter(3, 1);
+  EXPECT_TRUE(order.empty());
+  // The weighted waiter at the head blocks the smaller ones behind it.
+  sem.Release(1);
+  EXPECT_TRUE(order.empty());
+  sem.Release(1);
+  EXPECT_EQ(order, std::vector<int>({1}));
+  sem.Release(2);
+  EXPECT_EQ(order, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(sem.AvailablePermits(), 0);
+}
+
+TEST(AsyncSemaphoreTest, PermitRelease) {
+  AsyncSemaphore sem(1);
+  int n = 0;
+  auto worker = [&]() -> TestDetached {
+    auto permit = co_await sem.Acquire();
+    n++;
+  };
+  {
+    auto permit = sem.TryAcquire();
+    worker();
+    worker();
+    EXPECT_EQ(n, 0);
+  }
+  // Dropping the permit resumes the first worker, whose permit in turn
+  // resumes the second one.
+  EXPECT_EQ(n, 2);
+  EXPECT_EQ(sem.AvailablePermits(), 1);
+}
+
+TEST(AsyncMutexTest, Lock) {
+  AsyncMutex<std::vector<int>> mutex;
+  auto guard = mutex.TryLock();
+  EXPECT_TRUE(guard.has_value());
+  EXPECT_FALSE(mutex.TryLock().has_value());
+
+  auto pusher = [&](const int id) -> TestDetached {
+    auto g = co_await mutex.Lock();
+    g->push_back(id);
+  };
+  pusher(1);
+  pusher(2);
+  (*guard)->push_back(0);
+  guard.reset();
+
+  auto g = mutex.TryLock();
+  EXPECT_TRUE(g.has_value());
+  EXPECT_EQ(**g, std::vector<int>({0, 1, 2}));
+}
+}  // namespace TX
@@ -1,6 +1,7 @@
 #include "TX/runtime/BlockingPool.h"
 
 #include "TX/Thread.h"
+#include "TX/Trace.h"
 
 namespace TX {
 void BlockingPool::SpawnTask(const UnownedTask &task) {
@@ -10,7 +11,7 @@ void BlockingPool::SpawnTask(const UnownedTask &task) {
     if (shared->num_threads < max_threads_) {
       int id = shared->num_threads;
       shared->threads.insert(
-          {id, Thread::Spawn([this, id]() { RunWorker(id); })});
+          {id, Thread::Spawn([this, id]() { RunWorker(id); }, "", options_)});
       shared->num_threads++;
     }
   } else {
@@ -19,13 +20,22 @@ void BlockingPool::SpawnTask(const UnownedTask &task) {
 }
 
 void BlockingPool::RunWorker(int) {
+  WorkerMetrics &metrics = metrics_.Local();
   auto shared = shared_.Lock();
   while (true) {
     while (!shared->queue.empty()) {
       UnownedTask task = shared->queue.front();
       shared->queue.pop();
       drop(shared);
-      task.Run();
+      const Time start = Time::Now();
+      WorkerMetrics::Add(metrics.dequeued);
+      WorkerMetrics::Add(metrics.queue_wait_ns,
+                         (start - task.SpawnedAt()).NanoSeconds());
+      {
+        TX_TRACE_SPAN("BlockingPool::Task");
+        task.Run();
+      }
+      WorkerMetrics::Add(metrics.busy_ns, Time::Since(start).NanoSeconds());
       shared = shared_.Lock();
     }
 
@@ -41,14 +51,16 @@ void BlockingPool::RunWorker(int) {
     }
 
     shared->num_idle_threads++;
+    WorkerMetrics::Add(metrics.parks);
     cond_.Wait(shared);
+    WorkerMetrics::Add(metrics.unparks);
     shared->num_idle_threads--;
   }
 }
 
 void BlockingPool::Shutdown() {
+  std::vector<Own<Thread>> threads;
   {
-    std::vector<Own<Thread>> threads;
     auto shared = shared_.Lock();
     if (shared->shutdown) return;
     shared->shutdown = true;
@@ -60,4 +72,26 @@ void BlockingPool::Shutdown() {
   }
   cond_.NotifyAll();
 }
+
+RuntimeMetrics::BlockingPool BlockingPool::Metrics() {
+  RuntimeMetrics::BlockingPool m;
+  {
+    auto shared = shared_.Lock();
+    m.num_threads = shared->num_threads;
+    m.num_idle_threads = shared->num_idle_threads;
+    m.queue_depth = shared->queue.size();
+  }
+  auto load = [](const std::atomic<uint64> &counter) {
+    return counter.load(std::memory_order_relaxed);
+  };
+  metrics_.ForEach([&](const WorkerMetrics &w) {
+    m.parks += load(w.parks);
+    m.unparks += load(w.unparks);
+    m.dequeued += load(w.dequeued);
+    m.queue_wait += Duration::NanoSecond(
+        static_cast<int64_t>(load(w.queue_wait_ns)));
+    m.busy += Duration::NanoSecond(static_cast<int64_t>(load(w.busy_ns)));
+  });
+  return m;
+}
 }  // namespace TX
@@ -7,13 +7,19 @@
 #include "TX/Function.h"
 #include "TX/Mutex.h"
 #include "TX/Own.h"
+#include "TX/Pool.h"
 #include "TX/Thread.h"
+#include "TX/Time.h"
+#include "TX/runtime/RuntimeMetrics.h"
 #include "TX/runtime/Task.h"
 
 namespace TX {
 
+// Spawned once per blocking call, so they come from a pool. There is a
+// BlockingTask type per closure type, so they share pools by size.
 template <class F>
-class BlockingTask final : public Task {
+class BlockingTask final : public Task,
+                           public SizeClassPooled<BlockingTask<F>> {
  public:
   using R = ReturnType<F>;
   explicit BlockingTask(F f) : f_(std::move(f)) {}
@@ -33,25 +39,34 @@ class BlockingTask final : public Task {
 class UnownedTask {
  public:
   explicit UnownedTask(const Ref<Task> &task, const bool mandatory = true)
-      : task_(task), mandatory_(mandatory) {}
-  void Run() { task_->Run(); }
+      : task_(task), mandatory_(mandatory), spawned_at_(Time::Now()) {}
+  void Run() {
+    if (!task_->IsCancelled()) task_->Run();
+  }
   void Shutdown() {
     if (mandatory_) Run();
   }
+  TX_NODISCARD Time SpawnedAt() const { return spawned_at_; }
 
  private:
   Ref<Task> task_;
   bool mandatory_;
+  Time spawned_at_;
 };
 
 class BlockingPool {
  public:
-  explicit BlockingPool(const int max_threads) : max_threads_(max_threads) {}
+  // Every worker thread is spawned with `options`.
+  explicit BlockingPool(const int max_threads, Thread::Options options = {})
+      : max_threads_(max_threads), options_(std::move(options)) {}
   ~BlockingPool() { Shutdown(); }
 
   TX_DISALLOW_COPY(BlockingPool)
   void Shutdown();
 
+  // Counters summed over the worker threads.
+  RuntimeMetrics::BlockingPool Metrics();
+
   template <class F>
   Task::Handle<ReturnType<F>> Spawn(F f, const bool mandatory = true) {
     auto blocking_task = adoptRef(*new BlockingTask<F>(std::move(f)));
@@ -59,6 +74,17 @@ class BlockingPool {
     return Task::Handle<ReturnType<F>>(blocking_task);
   }
 
+  // Like Spawn, but the task is dropped if `token` is cancelled before a
+  // worker picks it up. `f` can poll the token to stop early once running.
+  template <class F>
+  Task::Handle<ReturnType<F>> Spawn(F f, const CancellationToken &token,
+                                    const bool mandatory = true) {
+    auto blocking_task = adoptRef(*new BlockingTask<F>(std::move(f)));
+    blocking_task->SetCancellationToken(token);
+    SpawnTask(UnownedTask(blocking_task, mandatory));
+    return Task::Handle<ReturnType<F>>(blocking_task);
+  }
+
   struct Shared {
     std::queue<UnownedTask> queue;
     std::unordered_map<int, Own<Thread>> threads;
@@ -74,7 +100,9 @@ class BlockingPool {
 
  private:
   int max_threads_;
+  Thread::Options options_;
   Condvar cond_;
   Mutex<Shared> shared_;
+  WorkerMetricsSet metrics_;
 };
 }  // namespace TX
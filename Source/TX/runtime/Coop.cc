@@ -0,0 +1,17 @@
+#include "TX/runtime/Coop.h"
+
+#include "TX/runtime/Scheduler.h"
+
+namespace TX {
+bool Coop::YieldIfExhausted(const std::coroutine_handle<> h) {
+  if (Proceed()) return false;
+  return YieldAwaiter::await_suspend(h);
+}
+
+bool Coop::YieldAwaiter::await_suspend(const std::coroutine_handle<> h) {
+  Scheduler *scheduler = Scheduler::TryCurrent();
+  if (!scheduler) return false;
+  scheduler->Wake(h);
+  return true;
+}
+}  // namespace TX
@@ -0,0 +1,78 @@
+#pragma once
+#include <coroutine>
+
+#include "TX/Bits.h"
+#include "TX/Memory.h"
+#include "TX/Platform.h"
+
+namespace TX {
+// Cooperative scheduling budget, in the style of tokio's coop module.
+//
+// A scheduler grants every task it resumes a budget of operations. Awaitables
+// spend one unit whenever they complete, and once the budget is exhausted
+// they force the task to yield back to the scheduler even if they could
+// complete at once. A task that keeps finding its data ready, e.g. reading a
+// fast loopback socket, can no longer starve the other tasks on its worker.
+//
+// Outside a scheduler, e.g. a coroutine resumed by hand, the budget is
+// unconstrained and awaitables never yield.
+class Coop {
+ public:
+  static constexpr uint32 kDefaultBudget = 128;
+  static constexpr uint32 kUnconstrained = UINT32_MAX;
+
+  // Sets the budget of the current thread for its lifetime.
+  class BudgetGuard {
+   public:
+    explicit BudgetGuard(const uint32 budget) : previous_(budget_) {
+      budget_ = budget;
+    }
+    ~BudgetGuard() { budget_ = previous_; }
+    TX_DISALLOW_COPY(BudgetGuard)
+
+   private:
+    uint32 previous_;
+  };
+
+  TX_NODISCARD static bool HasBudget() { return budget_ != 0; }
+  TX_NODISCARD static uint32 Budget() { return budget_; }
+
+  // Spends one unit of budget, returns false if there was none left.
+  static bool Proceed() {
+    if (budget_ == kUnconstrained) return true;
+    if (budget_ == 0) return false;
+    budget_--;
+    return true;
+  }
+
+  // For awaiters that completed without suspending. Returns true if `h`
+  // should be suspended because the budget ran out, in which case it has been
+  // handed back to the current scheduler to be resumed on its next turn.
+  static bool YieldIfExhausted(std::coroutine_handle<> h);
+
+  // co_await Coop::Yield() hands the task back to the current scheduler
+  // unconditionally, and is a no-op outside a scheduler.
+  struct YieldAwaiter {
+    static bool await_ready() { return false; }
+    static bool await_suspend(std::coroutine_handle<> h);
+    static void await_resume() {}
+  };
+  static YieldAwaiter Yield() { return {}; }
+
+  // co_await Coop::Consume() spends one unit of budget and yields if there
+  // is none left. Loops that never await anything else should use it.
+  struct ConsumeAwaiter {
+    static bool await_ready() { return Proceed(); }
+    static bool await_suspend(const std::coroutine_handle<> h) {
+      return YieldAwaiter::await_suspend(h);
+    }
+    static void await_resume() {}
+  };
+  static ConsumeAwaiter Consume() { return {}; }
+
+ private:
+  static thread_local uint32 budget_;
+};
+
+inline thread_local uint32 Coop::budget_ = Coop::kUnconstrained;
+}  // namespace TX
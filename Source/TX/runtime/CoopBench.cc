@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "TX/runtime/AsyncSemaphore.h"
+#include "TX/runtime/SingleThreadScheduler.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+// A latency-sensitive task shares a scheduler with bulk tasks whose acquires
+// always complete at once. Reports how long the latency-sensitive task waits
+// to be resumed after yielding, with and without a coop budget.
+class CoopBench : public testing::TestWithParam<uint32> {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  static constexpr int kBulkTasks = 4;
+  static constexpr int kBulkAcquires = 2000;
+  static constexpr int kSamples = 2000;
+
+  CoopBench() : pool_(1), scheduler_(pool_), semaphore_(kBulkTasks) {}
+
+  Async<int> bulk() {
+    while (!done_) {
+      for (int i = 0; i < kBulkAcquires; i++) co_await semaphore_.Acquire();
+      co_await Coop::Yield();
+    }
+    co_return 0;
+  }
+
+  Async<int> latency() {
+    for (int i = 0; i < kSamples; i++) {
+      const Clock::time_point start = Clock::now();
+      co_await Coop::Yield();
+      samples_.push_back(Clock::now() - start);
+    }
+    done_ = true;
+    co_return 0;
+  }
+
+  BlockingPool pool_;
+  SingleThreadScheduler scheduler_;
+  AsyncSemaphore semaphore_;
+  std::vector<Clock::duration> samples_;
+  bool done_ = false;
+};
+
+TEST_P(CoopBench, Fairness) {
+  scheduler_.SetCoopBudget(GetParam());
+  for (int i = 0; i < kBulkTasks; i++) scheduler_.Spawn(bulk());
+  scheduler_.Spawn(latency());
+  const Clock::time_point start = Clock::now();
+  while (scheduler_.Schedule(64) > 0) {
+  }
+  const auto elapsed = Clock::now() - start;
+
+  std::sort(samples_.begin(), samples_.end());
+  auto us = [](const Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+  };
+  std::printf("budget %10u: p50 %9.1fus p99 %9.1fus max %9.1fus total %.1fms\n",
+              GetParam(), us(samples_[samples_.size() / 2]),
+              us(samples_[samples_.size() * 99 / 100]), us(samples_.back()),
+              us(elapsed) / 1000);
+}
+
+INSTANTIATE_TEST_SUITE_P(Budget, CoopBench,
+                         testing::Values(Coop::kUnconstrained,
+                                         Coop::kDefaultBudget, 32u));
+}  // namespace TX
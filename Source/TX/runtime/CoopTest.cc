@@ -0,0 +1,98 @@
+#include "TX/runtime/Coop.h"
+
+#include "TX/runtime/AsyncSemaphore.h"
+#include "TX/runtime/SingleThreadScheduler.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+TEST(CoopTest, Budget) {
+  EXPECT_EQ(Coop::Budget(), Coop::kUnconstrained);
+  EXPECT_TRUE(Coop::Proceed());
+  EXPECT_EQ(Coop::Budget(), Coop::kUnconstrained);
+  {
+    Coop::BudgetGuard guard(2);
+    EXPECT_TRUE(Coop::Proceed());
+    EXPECT_TRUE(Coop::Proceed());
+    EXPECT_FALSE(Coop::HasBudget());
+    EXPECT_FALSE(Coop::Proceed());
+  }
+  EXPECT_EQ(Coop::Budget(), Coop::kUnconstrained);
+}
+
+struct CoopSchedulerTest : testing::Test {
+  CoopSchedulerTest() : pool_(1), scheduler_(pool_), semaphore_(1) {}
+
+  // Acquires an always available permit `n` times.
+  Async<int> bulk(const int n) {
+    for (int i = 0; i < n; i++) {
+      co_await semaphore_.Acquire();
+      n_acquired_++;
+    }
+    co_return 0;
+  }
+
+  BlockingPool pool_;
+  SingleThreadScheduler scheduler_;
+  AsyncSemaphore semaphore_;
+  int n_acquired_ = 0;
+};
+
+TEST_F(CoopSchedulerTest, Unconstrained) {
+  scheduler_.SetCoopBudget(Coop::kUnconstrained);
+  scheduler_.Spawn(bulk(100));
+  EXPECT_EQ(scheduler_.Schedule(1), 1);
+  EXPECT_EQ(n_acquired_, 100);
+}
+
+TEST_F(CoopSchedulerTest, Yield) {
+  scheduler_.SetCoopBudget(8);
+  int n_other = 0;
+  scheduler_.Spawn(bulk(20));
+  // Coroutine lambdas must outlive their coroutines, which refer to the
+  // captures through the lambda.
+  auto other = [&]() -> Async<int> {
+    n_other++;
+    co_return 0;
+  };
+  scheduler_.Spawn(other());
+  // The bulk task runs out of budget and goes behind the other one.
+  EXPECT_EQ(scheduler_.Schedule(1), 1);
+  EXPECT_EQ(n_acquired_, 8);
+  EXPECT_EQ(scheduler_.Schedule(1), 1);
+  EXPECT_EQ(n_other, 1);
+  EXPECT_EQ(scheduler_.Schedule(1), 1);
+  EXPECT_EQ(n_acquired_, 17);
+  EXPECT_EQ(scheduler_.Schedule(8), 1);
+  EXPECT_EQ(n_acquired_, 20);
+  EXPECT_EQ(semaphore_.AvailablePermits(), 1);
+  EXPECT_EQ(scheduler_.Schedule(1), 0);
+}
+
+TEST_F(CoopSchedulerTest, Consume) {
+  scheduler_.SetCoopBudget(4);
+  int n = 0;
+  auto consume = [&]() -> Async<int> {
+    for (int i = 0; i < 10; i++) {
+      co_await Coop::Consume();
+      n++;
+    }
+    co_return 0;
+  };
+  scheduler_.Spawn(consume());
+  EXPECT_EQ(scheduler_.Schedule(1), 1);
+  EXPECT_EQ(n, 4);
+  // The task woken by its own yield waits for the next turn.
+  EXPECT_EQ(scheduler_.Schedule(3), 1);
+  EXPECT_EQ(n, 9);
+  EXPECT_EQ(scheduler_.Schedule(3), 1);
+  EXPECT_EQ(n, 10);
+}
+
+TEST_F(CoopSchedulerTest, OutsideScheduler) {
+  // A coroutine driven by hand never yields.
+  Coop::BudgetGuard guard(0);
+  Coop::YieldAwaiter yield;
+  EXPECT_FALSE(yield.await_suspend(std::noop_coroutine()));
+  EXPECT_FALSE(Coop::YieldIfExhausted(std::noop_coroutine()));
+}
+}  // namespace TX
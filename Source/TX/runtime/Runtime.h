@@ -22,6 +22,15 @@ class Runtime {
 
   Scheduler::EnterGuard Enter() { return scheduler_->Enter(); }
 
+  // A snapshot of the scheduler and blocking pool counters, cheap enough to
+  // be pulled periodically.
+  RuntimeMetrics Metrics() {
+    RuntimeMetrics metrics;
+    metrics.scheduler = scheduler_->Metrics();
+    metrics.blocking_pool = blocking_pool_.Metrics();
+    return metrics;
+  }
+
   template <class F>
   void BlockOn(F f) {}
 
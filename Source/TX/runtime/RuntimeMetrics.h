@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "TX/Bits.h"
+#include "TX/Mutex.h"
+#include "TX/Own.h"
+#include "TX/Thread.h"
+#include "TX/Time.h"
+
+namespace TX {
+// Counters of a single worker thread. Only the owning thread writes them, with
+// a relaxed load and store instead of a read-modify-write, so counting costs
+// about as much as a plain increment and workers never contend on a cache
+// line. Readers load them relaxed and aggregate on read, so a snapshot may be
+// slightly stale but each counter is monotonic.
+struct alignas(64) WorkerMetrics {
+  explicit WorkerMetrics() : thread_id(Thread::Current()) {}
+
+  static void Add(std::atomic<uint64> &counter, const uint64 n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+  }
+
+  const Thread::Id thread_id;
+  // Tasks resumed.
+  std::atomic<uint64> polls{0};
+  // Times the worker ran out of work, and times it found work again after.
+  std::atomic<uint64> parks{0};
+  std::atomic<uint64> unparks{0};
+  // Time spent running tasks.
+  std::atomic<uint64> busy_ns{0};
+  // BlockingPool only: tasks taken off the queue and the time they waited.
+  std::atomic<uint64> dequeued{0};
+  std::atomic<uint64> queue_wait_ns{0};
+
+  // Whether the last turn of the worker found no work, owner thread only.
+  bool parked = false;
+};
+
+// The workers of a scheduler or pool. Each thread lazily registers its own
+// WorkerMetrics on first use; the entries live as long as the set.
+class WorkerMetricsSet {
+ public:
+  explicit WorkerMetricsSet() : id_(nextId()) {}
+  TX_DISALLOW_COPY(WorkerMetricsSet)
+
+  // The calling thread's counters.
+  WorkerMetrics &Local() {
+    // Sets are told apart by id rather than address, which may be reused.
+    thread_local struct {
+      uint64 set_id;
+      WorkerMetrics *metrics;
+    } cache{0, nullptr};
+    if (cache.set_id != id_) {
+      cache.metrics = local();
+      cache.set_id = id_;
+    }
+    return *cache.metrics;
+  }
+
+  template <class F>
+  void ForEach(F f) {
+    auto workers = workers_.Lock();
+    for (Own<WorkerMetrics> &worker : *workers) f(*worker);
+  }
+
+ private:
+  static uint64 nextId() {
+    static std::atomic<uint64> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  WorkerMetrics *local() {
+    auto workers = workers_.Lock();
+    const Thread::Id current = Thread::Current();
+    for (Own<WorkerMetrics> &worker : *workers) {
+      if (worker->thread_id == current) return &*worker;
+    }
+    workers->push_back(Own<WorkerMetrics>(new WorkerMetrics));
+    return &*workers->back();
+  }
+
+  uint64 id_;
+  Mutex<std::vector<Own<WorkerMetrics>>> workers_;
+};
+
+// A point-in-time copy of the runtime's counters, see Runtime::Metrics.
+struct RuntimeMetrics {
+  struct Worker {
+    Thread::Id thread_id;
+    uint64 polls;
+    uint64 parks;
+    uint64 unparks;
+    Duration busy;
+  };
+
+  // The workers share the scheduler's ready queue, there are no per-worker
+  // queues to report or to steal from.
+  struct Scheduler {
+    std::vector<Worker> workers;
+    uint64 global_queue_depth = 0;
+    // Sums over the workers.
+    uint64 polls = 0;
+    uint64 parks = 0;
+    uint64 unparks = 0;
+    Duration busy;
+  };
+
+  struct BlockingPool {
+    uint64 num_threads = 0;
+    uint64 num_idle_threads = 0;
+    uint64 queue_depth = 0;
+    uint64 parks = 0;
+    uint64 unparks = 0;
+    uint64 dequeued = 0;
+    Duration queue_wait;
+    Duration busy;
+  };
+
+  Scheduler scheduler;
+  BlockingPool blocking_pool;
+};
+}  // namespace TX
@@ -0,0 +1,71 @@
+#include "TX/runtime/RuntimeMetrics.h"
+
+#include <unistd.h>
+
+#include "TX/runtime/SingleThreadScheduler.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+TEST(RuntimeMetricsTest, WorkerMetricsSet) {
+  WorkerMetricsSet set;
+  WorkerMetrics &local = set.Local();
+  EXPECT_EQ(&set.Local(), &local);
+  WorkerMetrics::Add(local.polls, 2);
+  {
+    BlockingPool pool(1);
+    pool.Spawn([&] { WorkerMetrics::Add(set.Local().polls); });
+  }
+  int n_workers = 0;
+  uint64 polls = 0;
+  set.ForEach([&](const WorkerMetrics &w) {
+    n_workers++;
+    polls += w.polls.load();
+  });
+  EXPECT_EQ(n_workers, 2);
+  EXPECT_EQ(polls, 3);
+  // Another set gets its own counters on the same thread.
+  WorkerMetricsSet other;
+  EXPECT_NE(&other.Local(), &local);
+  EXPECT_EQ(&set.Local(), &local);
+}
+
+TEST(RuntimeMetricsTest, Scheduler) {
+  BlockingPool pool(1);
+  SingleThreadScheduler scheduler(pool);
+  scheduler.SetCoopBudget(1);
+  scheduler.Spawn([]() -> Async<int> {
+    co_await Coop::Consume();
+    co_await Coop::Consume();
+    co_return 0;
+  }());
+  EXPECT_EQ(scheduler.Metrics().global_queue_depth, 1);
+  scheduler.Schedule(1);
+  scheduler.Schedule(1);
+  scheduler.Schedule(1);
+  scheduler.Schedule(1);
+
+  const RuntimeMetrics::Scheduler m = scheduler.Metrics();
+  ASSERT_EQ(m.workers.size(), 1);
+  EXPECT_EQ(m.workers[0].thread_id, Thread::Current());
+  EXPECT_EQ(m.polls, 2);
+  EXPECT_EQ(m.parks, 1);
+  EXPECT_EQ(m.unparks, 0);
+  EXPECT_EQ(m.global_queue_depth, 0);
+}
+
+TEST(RuntimeMetricsTest, BlockingPool) {
+  BlockingPool pool(1);
+  pool.Spawn([] { usleep(20 * 1000); });
+  pool.Spawn([] {});
+  usleep(50 * 1000);
+  const RuntimeMetrics::BlockingPool m = pool.Metrics();
+  EXPECT_EQ(m.num_threads, 1);
+  EXPECT_EQ(m.num_idle_threads, 1);
+  EXPECT_EQ(m.queue_depth, 0);
+  EXPECT_EQ(m.dequeued, 2);
+  EXPECT_EQ(m.parks, 1);
+  // The second task waited behind the first one.
+  EXPECT_GE(m.queue_wait.MilliSeconds(), 10);
+  EXPECT_GE(m.busy.MilliSeconds(), 10);
+}
+}  // namespace TX
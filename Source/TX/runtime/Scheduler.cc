@@ -0,0 +1,55 @@
+#include "TX/runtime/Scheduler.h"
+
+#include <algorithm>
+
+namespace TX {
+int Scheduler::poll(const int turn) {
+  Scheduler *previous = std::exchange(currentScheduler, this);
+  WorkerMetrics &metrics = metrics_.Local();
+  const int n_ready = static_cast<int>(ready_.Lock()->size());
+  const Time start = Time::Now();
+  int n = 0;
+  for (; n < std::min(turn, n_ready); n++) {
+    auto ready = ready_.Lock();
+    if (ready->empty()) break;
+    const std::coroutine_handle<> h = ready->front();
+    ready->pop_front();
+    drop(ready);
+    Coop::BudgetGuard guard(budget_);
+    h.resume();
+  }
+  currentScheduler = previous;
+
+  if (n == 0) {
+    if (!metrics.parked) WorkerMetrics::Add(metrics.parks);
+    metrics.parked = true;
+    return 0;
+  }
+  if (metrics.parked) WorkerMetrics::Add(metrics.unparks);
+  metrics.parked = false;
+  WorkerMetrics::Add(metrics.polls, n);
+  WorkerMetrics::Add(metrics.busy_ns, Time::Since(start).NanoSeconds());
+  return n;
+}
+
+RuntimeMetrics::Scheduler Scheduler::Metrics() {
+  RuntimeMetrics::Scheduler m;
+  m.global_queue_depth = ready_.Lock()->size();
+  metrics_.ForEach([&m](const WorkerMetrics &w) {
+    RuntimeMetrics::Worker worker{
+        w.thread_id,
+        w.polls.load(std::memory_order_relaxed),
+        w.parks.load(std::memory_order_relaxed),
+        w.unparks.load(std::memory_order_relaxed),
+        Duration::NanoSecond(
+            static_cast<int64_t>(w.busy_ns.load(std::memory_order_relaxed))),
+    };
+    m.polls += worker.polls;
+    m.parks += worker.parks;
+    m.unparks += worker.unparks;
+    m.busy += worker.busy;
+    m.workers.push_back(worker);
+  });
+  return m;
+}
+}  // namespace TX
@@ -1,13 +1,21 @@
 #pragma once
+#include <coroutine>
+#include <deque>
+
 #include "TX/Assert.h"
+#include "TX/Mutex.h"
+#include "TX/runtime/Async.h"
 #include "TX/runtime/BlockingPool.h"
+#include "TX/runtime/Coop.h"
+#include "TX/runtime/RuntimeMetrics.h"
 
 namespace TX {
-static class Scheduler *currentScheduler = nullptr;
+inline thread_local class Scheduler *currentScheduler = nullptr;
 
 class Scheduler {
  public:
-  explicit Scheduler(BlockingPool &pool) : tick_(0), blocking_pool_(pool) {}
+  explicit Scheduler(BlockingPool &pool)
+      : tick_(0), budget_(Coop::kDefaultBudget), blocking_pool_(pool) {}
   virtual ~Scheduler() = default;
   virtual int Schedule(int turn) = 0;
 
@@ -16,6 +24,23 @@ class Scheduler {
     return blocking_pool_.Spawn(std::move(f));
   }
 
+  // Runs `async` to completion on this scheduler, detached, as a new task
+  // with its own task-locals.
+  template <class T>
+  void Spawn(Async<T> async) {
+    Wake(root(std::move(async)).handle);
+  }
+
+  // Queues `h` to be resumed on the scheduler's next turn.
+  void Wake(const std::coroutine_handle<> h) { ready_.Lock()->push_back(h); }
+
+  // Counters of every thread that has run this scheduler.
+  RuntimeMetrics::Scheduler Metrics();
+
+  // The coop budget every task is resumed with, Coop::kUnconstrained turns
+  // cooperative yielding off.
+  void SetCoopBudget(const uint32 budget) { budget_ = budget; }
+
   class EnterGuard {
    public:
     explicit EnterGuard(Scheduler *scheduler) : scheduler_(scheduler) {}
@@ -39,9 +64,43 @@ class Scheduler {
     return currentScheduler;
   }
 
+  // Like Current, but returns nullptr outside a scheduler.
+  static Scheduler *TryCurrent() { return currentScheduler; }
+
  protected:
+  // Resumes at most `turn` ready tasks, each with a fresh coop budget, and
+  // returns the number resumed. Tasks woken meanwhile wait for the next call
+  // so that a task yielding in a loop cannot keep the turn to itself.
+  int poll(int turn);
+
   uint32_t tick_;
+  uint32 budget_;
   BlockingPool &blocking_pool_;
+  WorkerMetricsSet metrics_;
+
+ private:
+  // Owns the task-locals of a spawned task.
+  struct Root {
+    struct promise_type : TaskLocalContext {
+      promise_type() { SetTaskLocals(&locals); }
+      Root get_return_object() noexcept {
+        return {std::coroutine_handle<promise_type>::from_promise(*this)};
+      }
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception() { std::terminate(); }
+      TaskLocals locals;
+    };
+    std::coroutine_handle<> handle;
+  };
+
+  template <class T>
+  static Root root(Async<T> async) {
+    co_await async;
+  }
+
+  Mutex<std::deque<std::coroutine_handle<>>> ready_;
 };
 
 }  // namespace TX
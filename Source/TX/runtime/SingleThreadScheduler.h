@@ -8,7 +8,7 @@ class SingleThreadScheduler final : public Scheduler {
   ~SingleThreadScheduler() override = default;
   int Schedule(int turn) override {
     tick_++;
-    return 0;
+    return poll(turn);
   }
 };
 }  // namespace TX
@@ -2,6 +2,7 @@
 #include <atomic>
 
 #include "TX/Bits.h"
+#include "TX/Cancellation.h"
 #include "TX/Ref.h"
 
 namespace TX {
@@ -11,6 +12,13 @@ class Task : public AtomicRefCounted<Task> {
   explicit Task(const uint64_t id) : id_(id) {}
   virtual void Run() = 0;
 
+  // A cancelled task that has not started yet is never run.
+  void SetCancellationToken(const CancellationToken &token) { token_ = token; }
+  TX_NODISCARD const CancellationToken &GetCancellationToken() const {
+    return token_;
+  }
+  TX_NODISCARD bool IsCancelled() const { return token_.IsCancelled(); }
+
   template <class R>
   class Handle {
     friend class BlockingPool;
@@ -29,5 +37,6 @@ class Task : public AtomicRefCounted<Task> {
   };
 
   uint64_t id_;
+  CancellationToken token_;
 };
 }  // namespace TX
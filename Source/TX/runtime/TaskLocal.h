@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+#include "TX/Assert.h"
+#include "TX/Memory.h"
+#include "TX/Platform.h"
+
+namespace TX {
+// The task-local values of a spawned task, a fixed array of type-erased
+// slots indexed by key. It lives in the task's root coroutine frame and is
+// reached through a pointer in every Async frame of the task, so the values
+// follow the task whichever thread resumes it.
+class TaskLocals {
+ public:
+  static constexpr size_t kMaxSlots = 16;
+
+  explicit TaskLocals() = default;
+  ~TaskLocals() {
+    for (const Slot &slot : slots_) {
+      if (slot.value) slot.destroy(slot.value);
+    }
+  }
+  TX_DISALLOW_COPY(TaskLocals)
+
+  // The task-locals of the task running on this thread, if any.
+  static TaskLocals *Current() { return current_; }
+
+ private:
+  friend class TaskLocalContext;
+  template <class Key, class T>
+  friend class TaskLocal;
+
+  static size_t nextSlot() {
+    static std::atomic<size_t> next = 0;
+    const size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    TX_ASSERT(slot < kMaxSlots, "Too many task-local keys");
+    return slot;
+  }
+
+  struct Slot {
+    void *value = nullptr;
+    void (*destroy)(void *) = nullptr;
+  };
+  Slot slots_[kMaxSlots];
+
+  static inline thread_local TaskLocals *current_ = nullptr;
+};
+
+// Mixed into the promise of coroutines that run on behalf of a task. The
+// promise makes its task-locals current whenever the coroutine is resumed
+// and restores the previous ones whenever it suspends, so nested resumptions,
+// e.g. a waiter resumed from inside another task's Release, unwind properly.
+class TaskLocalContext {
+ public:
+  TX_NODISCARD TaskLocals *GetTaskLocals() const { return locals_; }
+  void SetTaskLocals(TaskLocals *locals) { locals_ = locals; }
+
+  void EnterTaskLocals() {
+    saved_ = TaskLocals::current_;
+    TaskLocals::current_ = locals_;
+  }
+  void LeaveTaskLocals() const { TaskLocals::current_ = saved_; }
+
+ private:
+  TaskLocals *locals_ = nullptr;
+  TaskLocals *saved_ = nullptr;
+};
+
+// A task-local key, declared with TX_TASK_LOCAL. Every key owns a slot
+// assigned once at startup, so Get is an array index and never allocates.
+template <class Key, class T>
+class TaskLocal {
+ public:
+  // The value of the current task, or nullptr if it has not been set or we
+  // are not running in a task.
+  static T *Get() {
+    TaskLocals *locals = TaskLocals::Current();
+    if (!locals) return nullptr;
+    return static_cast<T *>(locals->slots_[slot_].value);
+  }
+
+  static void Set(T value) {
+    TaskLocals *locals = TaskLocals::Current();
+    TX_ASSERT(locals, "Task-local set outside a task");
+    TaskLocals::Slot &slot = locals->slots_[slot_];
+    if (slot.value) {
+      *static_cast<T *>(slot.value) = std::move(value);
+    } else {
+      slot.value = new T(std::move(value));
+      slot.destroy = [](void *v) { delete static_cast<T *>(v); };
+    }
+  }
+
+ private:
+  static inline const size_t slot_ = TaskLocals::nextSlot();
+};
+
+// TX_TASK_LOCAL(TraceSpan, Span) declares a key type TraceSpan, used as
+// TraceSpan::Get() and TraceSpan::Set(span).
+#define TX_TASK_LOCAL(name, T) \
+  struct name final : ::TX::TaskLocal<name, T> {}
+}  // namespace TX
@@ -0,0 +1,86 @@
+#include "TX/runtime/TaskLocal.h"
+
+#include <string>
+
+#include "TX/runtime/AsyncSemaphore.h"
+#include "TX/runtime/SingleThreadScheduler.h"
+#include "gtest/gtest.h"
+
+namespace TX {
+TX_TASK_LOCAL(TaskName, std::string);
+TX_TASK_LOCAL(TaskNumber, int);
+
+struct TaskLocalTest : testing::Test {
+  TaskLocalTest() : pool_(1), scheduler_(pool_) {}
+
+  static std::string name() {
+    const std::string *name = TaskName::Get();
+    return name ? *name : "";
+  }
+
+  static Async<int> child() {
+    co_await Coop::Yield();
+    co_return *TaskNumber::Get();
+  }
+
+  BlockingPool pool_;
+  SingleThreadScheduler scheduler_;
+};
+
+TEST_F(TaskLocalTest, OutsideTask) {
+  EXPECT_EQ(TaskLocals::Current(), nullptr);
+  EXPECT_EQ(TaskName::Get(), nullptr);
+}
+
+TEST_F(TaskLocalTest, Isolated) {
+  std::string seen[2];
+  auto task = [&](const int i, std::string name) -> Async<int> {
+    EXPECT_EQ(TaskName::Get(), nullptr);
+    TaskName::Set(name);
+    TaskNumber::Set(i);
+    co_await Coop::Yield();
+    seen[i] = TaskLocalTest::name();
+    // Children see the values of the task awaiting them.
+    EXPECT_EQ(co_await child(), i);
+    TaskNumber::Set(i + 10);
+    EXPECT_EQ(co_await child(), i + 10);
+    co_return 0;
+  };
+  scheduler_.Spawn(task(0, "foo"));
+  scheduler_.Spawn(task(1, "bar"));
+  while (scheduler_.Schedule(8) > 0) {
+  }
+  EXPECT_EQ(seen[0], "foo");
+  EXPECT_EQ(seen[1], "bar");
+  EXPECT_EQ(TaskLocals::Current(), nullptr);
+}
+
+TEST_F(TaskLocalTest, CrossThread) {
+  AsyncSemaphore semaphore(0);
+  std::string seen;
+  Option<Thread::Id> resumed_on;
+  auto waiter = [&]() -> Async<int> {
+    TaskName::Set("waiter");
+    co_await semaphore.Acquire();
+    resumed_on = Thread::Current();
+    seen = name();
+    co_return 0;
+  };
+  scheduler_.Spawn(waiter());
+  scheduler_.Schedule(1);
+  // The waiter is resumed on the pool thread by Release, and the task-locals
+  // current there are restored once it suspends again.
+  TaskLocals *after = nullptr;
+  {
+    BlockingPool pool(1);
+    pool.Spawn([&] {
+      semaphore.Release();
+      after = TaskLocals::Current();
+    });
+  }
+  ASSERT_TRUE(resumed_on.has_value());
+  EXPECT_FALSE(*resumed_on == Thread::Current());
+  EXPECT_EQ(seen, "waiter");
+  EXPECT_EQ(after, nullptr);
+}
+}  // namespace TX
@@ -0,0 +1,17 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+
+namespace TX {
+// A coroutine that starts eagerly and is never awaited, for tests to suspend
+// on an awaitable without a scheduler.
+struct TestDetached {
+  struct promise_type {
+    TestDetached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+}  // namespace TX
@@ -0,0 +1,71 @@
+#pragma once
+#include <coroutine>
+
+#include "TX/Memory.h"
+#include "TX/Platform.h"
+
+namespace TX {
+// An intrusive FIFO of suspended coroutines. Nodes are embedded in awaiter
+// objects, which live in the frame of the awaiting coroutine for the whole
+// suspension, so parking a coroutine never allocates. WaitList is not
+// thread-safe, owners must guard it with their own lock.
+class WaitList {
+ public:
+  struct Node {
+    Node *next = nullptr;
+    std::coroutine_handle<> handle;
+  };
+
+  explicit WaitList() : head_(nullptr), tail_(&head_) {}
+  TX_DISALLOW_COPY(WaitList)
+
+  TX_NODISCARD bool Empty() const { return head_ == nullptr; }
+  TX_NODISCARD Node *Front() const { return head_; }
+
+  void PushBack(Node *node) {
+    node->next = nullptr;
+    *tail_ = node;
+    tail_ = &node->next;
+  }
+
+  Node *PopFront() {
+    Node *node = head_;
+    if (!node) return nullptr;
+    head_ = node->next;
+    if (!head_) tail_ = &head_;
+    node->next = nullptr;
+    return node;
+  }
+
+  // Unlinks `node` if it is still queued, returns false if it is not, e.g. it
+  // has already been popped by a waker.
+  bool Remove(const Node *node) {
+    for (Node **p = &head_; *p; p = &(*p)->next) {
+      if (*p != node) continue;
+      *p = node->next;
+      if (!*p) tail_ = p;
+      return true;
+    }
+    return false;
+  }
+
+  // Moves all nodes of `other` to the back of this list.
+  void Splice(WaitList &other) {
+    if (other.Empty()) return;
+    *tail_ = other.head_;
+    tail_ = other.tail_;
+    other.head_ = nullptr;
+    other.tail_ = &other.head_;
+  }
+
+  // Resumes every queued coroutine in FIFO order. Must be called without
+  // holding the owner's lock since resumed coroutines may re-enter it.
+  void ResumeAll() {
+    while (Node *node = PopFront()) node->handle.resume();
+  }
+
+ private:
+  Node *head_;
+  Node **tail_;
+};
+}  // namespace TX
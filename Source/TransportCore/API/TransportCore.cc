@@ -1,6 +1,11 @@
 #include "TransportCore/API/TransportCore.h"
 
+#include <cstdarg>
+
+#include "TX/Clock.h"
+#include "TX/Metrics.h"
 #include "TX/RunLoopThread.h"
+#include "TransportCore/Global/Option.h"
 #include "TransportCore/Log/Log.h"
 #include "TransportCore/Task/TaskManager.h"
 
@@ -14,6 +19,8 @@ static TX::Mutex<Guard> gGuard;
 void TransportCoreInit() {
   auto guard = gGuard.Lock();
   if (guard->initialized) TK_FATAL("TransportCore already initialized");
+  // Has the TSC ready by the time timers and log limits read Clock::Fast.
+  TX::Clock::Calibrate();
   guard->task_manager = new TransportCore::TaskManager;
   guard->task_manager->Start();
   guard->initialized = true;
@@ -74,3 +81,38 @@ TK_RESULT TransportCoreGetProxyURL(const int32_t task_id, char *buf,
   buf[size - 1] = '\0';
   return TK_OK;
 }
+
+void TransportCoreSetLogCallback(const TransportCoreLogCallback callback,
+                                 const TransportCoreLogFormat format) {
+  TransportCore::Logger::UseCallback(callback, format);
+}
+
+TK_RESULT TransportCoreSetLogFile(const TransportCoreLogFileOptions *options,
+                                  const TransportCoreLogFormat format) {
+  if (!options || !options->path) return TK_ERR;
+  return TransportCore::Logger::UseFile(*options, format);
+}
+
+size_t TransportCoreGetMetrics(char *buf, const size_t buf_size) {
+  const std::string metrics = TX::Metrics::Format();
+  if (buf_size > 0) {
+    const size_t size = std::min(buf_size - 1, metrics.size());
+    std::memcpy(buf, metrics.data(), size);
+    buf[size] = '\0';
+  }
+  return metrics.size();
+}
+
+void TransportCoreSetGlobalOption(const enum TransportCoreOption option, ...) {
+  va_list args;
+  va_start(args, option);
+  switch (option) {
+    case kTransportCoreOptionLocalServerPort:
+      TransportCore::GLOBAL_OPTION(LocalServerPort)
+          .Store(static_cast<TX::uint16>(va_arg(args, int)));
+      break;
+    default:
+      TK_FATAL("Unknown TransportCoreOption %d", option);
+  }
+  va_end(args);
+}
@@ -48,6 +48,21 @@ enum TransportCoreLogFormat {
 };
 typedef void (*TransportCoreLogCallback)(int, const char *, const char *);
 
+// Where TransportCoreSetLogFile writes logs. Zero fields take the defaults.
+struct TransportCoreLogFileOptions {
+  const char *path;
+  // Rotates the file once it would grow beyond this many bytes, 64 MiB by
+  // default.
+  uint64_t max_size;
+  // Rotates the file once it is this many seconds old, a day by default.
+  // Negative for never.
+  int64_t max_age_sec;
+  // Rotated files kept, 8 by default.
+  int32_t max_files;
+  // Gzips rotated files if nonzero.
+  int32_t compress;
+};
+
 TK_API(void) TransportCoreInit();
 TK_API(void) TransportCoreDestroy();
 TK_API(int32_t) TransportCoreCreateTask(struct TransportCoreTaskContext);
@@ -60,6 +75,13 @@ TK_API(TK_RESULT) TransportCoreGetProxyURL(int32_t, char *, size_t);
 TK_API(void)
 TransportCoreSetLogCallback(TransportCoreLogCallback,
                             enum TransportCoreLogFormat);
+// Copies the metrics as text, a line per metric, into `buf`, truncated and
+// NUL-terminated as snprintf does. Returns the size of the whole text.
+TK_API(size_t) TransportCoreGetMetrics(char *, size_t);
+// Writes logs to a rotating file instead of the callback.
+TK_API(TK_RESULT)
+TransportCoreSetLogFile(const struct TransportCoreLogFileOptions *,
+                        enum TransportCoreLogFormat);
 
 #ifdef __cplusplus
 }
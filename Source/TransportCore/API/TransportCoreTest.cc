@@ -1,4 +1,8 @@
 #include "TransportCore/API/TransportCore.h"
+
+#include <cstdio>
+#include <string>
+
 #include "gtest/gtest.h"
 
 class TransportCoreTest : public ::testing::Test {
@@ -8,3 +12,30 @@ class TransportCoreTest : public ::testing::Test {
 };
 
 TEST_F(TransportCoreTest, Simple) {}
+
+TEST_F(TransportCoreTest, SetLogFile) {
+  TransportCoreLogFileOptions options{};
+  EXPECT_EQ(TransportCoreSetLogFile(&options, kTransportCoreLogFormatPlain),
+            TK_ERR);
+  options.path = "TransportCoreTest.log";
+  EXPECT_EQ(TransportCoreSetLogFile(&options, kTransportCoreLogFormatPlain),
+            TK_OK);
+  // Replaces the sink writing the same file.
+  EXPECT_EQ(TransportCoreSetLogFile(&options, kTransportCoreLogFormatJSON),
+            TK_OK);
+  TransportCoreSetLogCallback(nullptr, kTransportCoreLogFormatPlain);
+  std::remove("TransportCoreTest.log");
+}
+
+TEST_F(TransportCoreTest, GetMetrics) {
+  // Registered before first use, as are the other metrics.
+  const size_t size = TransportCoreGetMetrics(nullptr, 0);
+  std::string metrics(size, '\0');
+  EXPECT_EQ(TransportCoreGetMetrics(metrics.data(), size + 1), size);
+  EXPECT_NE(metrics.find("transport_core.tasks_created "), std::string::npos)
+      << metrics;
+
+  char truncated[8];
+  EXPECT_EQ(TransportCoreGetMetrics(truncated, sizeof(truncated)), size);
+  EXPECT_EQ(std::string(truncated), metrics.substr(0, 7));
+}
@@ -3,3 +3,29 @@
 //
 
 #include "HTTPRequest.h"
+
+#include "TX/Metrics.h"
+
+namespace TransportCore {
+TX_METRICS_COUNTER(gResponses, "transport_core.http.responses");
+TX_METRICS_COUNTER(gBytesReceived, "transport_core.http.bytes_received");
+TX_METRICS_COUNTER(gErrors, "transport_core.http.errors");
+
+void HTTPRequest::OnDomainResolve(int32_t) {}
+
+void HTTPRequest::OnHeaderRecv(int32_t, HTTPHeader) {
+  // Headers start a new response, a redirected one ends the previous.
+  endResponse();
+  gResponses.Add();
+  TX_TRACE_BEGIN(response_span_, "HTTPRequest::Response");
+}
+
+void HTTPRequest::OnDataRecv(int32_t, char *, const size_t size) {
+  gBytesReceived.Add(size);
+}
+
+void HTTPRequest::OnError(int32_t, int32_t) {
+  gErrors.Add();
+  endResponse();
+}
+}  // namespace TransportCore
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "TX/Arena.h"
+#include "TX/Trace.h"
 #include "TransportCore/CDN/HTTPLink.h"
 
 namespace TransportCore {
@@ -15,10 +17,24 @@ public:
     virtual void OnHTTPEvent(Event) = 0;
   };
 
+  // Scratch memory for parsing the response being received. It is reset when
+  // the response ends, so nothing in it may outlive the response.
+  TX::Arena &ResponseArena() { return response_arena_; }
+
  protected:
   void OnDomainResolve(int32_t) override;
   void OnHeaderRecv(int32_t, HTTPHeader) override;
   void OnDataRecv(int32_t, char*, size_t) override;
   void OnError(int32_t, int32_t) override;
+
+ private:
+  void endResponse() {
+    TX_TRACE_END(response_span_);
+    response_arena_.Reset();
+  }
+
+  TX::Arena response_arena_;
+  // From the headers of a response to its end.
+  TX::TraceSpan response_span_;
 };
 }  // namespace TransportCore
@@ -1,8 +1,207 @@
 #include "TransportCore/Log/Log.h"
 
+#include <bit>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TK_JSON_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define TK_JSON_NEON
+#endif
+
+#include "TX/AsyncReporter.h"
+#include "TX/FileReporter.h"
+#include "TX/Mutex.h"
+
 namespace TransportCore {
-std::string Logger::formatJSON(const TX::Logger::Log &log) {
-  return "TODO: implement JSON formatter";
+namespace {
+// The sinks in use, see Logger::UseCallback.
+struct Sinks {
+  Logger *logger = nullptr;
+  TX::AsyncReporter *file = nullptr;
+  TX::FileReporter *file_reporter = nullptr;
+  bool flush_at_exit = false;
+};
+
+TX::Mutex<Sinks> gSinks;
+
+const char *levelName(const TX::Logger::Level level) {
+  switch (level) {
+    case TX::Logger::Level::Trace:
+      return "TRACE";
+    case TX::Logger::Level::Debug:
+      return "DEBUG";
+    case TX::Logger::Level::Info:
+      return "INFO";
+    case TX::Logger::Level::Warn:
+      return "WARN";
+    case TX::Logger::Level::Error:
+      return "ERROR";
+    case TX::Logger::Level::Fatal:
+      return "FATAL";
+  }
+  return "UNKNOWN";
 }
 
+void appendEscapedByte(std::string &out, const unsigned char c) {
+  switch (c) {
+    case '"':
+      out += "\\\"";
+      return;
+    case '\\':
+      out += "\\\\";
+      return;
+    case '\n':
+      out += "\\n";
+      return;
+    case '\r':
+      out += "\\r";
+      return;
+    case '\t':
+      out += "\\t";
+      return;
+    default: {
+      constexpr char kHex[] = "0123456789abcdef";
+      const char escaped[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 15]};
+      out.append(escaped, sizeof(escaped));
+    }
+  }
+}
+
+bool needsEscape(const unsigned char c) {
+  return c < 0x20 || c == '"' || c == '\\';
+}
+
+// Appends `s` as the inside of a JSON string. Bytes from 0x80 on are copied
+// as they are, so UTF-8 stays UTF-8. Blocks of 16 bytes that need no
+// escaping, the common case, are copied after one SIMD test.
+void appendEscaped(std::string &out, const std::string_view s) {
+  const char *p = s.data();
+  const char *end = p + s.size();
+#if defined(TK_JSON_SSE2) || defined(TK_JSON_NEON)
+  while (end - p >= 16) {
+#if defined(TK_JSON_SSE2)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    // Bytes up to 0x1f are the ones max(v, 0x1f) leaves at 0x1f.
+    const __m128i max_control = _mm_set1_epi8(0x1f);
+    const __m128i control =
+        _mm_cmpeq_epi8(_mm_max_epu8(v, max_control), max_control);
+    const __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    const __m128i backslash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    const auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_or_si128(control, _mm_or_si128(quote, backslash))));
+    const int clean = mask ? std::countr_zero(mask) : 16;
+#else
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    const uint8x16_t escape =
+        vorrq_u8(vcltq_u8(v, vdupq_n_u8(0x20)),
+                 vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')),
+                          vceqq_u8(v, vdupq_n_u8('\\'))));
+    // 4 bits per byte.
+    const uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(escape), 4)), 0);
+    const int clean = mask ? std::countr_zero(mask) / 4 : 16;
+#endif
+    out.append(p, clean);
+    p += clean;
+    if (clean < 16) appendEscapedByte(out, static_cast<unsigned char>(*p++));
+  }
+#endif
+  while (p < end) {
+    const char *q = p;
+    while (q < end && !needsEscape(static_cast<unsigned char>(*q))) q++;
+    out.append(p, q);
+    if (q == end) break;
+    appendEscapedByte(out, static_cast<unsigned char>(*q));
+    p = q + 1;
+  }
+}
+
+// Points TX::Logger at `logger`, and at a file written through it if
+// `file_options` are given. The file sink in use is stopped and its file
+// closed first, so that two sinks never write the same file. What it still
+// holds is formatted the way it was.
+void use(Logger *logger, TX::FileReporter::Options *file_options) {
+  auto sinks = gSinks.Lock();
+  TX::Logger::SetReporter(logger);
+  if (sinks->file) {
+    // Both left allocated, as the logger is: a thread may still be in them,
+    // the AsyncReporter passing a record straight down for one.
+    sinks->file->Stop();
+    sinks->file_reporter->Close();
+    sinks->file = nullptr;
+    sinks->file_reporter = nullptr;
+  }
+  TX::Logger::SetFormatter(logger);
+  sinks->logger = logger;
+  if (!file_options) return;
+  sinks->file_reporter = new TX::FileReporter(std::move(*file_options));
+  sinks->file = new TX::AsyncReporter(sinks->file_reporter);
+  TX::Logger::SetReporter(sinks->file);
+  if (!sinks->flush_at_exit) {
+    sinks->flush_at_exit = true;
+    std::atexit([]() {
+      if (TX::AsyncReporter *file = gSinks.Lock()->file) file->Flush();
+    });
+  }
+}
+}  // namespace
+
+void Logger::UseCallback(const TransportCoreLogCallback callback,
+                         const TransportCoreLogFormat format) {
+  use(new Logger(callback, format), nullptr);
+}
+
+TK_RESULT Logger::UseFile(const TransportCoreLogFileOptions &options,
+                          const TransportCoreLogFormat format) {
+  TX::FileReporter::Options file_options{.path = options.path};
+  if (options.max_size) file_options.max_size = options.max_size;
+  if (options.max_age_sec < 0) {
+    file_options.max_age = 0;
+  } else if (options.max_age_sec > 0) {
+    file_options.max_age = TX::Duration::Second(options.max_age_sec);
+  }
+  if (options.max_files) file_options.max_files = options.max_files;
+  file_options.compress = options.compress != 0;
+  std::error_code ec;
+  const std::filesystem::path path(options.path);
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec) return TK_ERR;
+  }
+  // The logger only formats, the callback is not used.
+  use(new Logger(nullptr, format), &file_options);
+  return TK_OK;
+}
+
+std::string_view Logger::formatJSON(const TX::Logger::Log &log) {
+  // Reused, so that lines stop allocating once it has grown.
+  thread_local std::string line;
+  line.clear();
+  line += R"({"level":")";
+  line += levelName(log.level_);
+  line += R"(","time":")";
+  AppendTime(line, log.time_);
+  line += R"(","scope":")";
+  appendEscaped(line, log.scope_);
+  line += R"(","file":")";
+  appendEscaped(line, log.file_);
+  line += ':';
+  AppendNumber(line, log.line_);
+  line += R"(","function":")";
+  appendEscaped(line, log.function_);
+  line += R"(","message":")";
+  appendEscaped(line, log.message_);
+  if (log.suppressed_) {
+    line += R"(","suppressed":)";
+    AppendNumber(line, static_cast<int64_t>(log.suppressed_));
+    line += '}';
+  } else {
+    line += R"("})";
+  }
+  return line;
+}
 }  // namespace TransportCore
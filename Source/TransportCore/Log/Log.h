@@ -20,16 +20,26 @@ class Logger final : public TX::Logger::Reporter, public TX::Logger::Formatter {
     TX::Logger::SetFormatter(this);
   }
 
+  // Make TX::Logger report to `callback`, or to a rotating file written in
+  // the background. A replaced file is written out and closed, and its writer
+  // thread stopped. Replaced loggers are never freed, another thread may
+  // still be in one.
+  static void UseCallback(TransportCoreLogCallback callback,
+                          TransportCoreLogFormat format);
+  static TK_RESULT UseFile(const TransportCoreLogFileOptions &options,
+                           TransportCoreLogFormat format);
+
   void Report(const TX::Logger::Log &log) override {
     if (callback_) {
-      const std::string log_str = Format(log);
-      callback_(static_cast<int>(log.level_), log.scope_.c_str(), log_str.c_str());
+      const std::string_view log_str = Format(log);
+      callback_(static_cast<int>(log.level_), log.scope_.data(),
+                log_str.data());
     } else {
       TX::Logger::Reporter::Report(log);
     }
   }
 
-  std::string Format(const TX::Logger::Log &log) override {
+  std::string_view Format(const TX::Logger::Log &log) override {
     switch (format_) {
       case kTransportCoreLogFormatJSON:
         return formatJSON(log);
@@ -39,7 +49,7 @@ class Logger final : public TX::Logger::Reporter, public TX::Logger::Formatter {
   }
 
  private:
-  TX_NODISCARD static std::string formatJSON(const TX::Logger::Log &);
+  TX_NODISCARD static std::string_view formatJSON(const TX::Logger::Log &);
 
  private:
   TransportCoreLogCallback callback_;
@@ -0,0 +1,38 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "TransportCore/Log/Log.h"
+#include "gtest/gtest.h"
+
+namespace TransportCore {
+namespace {
+// Formats a typical record over and over, returns MB/s of output.
+double throughput(TX::Logger::Formatter &formatter,
+                  const std::string_view message) {
+  constexpr int kRecords = 1000000;
+  const TX::Logger::Log log(TX::Logger::Level::Info, "Scheduler.cc", 42,
+                            "Start", "TransportCore", message);
+  size_t bytes = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRecords; i++) bytes += formatter.Format(log).size();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return static_cast<double>(bytes) / elapsed.count() / 1e6;
+}
+}  // namespace
+
+TEST(LogBench, FormatThroughput) {
+  const std::string short_message = "task: 1(abcdef), start";
+  const std::string long_message =
+      "request done, url: https://cdn.example.com/video/1080p/segment-00042.ts"
+      ", status: 200, bytes: 1048576, elapsed: 123 ms, \"retry\": 0";
+  TX::Logger::Formatter plain;
+  Logger json(nullptr, kTransportCoreLogFormatJSON);
+  for (const auto &[name, message] :
+       {std::pair{"short", short_message}, std::pair{"long", long_message}}) {
+    std::printf("%-6s plain %8.1f MB/s, json %8.1f MB/s\n", name,
+                throughput(plain, message), throughput(json, message));
+  }
+}
+}  // namespace TransportCore
@@ -0,0 +1,80 @@
+#include "TransportCore/Log/Log.h"
+
+#include <cstdio>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace TransportCore {
+namespace {
+std::string formatJSON(const std::string_view message,
+                       const TX::uint64 suppressed = 0) {
+  Logger logger(nullptr, kTransportCoreLogFormatJSON);
+  const TX::Logger::Log log(TX::Logger::Level::Warn, "file.cc", 42, "function",
+                            "TransportCore", message, TX::Logger::Now(),
+                            suppressed);
+  return std::string(logger.Format(log));
+}
+
+// What formatJSON is expected to do with a message, one byte at a time.
+std::string escape(const std::string_view s) {
+  std::string out;
+  for (const char c : s) {
+    if (c == '"') {
+      out += "\\\"";
+    } else if (c == '\\') {
+      out += "\\\\";
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if (c == '\r') {
+      out += "\\r";
+    } else if (c == '\t') {
+      out += "\\t";
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+std::string message(const std::string &json) {
+  const std::string key = R"("message":")";
+  const size_t begin = json.find(key) + key.size();
+  return json.substr(begin, json.rfind("\"}") - begin);
+}
+}  // namespace
+
+TEST(LogTest, FormatJSON) {
+  const std::string json = formatJSON("hello");
+  EXPECT_TRUE(json.starts_with(R"({"level":"WARN","time":")")) << json;
+  EXPECT_TRUE(json.ends_with(
+      R"(","scope":"TransportCore","file":"file.cc:42",)"
+      R"("function":"function","message":"hello"})"))
+      << json;
+}
+
+TEST(LogTest, FormatJSONSuppressed) {
+  EXPECT_TRUE(formatJSON("hello", 3).ends_with(
+      R"("message":"hello","suppressed":3})"));
+}
+
+TEST(LogTest, FormatJSONEscape) {
+  EXPECT_EQ(message(formatJSON("a\"b\\c\nd\x01")), R"(a\"b\\c\nd\u0001)");
+  // UTF-8 is kept as it is.
+  EXPECT_EQ(message(formatJSON("\xc3\xa9t\xc3\xa9")), "\xc3\xa9t\xc3\xa9");
+  // An escaped byte at every position of blocks and tails.
+  for (size_t size = 0; size < 48; size++) {
+    for (size_t at = 0; at < size; at++) {
+      for (const char c : {'"', '\\', '\n', '\x1f', '\x7f', '\x80'}) {
+        std::string s(size, 'x');
+        s[at] = c;
+        EXPECT_EQ(message(formatJSON(s)), escape(s)) << size << " " << at;
+      }
+    }
+  }
+}
+}  // namespace TransportCore
@@ -6,25 +6,34 @@
 namespace TransportCore {
 TK_RESULT Scheduler::Start() {
   TK_INFO("task: %d(%s), start", task_id_, context_.keyid);
-  run_loop_->AddTimer(this);
+  TX::RefPtr<TX::RunLoop> run_loop = run_loop_.upgrade();
+  if (!run_loop) return TK_ERR;
+  run_loop->AddTimer(this);
   return TK_OK;
 }
 
 TK_RESULT Scheduler::Stop() {
   TK_INFO("task: %d(%s), stop", task_id_, context_.keyid);
-  run_loop_->RemoveTimer(this);
+  cancel_source_.Cancel();
+  if (TX::RefPtr<TX::RunLoop> run_loop = run_loop_.upgrade()) {
+    run_loop->RemoveTimer(this);
+  }
   return TK_OK;
 }
 
 TK_RESULT Scheduler::Pause() {
   TK_INFO("task: %d(%s), pause", task_id_, context_.keyid);
-  run_loop_->RemoveTimer(this);
+  TX::RefPtr<TX::RunLoop> run_loop = run_loop_.upgrade();
+  if (!run_loop) return TK_ERR;
+  run_loop->RemoveTimer(this);
   return TK_OK;
 }
 
 TK_RESULT Scheduler::Resume() {
   TK_INFO("task: %d(%s), resume", task_id_, context_.keyid);
-  run_loop_->AddTimer(this);
+  TX::RefPtr<TX::RunLoop> run_loop = run_loop_.upgrade();
+  if (!run_loop) return TK_ERR;
+  run_loop->AddTimer(this);
   return TK_OK;
 }
 
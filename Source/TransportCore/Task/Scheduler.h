@@ -1,6 +1,8 @@
 #pragma once
 
+#include "TX/Cancellation.h"
 #include "TX/RunLoop.h"
+#include "TX/WeakRef.h"
 #include "TransportCore/API/TransportCore.h"
 
 namespace TransportCore {
@@ -9,11 +11,15 @@ class Scheduler : public TX::RunLoop::Timer,
                   public TX::AtomicRefCounted<Scheduler> {
  public:
   explicit Scheduler(const TX::Ref<TX::RunLoop> &run_loop, int32_t task_id,
-                     TransportCoreTaskContext context)
+                     TransportCoreTaskContext context,
+                     const TX::CancellationToken &parent)
       : Timer(0, TX::Duration::Second(1), kTimerRepeatAlways, "Scheduler"),
         run_loop_(run_loop),
         context_(context),
-        task_id_(task_id) {}
+        task_id_(task_id),
+        cancel_source_(parent) {
+    SetCancellationToken(cancel_source_.GetToken());
+  }
 
   virtual TK_RESULT Start();
   virtual TK_RESULT Stop();
@@ -23,6 +29,12 @@ class Scheduler : public TX::RunLoop::Timer,
   virtual int64_t ReadData(int32_t, size_t, size_t, char *);
   virtual std::string GetProxyURL();
 
+  // Everything the task does on its own behalf, timers, blocks and blocking
+  // work, should watch this token so that Stop releases it promptly.
+  TX_NODISCARD TX::CancellationToken GetCancellationToken() const {
+    return cancel_source_.GetToken();
+  }
+
   void OnTimeout(TX::RunLoop &, TX::RefPtr<TX::RunLoop::Scope> &) override {
     // Run the internal schedule callback.
     Schedule();
@@ -33,9 +45,11 @@ class Scheduler : public TX::RunLoop::Timer,
   }
 
  private:
-  TX::Ref<TX::RunLoop> run_loop_;
+  // Weak, the loop may be torn down while tasks still refer to it.
+  TX::WeakRef<TX::RunLoop> run_loop_;
   TransportCoreTaskContext context_;
   int32_t task_id_;
+  TX::CancellationSource cancel_source_;
 };
 
 }  // namespace TransportCore
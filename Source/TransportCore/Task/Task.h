@@ -15,8 +15,11 @@ namespace TransportCore {
 class Task {
  public:
   explicit Task(const TX::Ref<TX::RunLoop> &run_loop, const int32_t id,
-                const TransportCoreTaskContext &context)
-      : id_(id), run_loop_(run_loop), scheduler_(createScheduler(context)) {}
+                const TransportCoreTaskContext &context,
+                const TX::CancellationToken &parent)
+      : id_(id),
+        run_loop_(run_loop),
+        scheduler_(createScheduler(context, parent)) {}
 
   TK_RESULT Start() {
     if (!scheduler_) return TK_ERR;
@@ -49,11 +52,12 @@ class Task {
   }
 
   TX_NODISCARD TX::RefPtr<Scheduler> createScheduler(
-      const TransportCoreTaskContext &context) const {
+      const TransportCoreTaskContext &context,
+      const TX::CancellationToken &parent) const {
     Scheduler *scheduler = nullptr;
     switch (context.kind) {
       case kTransportCoreTaskKindUnSpec:
-        scheduler = new Scheduler(run_loop_, id_, context);
+        scheduler = new Scheduler(run_loop_, id_, context, parent);
         break;
       case kTransportCoreTaskKindPlain:
         scheduler = nullptr;  // TODO
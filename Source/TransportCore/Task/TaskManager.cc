@@ -1,9 +1,12 @@
 #include "TransportCore/Task/TaskManager.h"
 
+#include "TX/Metrics.h"
 #include "TX/Trace.h"
 #include "TransportCore/Log/Log.h"
 
 namespace TransportCore {
+TX_METRICS_COUNTER(gTasksCreated, "transport_core.tasks_created");
+
 TK_RESULT TaskManager::Start() {
   start_time_ = TX::Time::Now();
   run_loop_->AddTimer(this);
@@ -11,10 +14,12 @@ TK_RESULT TaskManager::Start() {
 }
 
 TK_RESULT TaskManager::Stop() {
-  auto guard = guard_.Lock();
+  auto guard = guard_.Write();
   for (auto &it : guard->task_map_) {
     it.second.Stop();
   }
+  // Catches whatever else is watching the tasks' tokens.
+  cancel_source_.Cancel();
   run_loop_->RemoveTimer(this);
   return TK_OK;
 }
@@ -25,9 +30,10 @@ int32_t TaskManager::CreateTask(const TransportCoreTaskContext &context) {
   int32_t task_id = Id::Next(context.kind, kTaskIdBase, kTaskIdSpan);
   if (task_id < 0) return -1;
 
-  Task task(run_loop_, task_id, context);
-  auto guard = guard_.Lock();
+  Task task(run_loop_, task_id, context, cancel_source_.GetToken());
+  auto guard = guard_.Write();
   guard->task_map_.insert({task_id, task});
+  gTasksCreated.Add();
   return task_id;
 }
 
@@ -70,8 +76,8 @@ void TaskManager::OnTimeout(TX::RunLoop &, TX::RefPtr<TX::RunLoop::Scope> &) {
 }
 
 TX::Option<Task> TaskManager::findTask(const int32_t task_id) {
-  auto &task_map = guard_.Lock()->task_map_;
-  const auto it = task_map.find(task_id);
-  return it == task_map.end() ? TX::None : TX::Some(it->second);
+  const auto guard = guard_.Read();
+  const auto it = guard->task_map_.find(task_id);
+  return it == guard->task_map_.end() ? TX::None : TX::Some(it->second);
 }
 }  // namespace TransportCore
@@ -1,6 +1,7 @@
 #pragma once
 #include "TX/Platform.h"
 #include "TX/RunLoop.h"
+#include "TX/RwLock.h"
 #include "TransportCore/Global/Global.h"
 #include "TransportCore/Task/Task.h"
 
@@ -37,8 +38,11 @@ class TaskManager final : public TX::RunLoop::Timer {
   };
 
   TX::Time start_time_;
-  TX::Mutex<Guard> guard_;
+  // Looked up on every API call, written only when tasks come and go.
+  TX::RwLock<Guard> guard_;
   TX::Ref<TX::RunLoop> run_loop_;
+  // The parent of all task cancellation sources.
+  TX::CancellationSource cancel_source_;
 
  public:
   class Id {